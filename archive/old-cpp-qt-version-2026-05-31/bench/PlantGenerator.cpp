@@ -0,0 +1,107 @@
+#include "PlantGenerator.hpp"
+#include "sim/Components.hpp"
+#include "sim/AlarmMetrics.hpp"
+#include "sim/KpiEngine.hpp"
+#include "sim/Loader.hpp"
+#include "sim/MonteCarlo.hpp"
+
+GeneratedPlant generatePlant(entt::registry& r, std::size_t entities, std::uint64_t seed) {
+    SplitMix64 rng(seed);
+    GeneratedPlant out;
+    out.loops = std::max<std::size_t>(1, entities / 4);
+
+    auto& topo = r.ctx().emplace<PlantTopology>();
+    float steam = 0.f, cooling = 0.f;
+
+    for (std::size_t i = 0; i < out.loops; ++i) {
+        auto loop = r.create();
+        r.emplace<Pump>(loop, true, rng.uniform(1.2f, 2.4f), 0.f);
+        r.emplace<ValveActuator>(loop, 0.f, rng.uniform(0.f, 1.f), rng.uniform(0.2f, 1.f), true);
+        r.emplace<Pipe>(loop, rng.uniform(0.5f, 3.f));
+        r.emplace<Tank>(loop, rng.uniform(0.1f, 0.9f), rng.uniform(1.f, 4.f), 0.f, 0.f);
+        PID pid;
+        pid.sp = rng.uniform(0.3f, 0.8f);
+        r.emplace<PID>(loop, pid);
+        r.emplace<Alarmable>(loop);
+        r.emplace<AlarmResponse>(loop);
+
+        auto hx = r.create();
+        HeatExchanger h;
+        h.tau_s = rng.uniform(2.f, 20.f);
+        h.flow_rate = rng.uniform(0.5f, 2.f);
+        r.emplace<HeatExchanger>(hx, h);
+        r.emplace<ValveActuator>(hx, 0.f, rng.uniform(0.f, 1.f), 0.6f, true);
+        topo.edges.emplace_back(loop, hx);
+
+        steam += r.emplace<SteamLoad>(r.create(), rng.uniform(1.f, 20.f), 0.f).demand_flow;
+        cooling += r.emplace<CoolingLoad>(r.create(), rng.uniform(5.f, 200.f), 0.f).demand_kw;
+    }
+
+    auto site = r.create();
+    r.emplace<HumanFactors>(site, 0.7f, 0.2f, 8.0f, 3, 1.0f);
+    r.emplace<SiteKPI>(site);
+    r.ctx().emplace<KpiEngine>();
+    r.ctx().emplace<AlarmMetrics>();
+    SteamHeader header;
+    header.capacitance = steam;  // a second of full load per unit of pressure
+    header.steam_supply_flow = header.steam_demand_flow = steam;
+    r.emplace<SteamHeader>(site, header);
+    ChilledWaterLoop chw;
+    chw.flow_kg_s = cooling / (4.19f * (chw.return_design - chw.supply_sp));
+    chw.thermal_mass = 100.f * cooling;  // ~100 s of full load per K
+    r.emplace<ChilledWaterLoop>(site, chw);
+    // Sized for the loads with 25% margin and already steaming at their demand
+    Boiler boiler;
+    boiler.capacity = 1.25f * steam;
+    boiler.steam_flow = steam;
+    boiler.firing = steam / boiler.capacity;
+    r.emplace<Boiler>(site, boiler);
+    // Same for the chillers: three of four unloader steps in, tower sized for motor heat too
+    RefrigerationCompressor comp;
+    comp.capacity_kw = 1.25f * cooling;
+    comp.stage = 3;
+    comp.load = 0.75f;
+    comp.cooling_kw = cooling;
+    r.emplace<RefrigerationCompressor>(site, comp);
+    CoolingTower tower;
+    tower.design_kw = 1.5f * cooling;
+    r.emplace<CoolingTower>(site, tower);
+
+    out.entities = out.loops * 4 + 1;
+    return out;
+}
+
+GeneratedPlant generatePipeNetwork(entt::registry& r, std::size_t pipes, std::uint64_t seed) {
+    SplitMix64 rng(seed);
+    GeneratedPlant out;
+    out.loops = std::max<std::size_t>(1, pipes / 4);
+
+    auto& topo = r.ctx().emplace<PlantTopology>();
+    auto supply = r.create();
+    r.emplace<Pump>(supply, true, 2.f, 0.f);
+    r.emplace<Pipe>(supply, 0.05f);
+    r.emplace<Tank>(supply, 0.6f, 1000.f, 0.f, 0.f);
+
+    auto node = [&](bool turbulent) {
+        auto e = r.create();
+        r.emplace<Pipe>(e, rng.uniform(0.05f, 0.5f), turbulent);
+        r.emplace<ValveActuator>(e, 0.f, rng.uniform(0.3f, 1.f), 0.6f, true);
+        return e;
+    };
+
+    entt::entity a_prev = supply, b_prev = supply;
+    for (std::size_t i = 0; i < out.loops; ++i) {
+        const bool turbulent = i % 2 == 1;
+        auto a = node(turbulent), b = node(turbulent);
+        topo.edges.emplace_back(a_prev, a);
+        topo.edges.emplace_back(b_prev, b);
+        topo.edges.emplace_back(a, b);
+        topo.edges.emplace_back(a, r.create());  // lateral to an open outlet
+        a_prev = a;
+        b_prev = b;
+    }
+    topo.edges.emplace_back(b_prev, supply);
+
+    out.entities = 1 + out.loops * 3;
+    return out;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <entt/entt.hpp>
+
+// Synthetic plants for benchmarking. Entities come in units of four:
+//   loop  - Pump, ValveActuator, Pipe, Tank, PID, Alarmable, AlarmResponse
+//   hx    - HeatExchanger, ValveActuator (fed by the loop tank)
+//   steam - SteamLoad
+//   chill - CoolingLoad
+// plus one site entity with HumanFactors, SiteKPI, SteamHeader,
+// ChilledWaterLoop, Boiler, RefrigerationCompressor and CoolingTower, and a
+// KpiEngine and AlarmMetrics in the registry context.
+// Loop→hx links go into PlantTopology so the FlowNetwork path is exercised.
+struct GeneratedPlant {
+  std::size_t entities{0};
+  std::size_t loops{0};
+};
+
+GeneratedPlant generatePlant(entt::registry& r, std::size_t entities, std::uint64_t seed = 1);
+
+// Distribution network for the hydraulic solver, about `pipes` edges: a
+// pumped supply tank feeding two parallel mains tied together at every rung,
+// a lateral from each rung to an open outlet, and a recirculation line from
+// the far end back to the tank. Rung nodes carry a Pipe and a fixed
+// ValveActuator; every other rung is turbulent. `loops` is the rung count.
+GeneratedPlant generatePipeNetwork(entt::registry& r, std::size_t pipes, std::uint64_t seed = 1);
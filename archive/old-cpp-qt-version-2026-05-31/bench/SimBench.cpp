@@ -0,0 +1,156 @@
+#include "PlantGenerator.hpp"
+#include "sim/SimRunner.hpp"
+#include "sim/BatchKernels.hpp"
+#include "sim/FlowNetwork.hpp"
+#include "sim/Systems.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// sim_bench [--sizes 10,1000,...] [--seconds 0.2] [--out results.json]
+//
+// Per-system microbenchmarks and end-to-end ticks/s over synthetic plants,
+// plus the hydraulic solve alone on a pipe network of the same size.
+// Results are written as one JSON document (stdout unless --out is given)
+// so CI can diff them against a stored baseline.
+
+namespace {
+
+struct Result {
+  std::string bench, name, mode;
+  std::size_t entities{0};
+  unsigned threads{1};
+  std::uint64_t iterations{0};
+  double ns_per_call{0};
+};
+
+using Clock = std::chrono::steady_clock;
+
+// Repeat fn until `budget_s` has elapsed (at least 3 calls), return ns/call.
+template<typename F>
+std::pair<double, std::uint64_t> measure(F&& fn, double budget_s) {
+    fn(); // warm-up: lanes and pools reach steady-state capacity
+    std::uint64_t iters = 0;
+    const auto t0 = Clock::now();
+    double elapsed = 0.0;
+    do {
+        fn();
+        ++iters;
+        elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+    } while (elapsed < budget_s || iters < 3);
+    return {elapsed * 1e9 / static_cast<double>(iters), iters};
+}
+
+std::vector<std::size_t> parseSizes(const std::string& s) {
+    std::vector<std::size_t> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty())
+            out.push_back(static_cast<std::size_t>(std::atoll(item.c_str())));
+    return out;
+}
+
+void writeJson(std::ostream& o, const std::vector<Result>& results) {
+    o << "{\n  \"isa\": \"" << BatchKernels::isa() << "\",\n"
+      << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+      << "  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        o << "    {\"bench\": \"" << r.bench << "\", \"name\": \"" << r.name << "\", \"mode\": \"" << r.mode
+          << "\", \"entities\": " << r.entities << ", \"threads\": " << r.threads
+          << ", \"iterations\": " << r.iterations << ", \"ns_per_call\": " << r.ns_per_call
+          << ", \"ns_per_entity\": " << r.ns_per_call / static_cast<double>(std::max<std::size_t>(1, r.entities))
+          << ", \"calls_per_s\": " << (r.ns_per_call > 0 ? 1e9 / r.ns_per_call : 0.0) << "}"
+          << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    o << "  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::size_t> sizes{10, 100, 1000, 10000, 100000, 1000000};
+    double budget_s = 0.2;
+    std::string out_path;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (arg == "--sizes")        sizes = parseSizes(argv[i + 1]);
+        else if (arg == "--seconds") budget_s = std::atof(argv[i + 1]);
+        else if (arg == "--out")     out_path = argv[i + 1];
+    }
+
+    const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<Result> results;
+
+    for (std::size_t n : sizes) {
+        for (bool batched : {false, true}) {
+            const std::string mode = batched ? "batched" : "scalar";
+
+            SimRunner sim;
+            const GeneratedPlant plant = generatePlant(sim.reg(), n);
+            sim.compileNetwork();
+            sim.compileAlarms();
+            sim.preallocate();
+            sim.setBatched(batched);
+            std::cerr << "n=" << plant.entities << " " << mode << "\n";
+
+            // Per-system microbenchmarks, straight through the pipeline table
+            const Scheduler& sched = sim.scheduler();
+            for (std::size_t i = 0; i < sched.size(); ++i) {
+                const auto& sys = sched.system(i);
+                auto [ns, iters] = measure([&] { sys.run(sim.reg(), sim.dt()); }, budget_s);
+                results.push_back({"system", sys.name, mode, plant.entities, 1, iters, ns});
+            }
+
+            // End-to-end ticks, sequential and across all cores
+            for (unsigned threads : {1u, hw}) {
+                sim.setThreads(threads);
+                auto [ns, iters] = measure([&] { sim.tick(); }, budget_s);
+                results.push_back({"tick", "SimRunner::tick", mode, plant.entities, threads, iters, ns});
+                if (hw == 1)
+                    break;
+            }
+        }
+    }
+
+    // Newton solve on a meshed network; "valves" moves one valve per call
+    for (std::size_t n : sizes) {
+        SimRunner sim;
+        generatePipeNetwork(sim.reg(), n);
+        sim.compileNetwork();
+        auto* net = sim.reg().ctx().find<FlowNetwork>();
+        if (!net)
+            continue;
+        std::cerr << "pipes=" << net->edgeCount() << " network\n";
+
+        auto [ns, iters] = measure([&] { HydraulicsSystem(sim.reg(), sim.dt()); }, budget_s);
+        results.push_back({"network", "Hydraulics", "steady", net->edgeCount(), 1, iters, ns});
+
+        auto valves = sim.reg().view<ValveActuator>();
+        auto it = valves.begin();
+        auto [ns_v, iters_v] = measure([&] {
+            if (it == valves.end())
+                it = valves.begin();
+            auto& v = valves.get<ValveActuator>(*it++);
+            v.pos = v.pos > 0.5f ? v.pos - 0.25f : v.pos + 0.25f;
+            HydraulicsSystem(sim.reg(), sim.dt());
+        }, budget_s);
+        results.push_back({"network", "Hydraulics", "valves", net->edgeCount(), 1, iters_v, ns_v});
+    }
+
+    if (out_path.empty()) {
+        writeJson(std::cout, results);
+    } else {
+        std::ofstream f(out_path);
+        writeJson(f, results);
+    }
+    return 0;
+}
@@ -2,6 +2,7 @@
 #include <QToolBar>
 #include <QStatusBar>
 #include <QAction>
+#include <QComboBox>
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
@@ -9,6 +10,13 @@ MainWindow::MainWindow(QWidget* parent)
     auto* tb = addToolBar("Sim");
     auto* actStart = tb->addAction("Start");
     auto* actStop  = tb->addAction("Stop");
+
+    // Faster-than-real-time multiplier; dt stays fixed so runs are repeatable
+    auto* speed = new QComboBox(tb);
+    for (double x : {0.1, 0.5, 1.0, 2.0, 10.0, 100.0, 1000.0})
+        speed->addItem(QString("%1x").arg(x), x);
+    speed->setCurrentIndex(2);
+    tb->addWidget(speed);
     statusBar()->showMessage("Ready");
 
     // Scene + view
@@ -18,8 +26,9 @@ MainWindow::MainWindow(QWidget* parent)
     view_->setBackgroundBrush(QColor("#303030"));
     setCentralWidget(view_);
 
-    // Load JSON model
-    model_.loadFromFile("plant_default.json");
+    // One parse feeds both the ECS and the UI model
+    sim_.loadDefaultScenario();
+    model_.loadFromDescription(sim_.runner().plant());
 
     // Compute layout
     PlantLayout::computeLayout(model_);
@@ -27,24 +36,39 @@ MainWindow::MainWindow(QWidget* parent)
     // Build visuals
     pscene_->build(model_);
 
-    // Connect simulation and start
-    connect(&sim_, &SimCore::frameReady, this, &MainWindow::onFrameReady);
-    sim_.loadDefaultScenario();
+    // UI pulls the newest sim snapshot at its own rate; sim frames in
+    // between coalesce in the snapshot channel
+    connect(&uiTimer_, &QTimer::timeout, this, &MainWindow::onUiRefresh);
+    uiTimer_.start(33);
+
+    sim_.bindModel(model_);
     sim_.start(50.f);
     // qDebug() << "Entities in registry after default scenario =" << registry_.alive();
 
 
     connect(actStart, &QAction::triggered, this, [this] { sim_.start(50.f); });
     connect(actStop,  &QAction::triggered, this, [this] { sim_.stop(); });
+    connect(speed, &QComboBox::currentIndexChanged, this, [this, speed](int i) {
+        sim_.setTimeScale(speed->itemData(i).toDouble());
+    });
 }
 
-void MainWindow::onFrameReady() {
-    // Update JSON model with ECS values
-    sim_.updateModel(model_);
+void MainWindow::onUiRefresh() {
+    // Pull the newest sim snapshot into the model (changed nodes only)
+    if (!sim_.updateModel(model_))
+        return;
 
     // Update scene text
     pscene_->updateValues(model_);
 
+    const ClockStats& cs = sim_.clock().stats();
+    statusBar()->showMessage(QString("t=%1 s  x%2  lag %3 s  overruns %4  dropped %5 s")
+                                 .arg(sim_.runner().simTime(), 0, 'f', 1)
+                                 .arg(sim_.clock().timeScale())
+                                 .arg(cs.lag_s, 0, 'f', 2)
+                                 .arg(cs.overruns)
+                                 .arg(cs.dropped_s, 0, 'f', 2));
+
     // layout_->updateItems(model_);
     // qDebug() << "FrameReady";
 
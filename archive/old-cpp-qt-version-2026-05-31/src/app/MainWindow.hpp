@@ -1,6 +1,7 @@
 #pragma once
 #include <QMainWindow>
 #include <QGraphicsView>
+#include <QTimer>
 #include "../sim/SimCore.hpp"
 #include "../ui/PlantScene.hpp"
 #include "../ui/PlantModel.hpp"
@@ -12,10 +13,11 @@ public:
     explicit MainWindow(QWidget* parent = nullptr);
 
 private slots:
-    void onFrameReady();
+    void onUiRefresh();
 
 private:
     SimCore sim_;
+    QTimer uiTimer_;    // UI repaint rate, independent of the sim rate
 
     QGraphicsView* view_{nullptr};
     PlantScene* pscene_{nullptr};
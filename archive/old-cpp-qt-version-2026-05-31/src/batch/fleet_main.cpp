@@ -0,0 +1,51 @@
+#include "sim/PlantFleet.hpp"
+#include "sim/MonteCarlo.hpp"
+#include "sim/SimRunner.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static void printStats(const char* name, const KpiStats& s) {
+    std::cout << name << ": mean " << s.mean << "  p05 " << s.p05 << "  p50 " << s.p50
+              << "  p95 " << s.p95 << "  min " << s.min << "  max " << s.max << "\n";
+}
+
+// Classroom fleet: simfleet [plant.json] [instances] [hours] [hz] [threads]
+int main(int argc, char** argv) {
+    const std::string plant = argc > 1 ? argv[1] : "plant_default.json";
+    const auto   instances  = argc > 2 ? static_cast<std::size_t>(std::atoll(argv[2])) : 30;
+    const double hours      = argc > 3 ? std::atof(argv[3]) : 1.0;
+    const float  hz         = argc > 4 ? static_cast<float>(std::atof(argv[4])) : 50.f;
+    const int    threads    = argc > 5 ? std::atoi(argv[5]) : 1;
+
+    PlantFleet fleet(1.0f / std::max(1.0f, hz));
+    if (!fleet.load(plant, instances))
+        return 1;
+    fleet.setThreads(static_cast<unsigned>(std::max(1, threads)));
+
+    const auto t0 = std::chrono::steady_clock::now();
+    fleet.run_until(hours * 3600.0);
+    const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << "instances:  " << fleet.size() << "  threads: " << fleet.threads() << "\n"
+              << "steps:      " << fleet.step() << "\n"
+              << "wall time:  " << wall_s << " s\n"
+              << "speedup:    " << (wall_s > 0.0 ? fleet.simTime() / wall_s : 0.0) << "x per instance, "
+              << (wall_s > 0.0 ? fleet.simTime() * static_cast<double>(fleet.size()) / wall_s : 0.0) << "x total\n";
+
+    std::vector<double> raised, downtime, mttr;
+    for (std::size_t i = 0; i < fleet.size(); ++i) {
+        if (const SiteKPI* k = fleet.kpi(i)) {
+            raised.push_back(k->alarms_raised);
+            downtime.push_back(k->downtime_s);
+            mttr.push_back(k->mttr_s);
+        }
+    }
+    printStats("alarms_raised", MonteCarlo::summarize(raised));
+    printStats("downtime_s   ", MonteCarlo::summarize(downtime));
+    printStats("mttr_s       ", MonteCarlo::summarize(mttr));
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "sim/SimRunner.hpp"
+#include "sim/AlarmMetrics.hpp"
+#include "sim/Components.hpp"
+#include "sim/Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+// Headless batch runner: simbatch [plant.json] [hours] [hz] [threads] [trace.json]
+int main(int argc, char** argv) {
+    const std::string plant = argc > 1 ? argv[1] : "plant_default.json";
+    const double hours      = argc > 2 ? std::atof(argv[2]) : 24.0;
+    const float  hz         = argc > 3 ? static_cast<float>(std::atof(argv[3])) : 50.f;
+    const int    threads    = argc > 4 ? std::atoi(argv[4]) : 1;
+
+    SimRunner sim(1.0f / std::max(1.0f, hz));
+    if (!sim.loadDefaultScenario(plant))
+        return 1;
+    sim.setThreads(static_cast<unsigned>(std::max(1, threads)));
+
+    const auto t0 = std::chrono::steady_clock::now();
+    sim.run_until(hours * 3600.0);
+    const auto t1 = std::chrono::steady_clock::now();
+    const double wall_s = std::chrono::duration<double>(t1 - t0).count();
+
+    std::cout << "steps:      " << sim.step() << "\n"
+              << "sim time:   " << sim.simTime() << " s\n"
+              << "wall time:  " << wall_s << " s\n"
+              << "speedup:    " << (wall_s > 0.0 ? sim.simTime() / wall_s : 0.0) << "x\n";
+
+    auto kpis = sim.reg().view<SiteKPI>();
+    for (auto e : kpis) {
+        const auto& k = kpis.get<SiteKPI>(e);
+        std::cout << "alarms_raised: " << k.alarms_raised
+                  << "  alarms_active: " << k.alarms_active
+                  << "  downtime_s: " << k.downtime_s << "\n"
+                  << "alarms/hour: " << k.alarms_per_hour
+                  << "  median ack: " << k.median_ack_s << " s"
+                  << "  median repair: " << k.median_repair_s << " s"
+                  << "  MTTR: " << k.mttr_s << " s\n"
+                  << "downtime (last hour): " << k.downtime_min_hour << " min"
+                  << "  throughput: " << k.throughput
+                  << "  delta: " << k.throughput_delta << "\n";
+    }
+
+    if (const auto* metrics = sim.reg().ctx().find<AlarmMetrics>()) {
+        const AlarmMetricsReport m = metrics->report();
+        std::cout << "alarms/operator/10min: avg " << m.avg_per_period << "  peak " << m.peak_rate
+                  << "  periods: " << m.periods << " (acceptable " << m.periods_acceptable
+                  << ", manageable " << m.periods_manageable << ", flood " << m.periods_flood << ")\n"
+                  << "floods: " << m.floods << " (" << m.flood_s << " s)"
+                  << "  chattering: " << m.chattering << " now, " << m.chatter_episodes << " episodes"
+                  << "  stale: " << m.stale << " now, " << m.stale_total << " total\n";
+
+        std::unordered_map<entt::entity, const std::string*> names;
+        for (const auto& [id, e] : sim.entityFromId)
+            names[e] = &id;
+        std::cout << "bad actors:";
+        for (const auto& b : metrics->badActors(10)) {
+            auto it = names.find(b.entity);
+            std::cout << "  " << (it != names.end() ? *it->second : std::to_string(entt::to_integral(b.entity)))
+                      << "=" << b.count;
+        }
+        std::cout << "\n";
+    }
+
+    const Scheduler& sched = sim.scheduler();
+    std::cout << "system timings (avg us, " << sim.threads() << " thread(s)):\n";
+    for (std::size_t i = 0; i < sched.size(); ++i)
+        std::cout << "  " << sched.system(i).name << ": " << sched.timing(i).avg_us << "\n";
+
+    std::cout << "critical path (" << sched.criticalPathUs() << " us):";
+    for (std::size_t i : sched.criticalPath())
+        std::cout << " " << sched.system(i).name;
+    std::cout << "\n";
+
+#if defined(EXECSIM_PROFILING) && EXECSIM_PROFILING
+    std::cout << "profile (last 1000 calls): p50 / p99 us, entities, allocs\n";
+    for (const auto& s : Profiler::summarize(1000))
+        std::cout << "  " << s.name << ": " << s.p50_us << " / " << s.p99_us
+                  << "  " << s.mean_entities << "  " << s.mean_allocs << "\n";
+    if (argc > 5 && Profiler::writeChromeTrace(argv[5]))
+        std::cout << "trace written to " << argv[5] << "\n";
+#endif
+#if defined(EXECSIM_ALLOC_CHECK) && EXECSIM_ALLOC_CHECK
+    const std::uint64_t violations = Profiler::allocViolations();
+    std::cout << "heap allocations inside ticks: " << violations << "\n";
+    if (violations > 0)
+        return 2;
+#endif
+    return 0;
+}
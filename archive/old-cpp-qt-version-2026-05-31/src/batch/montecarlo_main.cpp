@@ -0,0 +1,53 @@
+#include "sim/MonteCarlo.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+static void printStats(const char* name, const KpiStats& s) {
+    std::cout << name << ": mean " << s.mean << " (95% CI " << s.ci95_lo << " .. " << s.ci95_hi << ")"
+              << "  p05 " << s.p05 << "  p50 " << s.p50 << "  p95 " << s.p95
+              << "  min " << s.min << "  max " << s.max << "\n";
+}
+
+// Monte Carlo runner: simmc [plant.json] [replicas] [hours] [seed] [replicas.csv]
+int main(int argc, char** argv) {
+    MonteCarloConfig cfg;
+    if (argc > 1) cfg.plant_path = argv[1];
+    if (argc > 2) cfg.replicas   = static_cast<std::size_t>(std::atoll(argv[2]));
+    if (argc > 3) cfg.horizon_s  = std::atof(argv[3]) * 3600.0;
+    if (argc > 4) cfg.seed       = std::strtoull(argv[4], nullptr, 10);
+
+    const MonteCarloReport rep = MonteCarlo::run(cfg);
+
+    std::cout << "replicas: " << rep.replicas.size() << "  seed: " << cfg.seed
+              << "  wall: " << rep.wall_s << " s\n";
+    if (rep.failed > 0)
+        std::cerr << rep.failed << " replicas failed to load " << cfg.plant_path << "\n";
+    printStats("alarms_raised", rep.alarms_raised);
+    printStats("downtime_s   ", rep.downtime_s);
+    printStats("alarms/hour  ", rep.alarms_per_hour);
+    printStats("median_ack_s ", rep.median_ack_s);
+    printStats("mttr_s       ", rep.mttr_s);
+    printStats("thru_delta   ", rep.throughput_delta);
+    printStats("alarms/10min ", rep.alarms_per_10min);
+    printStats("flood_pct    ", rep.flood_pct);
+
+    if (argc > 5) {
+        std::ofstream csv(argv[5]);
+        csv << "index,seed,training,fatigue,shift_length_hours,staff_on_shift,"
+               "ack_delay_target_s,repair_time_target_s,alarms_raised,downtime_s,"
+               "alarms_per_hour,median_ack_s,mttr_s,throughput_delta\n";
+        for (const auto& r : rep.replicas) {
+            if (r.failed)
+                continue;
+            csv << r.index << ',' << r.seed << ',' << r.hf.training << ',' << r.hf.fatigue << ','
+                << r.hf.shift_length_hours << ',' << r.hf.staff_on_shift << ','
+                << r.ack_delay_target_s << ',' << r.repair_time_target_s << ','
+                << r.kpi.alarms_raised << ',' << r.kpi.downtime_s << ','
+                << r.kpi.alarms_per_hour << ',' << r.kpi.median_ack_s << ','
+                << r.kpi.mttr_s << ',' << r.kpi.throughput_delta << "\n";
+        }
+    }
+    return 0;
+}
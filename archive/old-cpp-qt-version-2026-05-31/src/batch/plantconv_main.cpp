@@ -0,0 +1,41 @@
+#include "sim/Loader.hpp"
+#include "sim/PlantImage.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// JSON → binary plant image: plantconv [plant.json] [plant.simg]
+// The image holds the plant only; site singletons are still added at load.
+int main(int argc, char** argv) {
+    const std::string in  = argc > 1 ? argv[1] : "plant_default.json";
+    std::string out       = argc > 2 ? argv[2] : in;
+    if (argc <= 2) {
+        const auto dot = out.rfind('.');
+        out = (dot == std::string::npos ? out : out.substr(0, dot)) + ".simg";
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    entt::registry reg;
+    std::unordered_map<std::string, entt::entity> entityFromId;
+    if (!Loader::loadPlant(in, reg, entityFromId))
+        return 1;
+    const auto t1 = std::chrono::steady_clock::now();
+
+    if (!PlantImage::save(out, reg, entityFromId))
+        return 1;
+
+    // Load it back so a broken image is caught here rather than at startup
+    entt::registry check;
+    std::unordered_map<std::string, entt::entity> checkIds;
+    const auto t2 = std::chrono::steady_clock::now();
+    if (!PlantImage::load(out, check, checkIds))
+        return 1;
+    const auto t3 = std::chrono::steady_clock::now();
+
+    auto ms = [](auto a, auto b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+    std::cout << in << " -> " << out << "\n"
+              << "ids:        " << entityFromId.size() << "\n"
+              << "json load:  " << ms(t0, t1) << " ms\n"
+              << "image load: " << ms(t2, t3) << " ms\n";
+    return checkIds.size() == entityFromId.size() ? 0 : 1;
+}
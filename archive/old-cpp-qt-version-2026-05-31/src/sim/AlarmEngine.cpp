@@ -0,0 +1,137 @@
+#include "AlarmEngine.hpp"
+#include "ComponentReflect.hpp"
+#include "SiteContext.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+// Min-heap on deadline; ties by point so equal deadlines pop in a fixed order
+bool later(const AlarmEngine::Timer& a, const AlarmEngine::Timer& b) {
+    return a.deadline > b.deadline || (a.deadline == b.deadline && a.point > b.point);
+}
+}
+
+AlarmEngine AlarmEngine::compile(entt::registry& r, const AlarmTimerState& keep) {
+    AlarmEngine eng;
+    const auto& table = componentTable();
+    const ComponentInfo& tank = table[componentIndex<Tank>()];
+    const FieldInfo* level = tank.field("level");
+
+    auto v = r.view<Alarmable>();
+    for (auto e : v) {
+        auto& a = v.get<Alarmable>(e);
+
+        const ComponentInfo* info = &tank;
+        const FieldInfo* f = level;
+        if (a.source_component >= 0) {
+            info = a.source_component < static_cast<int>(table.size()) ? &table[a.source_component] : nullptr;
+            f = info && a.source_field >= 0 && a.source_field < static_cast<int>(info->fields.size())
+                ? &info->fields[a.source_field] : nullptr;
+            if (!f || f->kind != FieldKind::Float) {
+                std::cerr << "Alarm source is not a float field; alarm ignored\n";
+                continue;
+            }
+        }
+        void* c = info->get(r, e);
+        if (!c)
+            continue;  // nothing to watch (matches the Tank+Alarmable view)
+
+        const auto p = static_cast<std::uint32_t>(eng.entity.size());
+        eng.entity.push_back(e);
+        eng.source.push_back(reinterpret_cast<const float*>(static_cast<const char*>(c) + f->offset));
+        eng.alarm.push_back(&a);
+        eng.site.push_back(SiteContext::siteOf(r, e));
+        eng.point_of.emplace(e, p);
+        eng.sources |= ComponentSet{1} << info->index;
+    }
+    const std::size_t n = eng.entity.size();
+    eng.slot.assign(n, -1);
+    eng.gen.assign(n, 0);
+
+    // Sized for the plant so ticks don't grow them: one response and one
+    // retrigger per point, a live plus a stale timer (schedule() compacts
+    // past that), and a crossing, raise, ack and repair in the same tick
+    eng.active.reserve(n);
+    eng.retrigger.reserve(n);
+    eng.timers.reserve(2 * n);
+    eng.events.reserve(4 * n);
+    eng.restore(keep);
+    return eng;
+}
+
+void AlarmEngine::activate(std::uint32_t p, double t, double deadline) {
+    slot[p] = static_cast<std::int32_t>(active.size());
+    active.push_back({p, t, deadline});
+    schedule(p, deadline);
+}
+
+void AlarmEngine::reschedule(std::uint32_t p, double deadline) {
+    active[slot[p]].deadline = deadline;
+    schedule(p, deadline);
+}
+
+void AlarmEngine::schedule(std::uint32_t p, double deadline) {
+    // At most one live timer per active point; once the stale ones left by
+    // cancels and re-arms reach n, drop them so the heap stays inside the 2n
+    // compile() reserved. Live timers keep their (deadline, point) order.
+    if (timers.size() >= active.size() + size()) {
+        timers.erase(std::remove_if(timers.begin(), timers.end(),
+                                    [&](const Timer& t) { return t.gen != gen[t.point] || slot[t.point] < 0; }),
+                     timers.end());
+        std::make_heap(timers.begin(), timers.end(), later);
+    }
+    timers.push_back({deadline, p, ++gen[p]});
+    std::push_heap(timers.begin(), timers.end(), later);
+}
+
+void AlarmEngine::deactivate(std::uint32_t p) {
+    const std::int32_t i = slot[p];
+    if (i < 0)
+        return;
+    active[i] = active.back();
+    slot[active[i].point] = i;
+    active.pop_back();
+    slot[p] = -1;
+    ++gen[p];  // its queued timer is now stale
+}
+
+bool AlarmEngine::popDue(double t, Timer& out) {
+    while (!timers.empty() && timers.front().deadline <= t) {
+        std::pop_heap(timers.begin(), timers.end(), later);
+        out = timers.back();
+        timers.pop_back();
+        if (out.gen == gen[out.point] && slot[out.point] >= 0)
+            return true;
+    }
+    return false;
+}
+
+AlarmTimerState AlarmEngine::state() const {
+    AlarmTimerState s;
+    s.now = now;
+    s.active.reserve(active.size());
+    for (const auto& a : active)
+        s.active.push_back({entity[a.point], a.raised_at, a.deadline});
+    for (auto p : retrigger)
+        s.retrigger.push_back(entity[p]);
+    return s;
+}
+
+void AlarmEngine::restore(const AlarmTimerState& s) {
+    for (const auto& a : active) {
+        slot[a.point] = -1;
+        ++gen[a.point];
+    }
+    active.clear();
+    timers.clear();
+    retrigger.clear();
+    events.clear();
+    now = s.now;
+
+    for (const auto& a : s.active)
+        if (auto it = point_of.find(a.entity); it != point_of.end())
+            activate(it->second, a.raised_at, a.deadline);
+    for (auto e : s.retrigger)
+        if (auto it = point_of.find(e); it != point_of.end())
+            retrigger.push_back(it->second);
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <entt/entt.hpp>
+#include "Components.hpp"
+#include "Scheduler.hpp"
+
+enum class AlarmEventKind : std::uint8_t {
+  Activated,     // AlarmSystem: value crossed a setpoint
+  Returned,      // AlarmSystem: back inside both setpoints
+  Raised,        // ResponseSystem: response started, ack deadline set
+  Acknowledged,
+  Repaired,      // response finished, alarm unlatched
+  Cancelled,     // returned and unlatched before anyone acknowledged
+};
+
+struct AlarmEvent {
+  double t;              // engine time at the start of the tick
+  entt::entity entity;
+  std::uint32_t point;
+  AlarmEventKind kind;
+  float value;           // process value (Activated/Returned), raise → event seconds (Acknowledged/Repaired)
+};
+
+// What a checkpoint needs to resume the timers; keyed by entity so it
+// survives a recompile that renumbers points.
+struct AlarmTimerState {
+  struct Active {
+    entt::entity entity;
+    double raised_at;
+    double deadline;     // ack deadline, then repair deadline once acknowledged
+  };
+  double now{0.0};
+  std::vector<Active> active;
+  std::vector<entt::entity> retrigger;
+
+  std::size_t bytes() const { return active.size() * sizeof(Active) + retrigger.size() * sizeof(entt::entity); }
+};
+
+// Compiled alarm points: every Alarmable bound to the float it watches
+// (Tank::level unless Alarmable::source_* names another field on the same
+// entity). Pointers are cached like FlowNetwork's, so re-run compile() after
+// adding or removing alarm or source components.
+//
+// AlarmSystem compares each point against its setpoints and only emits an
+// event on a crossing. ResponseSystem turns those into responses whose ack
+// and repair deadlines sit in a min-heap, so its per-tick work is the
+// crossings plus the timers that fall due, not every point. Events live
+// until the next tick's AlarmSystem, for AnalyticsSystem and other readers.
+struct AlarmEngine {
+  struct Timer {
+    double deadline;
+    std::uint32_t point;
+    std::uint32_t gen;   // stale once the point's gen moves on
+  };
+  struct Active {
+    std::uint32_t point;
+    double raised_at;
+    double deadline;
+  };
+
+  // Per point
+  std::vector<entt::entity> entity;
+  std::vector<const float*> source;
+  std::vector<Alarmable*> alarm;
+  std::vector<int> site;              // Area::site (SiteContext)
+  std::vector<std::int32_t> slot;     // index in `active`, -1 when idle
+  std::vector<std::uint32_t> gen;
+
+  std::vector<Active> active;          // responses in progress
+  std::vector<std::uint32_t> retrigger; // repaired while still in alarm: raise again next tick
+  std::vector<Timer> timers;           // min-heap on deadline
+  std::vector<AlarmEvent> events;      // this tick's, in order
+  double now{0.0};                     // advanced by ResponseSystem
+
+  ComponentSet sources{0};             // components read by AlarmSystem
+  std::unordered_map<entt::entity, std::uint32_t> point_of;
+
+  std::size_t size() const { return entity.size(); }
+
+  static AlarmEngine compile(entt::registry& r, const AlarmTimerState& keep = {});
+
+  void emit(std::uint32_t p, double t, AlarmEventKind kind, float value) {
+    events.push_back({t, entity[p], p, kind, value});
+  }
+
+  // Setpoints with the deadband applied to an alarm that is already in
+  static float hiLimit(const Alarmable& a) { return a.hi ? a.hiSP - a.deadband : a.hiSP; }
+  static float loLimit(const Alarmable& a) { return a.lo ? a.loSP + a.deadband : a.loSP; }
+
+  // True when update(p, v, hi, lo) would change nothing: same flags, and
+  // already latched if in alarm (a repair can unlatch a point still in).
+  bool settled(std::uint32_t p, bool hi, bool lo) const {
+    const Alarmable& a = *alarm[p];
+    return a.hi == hi && a.lo == lo && (a.latched || !(hi || lo));
+  }
+
+  // Stores this tick's hi/lo for point p (value v) and emits the crossing, if any.
+  void update(std::uint32_t p, float v, bool hi, bool lo) {
+    Alarmable& a = *alarm[p];
+    const bool was = a.hi || a.lo;
+    a.hi = hi;
+    a.lo = lo;
+    a.latched = a.latched || hi || lo;
+    if ((hi || lo) != was)
+      emit(p, now, was ? AlarmEventKind::Returned : AlarmEventKind::Activated, v);
+  }
+
+  void activate(std::uint32_t p, double t, double deadline);
+  void reschedule(std::uint32_t p, double deadline);
+  void deactivate(std::uint32_t p);
+  // Pops the next live timer due at or before t.
+  bool popDue(double t, Timer& out);
+
+  AlarmTimerState state() const;
+  void restore(const AlarmTimerState& s);
+
+private:
+  // Queues p's next timer, dropping stale entries first if they have piled up
+  void schedule(std::uint32_t p, double deadline);
+};
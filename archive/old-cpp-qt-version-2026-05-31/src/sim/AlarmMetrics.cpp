@@ -0,0 +1,252 @@
+#include "AlarmMetrics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+AlarmMetrics::AlarmMetrics(const AlarmMetricsConfig& cfg)
+    : cfg_(cfg), recent_(10, cfg.period_s / 10.0) {
+    cfg_.operators = std::max(1, cfg_.operators);
+    cfg_.chatter_count = std::clamp(cfg_.chatter_count, 1, 0xFFFF);
+    cfg_.bad_actor_slots = std::max<std::size_t>(1, cfg_.bad_actor_slots);
+    cfg_.max_pending = std::max<std::size_t>(1, cfg_.max_pending);  // the cap pops before each push
+    actors_.reserve(cfg_.bad_actor_slots);
+}
+
+void AlarmMetrics::PendingQueue::reserve(std::size_t n) {
+    if (n <= buf_.size())
+        return;
+    std::size_t cap = 16;
+    while (cap < n)
+        cap *= 2;
+    std::vector<Pending> grown(cap);
+    for (std::size_t k = 0; k < size_; ++k)
+        grown[k] = buf_[(head_ + k) & (buf_.size() - 1)];
+    buf_.swap(grown);
+    head_ = 0;
+}
+
+void AlarmMetrics::PendingQueue::push_back(const Pending& p) {
+    if (size_ == buf_.size())
+        reserve(size_ + 1);
+    buf_[(head_ + size_) & (buf_.size() - 1)] = p;
+    ++size_;
+}
+
+void AlarmMetrics::PendingQueue::assign(const PendingQueue& from) {
+    reserve(from.size_);
+    for (std::size_t k = 0; k < from.size_; ++k)
+        buf_[k] = from.buf_[(from.head_ + k) & (from.buf_.size() - 1)];
+    head_ = 0;
+    size_ = from.size_;
+}
+
+void AlarmMetrics::reserve(std::size_t entities, std::size_t points) {
+    if (entities > points_.size())
+        points_.resize(entities);
+    // Enough for every point to sit at the chatter threshold inside the window
+    const std::size_t pending = std::min(cfg_.max_pending, points * static_cast<std::size_t>(cfg_.chatter_count));
+    chatter_.reserve(pending);
+    standing_.reserve(points);
+}
+
+AlarmMetrics::PointStats& AlarmMetrics::stats(entt::entity e) {
+    const auto i = entt::to_entity(e);
+    if (i >= points_.size())
+        points_.resize(i + 1);
+    return points_[i];
+}
+
+void AlarmMetrics::onEvent(const AlarmEvent& ev) {
+    if (ev.kind == AlarmEventKind::Activated)
+        activated(ev);
+    else if (ev.kind == AlarmEventKind::Returned)
+        returned(ev);
+}
+
+void AlarmMetrics::activated(const AlarmEvent& ev) {
+    auto& ps = stats(ev.entity);
+    const std::uint32_t index = entt::to_entity(ev.entity);
+
+    ++r_.activations;
+    closePeriods(static_cast<std::int64_t>(std::floor(ev.t / cfg_.period_s)));
+    ++period_count_;
+    recent_.add(ev.t, 1.0);
+
+    // Chattering: too many activations of one point inside the window
+    if (chatter_.size() >= cfg_.max_pending) {
+        auto& old = points_[chatter_.front().index];
+        if (old.recent-- == static_cast<std::uint16_t>(cfg_.chatter_count))
+            --r_.chattering;
+        chatter_.pop_front();
+    }
+    chatter_.push_back({ev.t, index});
+    if (++ps.recent == static_cast<std::uint16_t>(cfg_.chatter_count)) {
+        ++r_.chattering;
+        ++r_.chatter_episodes;
+    }
+    if (ps.recent >= cfg_.chatter_count)
+        ++r_.chatter_activations;
+
+    // Stale: still the same activation once stale_s has passed
+    if (!ps.active) {
+        ps.active = 1;
+        ps.slot = static_cast<std::uint32_t>(standing_.size());
+        standing_.push_back(index);
+    }
+    ps.since = ev.t;
+    if (!ps.stale)
+        next_stale_ = std::min(next_stale_, ev.t + cfg_.stale_s);
+
+    countBadActor(ev.entity);
+}
+
+void AlarmMetrics::returned(const AlarmEvent& ev) {
+    auto& ps = stats(ev.entity);
+    if (!ps.active)
+        return;
+    ps.active = 0;
+    standing_[ps.slot] = standing_.back();
+    points_[standing_.back()].slot = ps.slot;
+    standing_.pop_back();
+    if (ps.stale) {
+        ps.stale = 0;
+        --r_.stale;
+    }
+}
+
+void AlarmMetrics::countBadActor(entt::entity e) {
+    // A few dozen slots: a flat scan beats hashing and never allocates
+    std::size_t min = 0;
+    for (std::size_t i = 0; i < actors_.size(); ++i) {
+        if (actors_[i].entity == e) {
+            ++actors_[i].count;
+            return;
+        }
+        if (actors_[i].count < actors_[min].count)
+            min = i;
+    }
+    if (actors_.size() < cfg_.bad_actor_slots) {
+        actors_.push_back({e, 1, 0});
+        return;
+    }
+    // Take over the least frequent counter; its count bounds the newcomer's error
+    const std::uint64_t floor = actors_[min].count;
+    actors_[min] = {e, floor + 1, floor};
+}
+
+void AlarmMetrics::closePeriods(std::int64_t upto) {
+    if (upto <= period_)
+        return;
+    const double ops = static_cast<double>(cfg_.operators);
+    const double rate = static_cast<double>(period_count_) / ops;
+    ++r_.periods;
+    r_.periods_acceptable += rate <= 1.0;
+    r_.periods_manageable += rate <= 2.0;
+    r_.periods_flood      += rate >= cfg_.flood_start;
+    period_count_ = 0;
+
+    // Periods with no activations at all
+    const auto quiet = static_cast<std::uint64_t>(upto - period_ - 1);
+    r_.periods += quiet;
+    r_.periods_acceptable += quiet;
+    r_.periods_manageable += quiet;
+    period_ = upto;
+}
+
+void AlarmMetrics::advance(double now) {
+    closePeriods(static_cast<std::int64_t>(std::floor(now / cfg_.period_s)));
+    recent_.advance(now);
+
+    if (r_.in_flood)
+        r_.flood_s += now - now_;
+    r_.rate = recent_.recent() / static_cast<double>(cfg_.operators);
+    r_.peak_rate = std::max(r_.peak_rate, r_.rate);
+    if (!r_.in_flood && r_.rate >= cfg_.flood_start) {
+        r_.in_flood = true;
+        ++r_.floods;
+    } else if (r_.in_flood && r_.rate < cfg_.flood_end) {
+        r_.in_flood = false;
+    }
+    now_ = now;
+
+    while (!chatter_.empty() && chatter_.front().t + cfg_.chatter_window_s < now) {
+        auto& ps = points_[chatter_.front().index];
+        if (ps.recent-- == static_cast<std::uint16_t>(cfg_.chatter_count))
+            --r_.chattering;
+        chatter_.pop_front();
+    }
+
+    if (now >= next_stale_)
+        markStale(now);
+}
+
+void AlarmMetrics::markStale(double now) {
+    next_stale_ = std::numeric_limits<double>::infinity();
+    for (const std::uint32_t index : standing_) {
+        auto& ps = points_[index];
+        if (ps.stale)
+            continue;
+        const double due = ps.since + cfg_.stale_s;
+        if (due <= now) {
+            ps.stale = 1;
+            ++r_.stale;
+            ++r_.stale_total;
+        } else {
+            next_stale_ = std::min(next_stale_, due);
+        }
+    }
+}
+
+AlarmMetricsReport AlarmMetrics::report() const {
+    AlarmMetricsReport out = r_;
+    const double periods = (now_ - start_) / cfg_.period_s;
+    if (periods > 0.0)
+        out.avg_per_period = static_cast<double>(r_.activations) / static_cast<double>(cfg_.operators) / periods;
+    return out;
+}
+
+std::vector<BadActor> AlarmMetrics::badActors(std::size_t n) const {
+    std::vector<BadActor> out = actors_;
+    n = std::min(n, out.size());
+    std::partial_sort(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(n), out.end(),
+                      [](const BadActor& a, const BadActor& b) { return a.count > b.count; });
+    out.resize(n);
+    return out;
+}
+
+void AlarmMetrics::publish(SiteKPI& kpi) const {
+    kpi.alarms_per_10min = static_cast<float>(r_.rate);
+    kpi.flood_pct = r_.periods ? static_cast<float>(100.0 * static_cast<double>(r_.periods_flood) /
+                                                    static_cast<double>(r_.periods)) : 0.0f;
+    kpi.chattering = static_cast<int>(r_.chattering);
+    kpi.stale = static_cast<int>(r_.stale);
+}
+
+AlarmMetrics AlarmMetrics::compact() const {
+    AlarmMetrics out(cfg_);
+    out.restore(*this);
+    return out;
+}
+
+void AlarmMetrics::restore(const AlarmMetrics& saved) {
+    cfg_          = saved.cfg_;
+    now_          = saved.now_;
+    start_        = saved.start_;
+    points_       = saved.points_;
+    chatter_.assign(saved.chatter_);
+    standing_     = saved.standing_;
+    next_stale_   = saved.next_stale_;
+    recent_       = saved.recent_;
+    period_       = saved.period_;
+    period_count_ = saved.period_count_;
+    actors_       = saved.actors_;
+    r_            = saved.r_;
+}
+
+std::size_t AlarmMetrics::bytes() const {
+    return sizeof(*this) + recent_.bytes() - sizeof(SlidingWindow)
+         + points_.capacity() * sizeof(PointStats)
+         + chatter_.capacity() * sizeof(Pending)
+         + standing_.capacity() * sizeof(std::uint32_t)
+         + actors_.capacity() * sizeof(BadActor);
+}
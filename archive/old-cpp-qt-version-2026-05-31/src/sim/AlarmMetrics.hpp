@@ -0,0 +1,142 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <entt/entt.hpp>
+#include "AlarmEngine.hpp"
+#include "KpiEngine.hpp"
+
+// ISA-18.2 / EEMUA 191 style thresholds. Rates are annunciated alarms
+// (AlarmEventKind::Activated) per operator per period.
+struct AlarmMetricsConfig {
+    double period_s{600.0};
+    int    operators{1};
+    double flood_start{10.0};        // a flood starts at this rate...
+    double flood_end{5.0};           // ...and ends below this one
+    double chatter_window_s{60.0};
+    int    chatter_count{3};         // activations of one point inside the window
+    double stale_s{24.0 * 3600.0};   // standing longer than this
+    std::size_t bad_actor_slots{64}; // space-saving counters
+    std::size_t max_pending{1u << 16}; // cap on the chatter queue
+};
+
+struct AlarmMetricsReport {
+    std::uint64_t activations{0};
+    double avg_per_period{0.0};      // per operator, over the whole run
+    double rate{0.0};                // per operator, trailing period
+    double peak_rate{0.0};
+
+    // Fixed periods, classified when they close
+    std::uint64_t periods{0};
+    std::uint64_t periods_acceptable{0};  // <= 1 per operator
+    std::uint64_t periods_manageable{0};  // <= 2 per operator
+    std::uint64_t periods_flood{0};       // >= flood_start
+
+    std::uint64_t floods{0};
+    double flood_s{0.0};
+    bool in_flood{false};
+
+    std::uint32_t chattering{0};          // points chattering right now
+    std::uint64_t chatter_episodes{0};
+    std::uint64_t chatter_activations{0}; // activations while chattering
+
+    std::uint32_t stale{0};               // standing longer than stale_s right now
+    std::uint64_t stale_total{0};
+};
+
+struct BadActor {
+    entt::entity entity;
+    std::uint64_t count;  // upper bound on activations
+    std::uint64_t error;  // count - error is a lower bound
+};
+
+// Lives in the registry context; AnalyticsSystem feeds it the alarm events
+// each tick. Work per event is O(1) plus a scan of the bad_actor_slots
+// space-saving counters. Stale points are found by scanning the standing
+// points, and only once the earliest of them is due. Memory is a few bytes
+// per alarm entity plus the chatter queue, whose length is bounded by
+// events inside the window and capped at max_pending, so it doesn't grow
+// with run length.
+class AlarmMetrics {
+public:
+    explicit AlarmMetrics(const AlarmMetricsConfig& cfg = {});
+
+    // Sizes the per-entity table (entity indices below `entities`), the
+    // chatter queue and the standing set for `points` alarm points up front,
+    // so a plant that stays inside that doesn't allocate while it runs.
+    void reserve(std::size_t entities, std::size_t points);
+
+    void onEvent(const AlarmEvent& ev);
+    void advance(double now);  // after the tick's events
+
+    AlarmMetricsReport report() const;
+    // Most frequent activators, highest count first (space-saving, Metwally et al. 2005)
+    std::vector<BadActor> badActors(std::size_t n) const;
+    void publish(SiteKPI& kpi) const;
+
+    const AlarmMetricsConfig& config() const { return cfg_; }
+    std::size_t bytes() const;
+
+    // Copy without the queues' spare capacity, which reserve() sizes for the
+    // worst case; checkpoints keep this instead of the live object.
+    AlarmMetrics compact() const;
+    // Takes over `saved`'s state but keeps this object's capacity, so
+    // restoring a compact copy doesn't make the next ticks allocate.
+    void restore(const AlarmMetrics& saved);
+
+private:
+    struct PointStats {
+        double        since{0.0}; // time of the activation still standing
+        std::uint32_t slot{0};    // position in standing_ while active
+        std::uint16_t recent{0};  // activations inside the chatter window
+        std::uint8_t  active{0};
+        std::uint8_t  stale{0};
+    };
+    struct Pending {
+        double t;
+        std::uint32_t index;      // entt::to_entity
+    };
+    // FIFO on a power-of-two ring that only grows when full; std::deque
+    // would free and allocate blocks as it cycles.
+    class PendingQueue {
+    public:
+        bool empty() const { return size_ == 0; }
+        std::size_t size() const { return size_; }
+        std::size_t capacity() const { return buf_.size(); }
+        const Pending& front() const { return buf_[head_]; }
+        void pop_front() { head_ = (head_ + 1) & (buf_.size() - 1); --size_; }
+        void push_back(const Pending& p);
+        void reserve(std::size_t n);
+        void assign(const PendingQueue& from);  // live entries; keeps this ring's capacity
+
+    private:
+        std::vector<Pending> buf_;
+        std::size_t head_{0};
+        std::size_t size_{0};
+    };
+
+    PointStats& stats(entt::entity e);
+    void activated(const AlarmEvent& ev);
+    void returned(const AlarmEvent& ev);
+    void countBadActor(entt::entity e);
+    void closePeriods(std::int64_t upto);
+    void markStale(double now);
+
+    AlarmMetricsConfig cfg_;
+    double now_{0.0};
+    double start_{0.0};               // engine time starts at 0 on load
+
+    std::vector<PointStats> points_;  // by entity index
+    PendingQueue chatter_;
+    std::vector<std::uint32_t> standing_;  // entity indices of active points, unordered
+    double next_stale_{std::numeric_limits<double>::infinity()};  // earliest a standing point can go stale
+
+    SlidingWindow recent_;            // activations, trailing period
+    std::int64_t period_{0};          // index of the open fixed period
+    std::uint64_t period_count_{0};
+
+    std::vector<BadActor> actors_;
+
+    AlarmMetricsReport r_;
+};
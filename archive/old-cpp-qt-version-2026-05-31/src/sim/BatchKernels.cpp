@@ -0,0 +1,224 @@
+#include "BatchKernels.hpp"
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BATCH_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BATCH_SSE2 1
+#endif
+
+namespace {
+
+// Scalar bodies; also used for the SIMD tails so both paths share one definition.
+inline void pidOne(float kp, float ki, float sp, float pv, float& integ, float& out, float dt) {
+    float err = sp - pv;
+    integ += err * dt;
+    out = std::clamp(kp*err + ki*integ, 0.f, 1.f);
+}
+
+inline void valveOne(float target, float speed, float& pos, float dt) {
+    float delta = std::clamp(target - pos, -speed*dt, speed*dt);
+    pos += delta;
+}
+
+inline void hxOne(float inlet, float pos, float tau, float flow, float& outlet, float dt, Integrator method) {
+    const float target  = inlet * std::clamp(pos, 0.0f, 1.0f);
+    const float tau_eff = std::max(0.1f, tau / std::max(0.1f, flow));
+    const float alpha   = lagAlpha(method, dt / tau_eff);
+    outlet += alpha * (target - outlet);
+}
+
+// Thin vector wrapper so each kernel is written once for AVX2 and SSE2.
+// Operand order of max/min is chosen to reproduce std::max/std::clamp
+// exactly, including signed zero and NaN propagation.
+#if defined(BATCH_AVX2)
+struct V {
+    __m256 v;
+    static constexpr std::size_t W = 8;
+    static V load(const float* p) { return {_mm256_loadu_ps(p)}; }
+    static V set1(float x) { return {_mm256_set1_ps(x)}; }
+    static V mask(const std::uint32_t* p) { return {_mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)))}; }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+    friend V operator+(V a, V b) { return {_mm256_add_ps(a.v, b.v)}; }
+    friend V operator-(V a, V b) { return {_mm256_sub_ps(a.v, b.v)}; }
+    friend V operator*(V a, V b) { return {_mm256_mul_ps(a.v, b.v)}; }
+    friend V operator/(V a, V b) { return {_mm256_div_ps(a.v, b.v)}; }
+    static V neg(V a) { return {_mm256_xor_ps(a.v, _mm256_set1_ps(-0.f))}; }  // exact unary minus
+    static V max(V a, V b) { return {_mm256_max_ps(a.v, b.v)}; }  // a > b ? a : b
+    static V min(V a, V b) { return {_mm256_min_ps(a.v, b.v)}; }  // a < b ? a : b
+    static V gt(V a, V b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)}; }
+    static V lt(V a, V b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+    static V select(V m, V a, V b) { return {_mm256_blendv_ps(b.v, a.v, m.v)}; } // m ? a : b
+    static unsigned bits(V m) { return static_cast<unsigned>(_mm256_movemask_ps(m.v)); }
+};
+#elif defined(BATCH_SSE2)
+struct V {
+    __m128 v;
+    static constexpr std::size_t W = 4;
+    static V load(const float* p) { return {_mm_loadu_ps(p)}; }
+    static V set1(float x) { return {_mm_set1_ps(x)}; }
+    static V mask(const std::uint32_t* p) { return {_mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))}; }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    friend V operator+(V a, V b) { return {_mm_add_ps(a.v, b.v)}; }
+    friend V operator-(V a, V b) { return {_mm_sub_ps(a.v, b.v)}; }
+    friend V operator*(V a, V b) { return {_mm_mul_ps(a.v, b.v)}; }
+    friend V operator/(V a, V b) { return {_mm_div_ps(a.v, b.v)}; }
+    static V neg(V a) { return {_mm_xor_ps(a.v, _mm_set1_ps(-0.f))}; }
+    static V max(V a, V b) { return {_mm_max_ps(a.v, b.v)}; }
+    static V min(V a, V b) { return {_mm_min_ps(a.v, b.v)}; }
+    static V gt(V a, V b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+    static V lt(V a, V b) { return {_mm_cmplt_ps(a.v, b.v)}; }
+    static V select(V m, V a, V b) { return {_mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v))}; }
+    static unsigned bits(V m) { return static_cast<unsigned>(_mm_movemask_ps(m.v)); }
+};
+#endif
+
+#if defined(BATCH_AVX2) || defined(BATCH_SSE2)
+// std::clamp(x, lo, hi) == (x < lo) ? lo : (hi < x) ? hi : x
+inline V clampV(V x, V lo, V hi) { return V::min(hi, V::max(lo, x)); }
+
+// lagAlpha (Integrator.hpp), same operations in the same order. RK4 here is
+// the single-step case; hxLag sends lanes past kRk4MaxR down the scalar path.
+inline V lagAlphaV(Integrator m, V r) {
+    const V one = V::set1(1.0f);
+    switch (m) {
+    case Integrator::RK4:
+        return r * (one - r * (V::set1(0.5f) - r * (V::set1(1.0f / 6.0f) - r * V::set1(1.0f / 24.0f))));
+    case Integrator::SemiImplicit:
+        return r / (one + r);
+    case Integrator::Euler:
+        break;
+    }
+    return clampV(r, V::set1(0.0f), one);
+}
+#endif
+
+} // namespace
+
+namespace BatchKernels {
+
+const char* isa() {
+#if defined(BATCH_AVX2)
+    return "avx2";
+#elif defined(BATCH_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+void pidUpdate(std::size_t n, const float* kp, const float* ki, const float* sp, const float* pv,
+               float* integ, float* out, float dt) {
+    std::size_t i = 0;
+#if defined(BATCH_AVX2) || defined(BATCH_SSE2)
+    const V vdt = V::set1(dt), zero = V::set1(0.f), one = V::set1(1.f);
+    for (; i + V::W <= n; i += V::W) {
+        const V err = V::load(sp + i) - V::load(pv + i);
+        const V in  = V::load(integ + i) + err * vdt;
+        in.store(integ + i);
+        clampV(V::load(kp + i) * err + V::load(ki + i) * in, zero, one).store(out + i);
+    }
+#endif
+    for (; i < n; ++i)
+        pidOne(kp[i], ki[i], sp[i], pv[i], integ[i], out[i], dt);
+}
+
+void valveTravel(std::size_t n, const float* target, const float* speed, float* pos, float dt) {
+    std::size_t i = 0;
+#if defined(BATCH_AVX2) || defined(BATCH_SSE2)
+    const V vdt = V::set1(dt);
+    for (; i + V::W <= n; i += V::W) {
+        const V s = V::load(speed + i);
+        const V p = V::load(pos + i);
+        (p + clampV(V::load(target + i) - p, V::neg(s) * vdt, s * vdt)).store(pos + i);
+    }
+#endif
+    for (; i < n; ++i)
+        valveOne(target[i], speed[i], pos[i], dt);
+}
+
+void hxLag(std::size_t n, const float* inlet, const float* pos, const float* tau, const float* flow,
+           const std::uint32_t* on, float* outlet, float dt, Integrator method) {
+    std::size_t i = 0;
+#if defined(BATCH_AVX2) || defined(BATCH_SSE2)
+    const V vdt = V::set1(dt), zero = V::set1(0.f), one = V::set1(1.f), tenth = V::set1(0.1f);
+    const V rk4_max = V::set1(kRk4MaxR);
+    for (; i + V::W <= n; i += V::W) {
+        // std::max(0.1f, x) == (0.1f < x) ? x : 0.1f == V::max(x, 0.1f)
+        const V tau_eff = V::max(V::load(tau + i) / V::max(V::load(flow + i), tenth), tenth);
+        const V r       = vdt / tau_eff;
+        if (method == Integrator::RK4 && V::bits(V::gt(r, rk4_max))) {
+            // Some lane needs RK4 substeps: rare (dt above a time constant)
+            for (std::size_t k = i; k < i + V::W; ++k)
+                if (on[k])
+                    hxOne(inlet[k], pos[k], tau[k], flow[k], outlet[k], dt, method);
+            continue;
+        }
+        const V target  = V::load(inlet + i) * clampV(V::load(pos + i), zero, one);
+        const V alpha   = lagAlphaV(method, r);
+        const V o       = V::load(outlet + i);
+        V::select(V::mask(on + i), o + alpha * (target - o), o).store(outlet + i);
+    }
+#endif
+    for (; i < n; ++i)
+        if (on[i])
+            hxOne(inlet[i], pos[i], tau[i], flow[i], outlet[i], dt, method);
+}
+
+void alarmCompare(std::size_t n, const float* level, const float* hiSP, const float* loSP,
+                  std::uint8_t* hi, std::uint8_t* lo) {
+    std::size_t i = 0;
+#if defined(BATCH_AVX2) || defined(BATCH_SSE2)
+    for (; i + V::W <= n; i += V::W) {
+        const V l = V::load(level + i);
+        const unsigned h = V::bits(V::gt(l, V::load(hiSP + i)));
+        const unsigned w = V::bits(V::lt(l, V::load(loSP + i)));
+        for (std::size_t k = 0; k < V::W; ++k) {
+            hi[i + k] = (h >> k) & 1u;
+            lo[i + k] = (w >> k) & 1u;
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        hi[i] = level[i] > hiSP[i];
+        lo[i] = level[i] < loSP[i];
+    }
+}
+
+float prorata(std::size_t n, const float* demand, float* granted, float frac) {
+    float acc[8] = {};  // acc[k] sums the indices i ≡ k (mod 8) of the whole blocks
+    std::size_t i = 0;
+#if defined(BATCH_AVX2) || defined(BATCH_SSE2)
+    constexpr std::size_t P = 8 / V::W;
+    const V f = V::set1(frac), zero = V::set1(0.f);
+    V part[P];
+    for (auto& p : part)
+        p = zero;
+    for (; i + 8 <= n; i += 8)
+        for (std::size_t k = 0; k < P; ++k) {
+            // std::max(0.f, d) == (0.f < d) ? d : 0.f == V::max(d, 0)
+            const V d = V::max(V::load(demand + i + k * V::W), zero);
+            part[k] = part[k] + d;
+            (d * f).store(granted + i + k * V::W);
+        }
+    for (std::size_t k = 0; k < P; ++k)
+        part[k].store(acc + k * V::W);
+#endif
+    for (; i + 8 <= n; i += 8)
+        for (std::size_t k = 0; k < 8; ++k) {
+            const float d = std::max(0.f, demand[i + k]);
+            acc[k] += d;
+            granted[i + k] = d * frac;
+        }
+    float sum = ((acc[0] + acc[4]) + (acc[2] + acc[6])) + ((acc[1] + acc[5]) + (acc[3] + acc[7]));
+    for (; i < n; ++i) {
+        const float d = std::max(0.f, demand[i]);
+        sum += d;
+        granted[i] = d * frac;
+    }
+    return sum;
+}
+
+} // namespace BatchKernels
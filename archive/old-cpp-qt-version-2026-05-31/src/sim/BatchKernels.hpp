@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Integrator.hpp"
+
+// SIMD kernels over SoA lanes for the batched system path (BatchSystems.cpp).
+// Built for AVX2 or SSE2 when the compiler targets them, otherwise scalar.
+// Every kernel mirrors the operation order of its scalar system in
+// Systems.cpp so results are bit-identical (simcore builds with
+// -ffp-contract=off to keep FMA contraction from breaking that).
+namespace BatchKernels {
+
+const char* isa(); // "avx2", "sse2" or "scalar"
+
+// ControlSystem: integ += err*dt; out = clamp(kp*err + ki*integ, 0, 1)
+void pidUpdate(std::size_t n, const float* kp, const float* ki, const float* sp, const float* pv,
+               float* integ, float* out, float dt);
+
+// ActuatorSystem: pos += clamp(target - pos, -speed*dt, speed*dt)
+void valveTravel(std::size_t n, const float* target, const float* speed, float* pos, float dt);
+
+// HeatExchangerSystem: first-order lag of outlet toward inlet*clamp(pos,0,1),
+// closing lagAlpha(method, dt/tau_eff) of the gap.
+// `on` is a lane mask (0 or ~0u); masked-off lanes are left untouched.
+void hxLag(std::size_t n, const float* inlet, const float* pos, const float* tau, const float* flow,
+           const std::uint32_t* on, float* outlet, float dt, Integrator method = Integrator::Euler);
+
+// AlarmSystem: hi/lo from level vs setpoints (latching is the caller's)
+void alarmCompare(std::size_t n, const float* level, const float* hiSP, const float* loSP,
+                  std::uint8_t* hi, std::uint8_t* lo);
+
+// Steam pro-rata in one pass: granted = max(demand, 0) * frac, returning
+// the sum of max(demand, 0). The sum is kept in eight interleaved partials
+// folded in a fixed order, so every ISA returns the same bits.
+float prorata(std::size_t n, const float* demand, float* granted, float frac);
+
+// CSR offsets for items already sorted by group: group g owns
+// [ptr[g], ptr[g + 1]). Network compile steps lay their lanes out with it.
+inline std::vector<std::uint32_t> csrOffsets(const std::vector<std::uint32_t>& sorted_groups, std::size_t groups) {
+    std::vector<std::uint32_t> ptr(groups + 1, 0);
+    for (auto g : sorted_groups)
+        ++ptr[g + 1];
+    for (std::size_t g = 0; g < groups; ++g)
+        ptr[g + 1] += ptr[g];
+    return ptr;
+}
+
+} // namespace BatchKernels
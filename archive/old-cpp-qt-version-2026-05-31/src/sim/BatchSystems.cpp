@@ -0,0 +1,152 @@
+#include "BatchSystems.hpp"
+#include "AlarmEngine.hpp"
+#include "BatchKernels.hpp"
+#include "Components.hpp"
+
+namespace {
+template<typename... V>
+void reserveAll(std::size_t n, V&... lanes) {
+    (lanes.reserve(n), ...);
+}
+
+// Within the reserved capacity, so this never allocates on a steady plant
+template<typename... V>
+void resizeAll(std::size_t n, V&... lanes) {
+    (lanes.resize(n), ...);
+}
+}
+
+void reserveLanes(entt::registry& r, BatchState& s) {
+    auto& c = s.control;
+    reserveAll(r.storage<PID>().size(), c.kp, c.ki, c.sp, c.pv, c.integ, c.out);
+    auto& a = s.actuator;
+    reserveAll(r.storage<ValveActuator>().size(), a.target, a.speed, a.pos);
+    auto& h = s.hx;
+    reserveAll(r.storage<HeatExchanger>().size(), h.inlet, h.pos, h.tau, h.flow, h.outlet, h.on);
+    auto& l = s.alarm;
+    reserveAll(r.storage<Alarmable>().size(), l.level, l.hiSP, l.loSP, l.hi, l.lo);
+}
+
+void ControlSystemBatched(entt::registry& r, BatchState& s, float dt) {
+    auto view = r.view<PID>();
+    auto& L = s.control;
+
+    const std::size_t n = r.storage<PID>().size();
+    resizeAll(n, L.kp, L.ki, L.sp, L.pv, L.integ, L.out);
+    std::size_t i = 0;
+    for (auto e : view) {
+        const auto& pid = view.get<PID>(e);
+        L.kp[i]    = pid.kp;
+        L.ki[i]    = pid.ki;
+        L.sp[i]    = pid.sp;
+        L.pv[i]    = pid.pv;
+        L.integ[i] = pid.integ;
+        ++i;
+    }
+
+    BatchKernels::pidUpdate(n, L.kp.data(), L.ki.data(), L.sp.data(), L.pv.data(),
+                            L.integ.data(), L.out.data(), dt);
+
+    i = 0;
+    for (auto e : view) {
+        auto& pid = view.get<PID>(e);
+        pid.integ = L.integ[i];
+        pid.out   = L.out[i];
+        ++i;
+    }
+}
+
+void ActuatorSystemBatched(entt::registry& r, BatchState& s, float dt) {
+    auto view = r.view<ValveActuator, PID>();
+    auto& L = s.actuator;
+
+    resizeAll(view.size_hint(), L.target, L.speed, L.pos);
+    std::size_t n = 0;
+    for (auto e : view) {
+        const auto& v = view.get<ValveActuator>(e);
+        L.target[n] = view.get<PID>(e).out;
+        L.speed[n]  = v.speed;
+        L.pos[n]    = v.pos;
+        ++n;
+    }
+
+    BatchKernels::valveTravel(n, L.target.data(), L.speed.data(), L.pos.data(), dt);
+
+    std::size_t i = 0;
+    for (auto e : view)
+        view.get<ValveActuator>(e).pos = L.pos[i++];
+}
+
+void HeatExchangerSystemBatched(entt::registry& r, BatchState& s, float dt) {
+    const auto* cfg = r.ctx().find<IntegrationConfig>();
+    const Integrator method = cfg ? cfg->thermal : Integrator::Euler;
+    auto v = r.view<HeatExchanger, ValveActuator>();
+    auto& L = s.hx;
+
+    resizeAll(v.size_hint(), L.inlet, L.pos, L.tau, L.flow, L.outlet, L.on);
+    std::size_t n = 0;
+    for (auto e : v) {
+        const auto& hx = v.get<HeatExchanger>(e);
+        L.inlet[n]  = hx.comp_inlet_stream;
+        L.pos[n]    = v.get<ValveActuator>(e).pos;
+        L.tau[n]    = hx.tau_s;
+        L.flow[n]   = hx.flow_rate;
+        L.outlet[n] = hx.comp_outlet_stream;
+        L.on[n]     = hx.power_on ? ~0u : 0u;
+        ++n;
+    }
+
+    BatchKernels::hxLag(n, L.inlet.data(), L.pos.data(), L.tau.data(), L.flow.data(),
+                        L.on.data(), L.outlet.data(), dt, method);
+
+    std::size_t i = 0;
+    for (auto e : v)
+        v.get<HeatExchanger>(e).comp_outlet_stream = L.outlet[i++];
+}
+
+void AlarmSystemBatched(entt::registry& r, BatchState& s) {
+    auto& L = s.alarm;
+
+    // Compiled points: gather through the cached source pointers, compare in
+    // lanes, then hand the engine only the points whose flags move
+    if (auto* alarms = r.ctx().find<AlarmEngine>()) {
+        alarms->events.clear();
+        const std::size_t n = alarms->size();
+        resizeAll(n, L.level, L.hiSP, L.loSP, L.hi, L.lo);
+        for (std::size_t p = 0; p < n; ++p) {
+            const auto& alarm = *alarms->alarm[p];
+            L.level[p] = *alarms->source[p];
+            L.hiSP[p]  = AlarmEngine::hiLimit(alarm);
+            L.loSP[p]  = AlarmEngine::loLimit(alarm);
+        }
+
+        BatchKernels::alarmCompare(n, L.level.data(), L.hiSP.data(), L.loSP.data(), L.hi.data(), L.lo.data());
+
+        for (std::uint32_t p = 0; p < n; ++p)
+            if (!alarms->settled(p, L.hi[p], L.lo[p]))
+                alarms->update(p, L.level[p], L.hi[p], L.lo[p]);
+        return;
+    }
+
+    auto v = r.view<Tank, Alarmable>();
+    resizeAll(v.size_hint(), L.level, L.hiSP, L.loSP, L.hi, L.lo);
+    std::size_t n = 0;
+    for (auto e : v) {
+        const auto& alarm = v.get<Alarmable>(e);
+        L.level[n] = v.get<Tank>(e).level;
+        L.hiSP[n]  = AlarmEngine::hiLimit(alarm);
+        L.loSP[n]  = AlarmEngine::loLimit(alarm);
+        ++n;
+    }
+
+    BatchKernels::alarmCompare(n, L.level.data(), L.hiSP.data(), L.loSP.data(), L.hi.data(), L.lo.data());
+
+    std::size_t i = 0;
+    for (auto e : v) {
+        auto& alarm = v.get<Alarmable>(e);
+        alarm.hi      = L.hi[i];
+        alarm.lo      = L.lo[i];
+        alarm.latched = alarm.latched || alarm.hi || alarm.lo;
+        ++i;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <entt/entt.hpp>
+
+// Batched execution mode for the per-entity systems. Each tick the hot
+// fields are gathered from the components into contiguous SoA lanes, run
+// through the SIMD kernels in BatchKernels, and scattered back. The lanes
+// are scratch, not storage: the components stay authoritative, so
+// checkpoints, the UI and the scalar systems never see a stale copy. Only
+// their capacity persists, so a steady plant does no allocation here.
+// Results match the scalar systems bit for bit.
+
+struct ControlLanes {
+  std::vector<float> kp, ki, sp, pv, integ, out;
+};
+
+struct ActuatorLanes {
+  std::vector<float> target, speed, pos;
+};
+
+struct HeatExchangerLanes {
+  std::vector<float> inlet, pos, tau, flow, outlet;
+  std::vector<std::uint32_t> on;  // lane mask: ~0u when power_on
+};
+
+struct AlarmLanes {
+  std::vector<float> level, hiSP, loSP;
+  std::vector<std::uint8_t> hi, lo;
+};
+
+struct BatchState {
+  ControlLanes control;
+  ActuatorLanes actuator;
+  HeatExchangerLanes hx;
+  AlarmLanes alarm;
+};
+
+// Sizes every lane for the loaded plant so even the first batched tick
+// doesn't allocate.
+void reserveLanes(entt::registry& r, BatchState& s);
+
+void ControlSystemBatched(entt::registry& r, BatchState& s, float dt);
+void ActuatorSystemBatched(entt::registry& r, BatchState& s, float dt);
+void HeatExchangerSystemBatched(entt::registry& r, BatchState& s, float dt);
+void AlarmSystemBatched(entt::registry& r, BatchState& s);
@@ -0,0 +1,237 @@
+#include "Checkpoint.hpp"
+#include "ComponentReflect.hpp"
+#include "FlowNetwork.hpp"
+#include "SiteContext.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const CheckpointColumn* findColumn(const Checkpoint* cp, int component) {
+    if (!cp)
+        return nullptr;
+    for (const auto& c : cp->columns)
+        if (c.component == component)
+            return &c;
+    return nullptr;
+}
+
+} // namespace
+
+void CheckpointStore::capture(entt::registry& r, std::uint64_t step, double sim_time, float dt,
+                              const Historian* historian) {
+    if (has(step))
+        return;
+
+    // Share against the checkpoint just before this one
+    auto pos = std::upper_bound(list_.begin(), list_.end(), step,
+                                [](std::uint64_t s, const Checkpoint& c) { return s < c.step; });
+    const Checkpoint* prev = pos == list_.begin() ? nullptr : &*(pos - 1);
+
+    Checkpoint cp;
+    cp.step = step;
+    cp.sim_time = sim_time;
+    cp.dt = dt;
+
+    std::vector<entt::entity> rows;
+    std::vector<char> bytes;
+    for (const auto& info : componentTable()) {
+        rows.clear();
+        bytes.clear();
+        info.dump(r, rows, bytes);
+        if (rows.empty())
+            continue;
+
+        CheckpointColumn col;
+        col.component = info.index;
+        const CheckpointColumn* old = findColumn(prev, info.index);
+
+        if (old && *old->rows == rows)
+            col.rows = old->rows;
+        else
+            col.rows = std::make_shared<const std::vector<entt::entity>>(rows);
+
+        const std::size_t chunk = cfg_.chunk_bytes;
+        for (std::size_t at = 0, i = 0; at < bytes.size(); at += chunk, ++i) {
+            const std::size_t n = std::min(chunk, bytes.size() - at);
+            if (old && i < old->chunks.size() && old->chunks[i]->size() == n &&
+                std::memcmp(old->chunks[i]->data(), bytes.data() + at, n) == 0) {
+                col.chunks.push_back(old->chunks[i]);
+            } else {
+                col.chunks.push_back(std::make_shared<const std::vector<char>>(bytes.begin() + at, bytes.begin() + at + n));
+            }
+        }
+        cp.columns.push_back(std::move(col));
+    }
+
+    if (auto* net = r.ctx().find<FlowNetwork>())
+        cp.heads = net->head;
+    if (auto* kpis = r.ctx().find<KpiEngine>())
+        cp.kpis = *kpis;
+    if (auto* sites = r.ctx().find<SiteContext>())
+        for (std::size_t i = 1; i < sites->size(); ++i)
+            cp.site_kpis.push_back(sites->sites[i].kpis);
+    if (auto* alarms = r.ctx().find<AlarmEngine>())
+        cp.alarms = alarms->state();
+    if (auto* metrics = r.ctx().find<AlarmMetrics>())
+        cp.alarm_metrics = metrics->compact();
+    if (historian)
+        cp.historian = historian->mark(step, sim_time, dt);
+
+    retain(cp);
+    list_.insert(pos, std::move(cp));
+    enforceBudget();
+}
+
+bool CheckpointStore::has(std::uint64_t step) const {
+    auto it = std::lower_bound(list_.begin(), list_.end(), step,
+                               [](const Checkpoint& c, std::uint64_t s) { return c.step < s; });
+    return it != list_.end() && it->step == step;
+}
+
+const Checkpoint* CheckpointStore::latestAtOrBefore(std::uint64_t step) const {
+    auto it = std::upper_bound(list_.begin(), list_.end(), step,
+                               [](std::uint64_t s, const Checkpoint& c) { return s < c.step; });
+    return it == list_.begin() ? nullptr : &*(it - 1);
+}
+
+bool CheckpointStore::restore(const Checkpoint& cp, entt::registry& r) const {
+    bool in_place = true;
+    std::vector<char> bytes;
+    for (const auto& info : componentTable()) {
+        const CheckpointColumn* col = findColumn(&cp, info.index);
+        if (!col) {
+            in_place &= info.assign(r, nullptr, 0, nullptr);
+            continue;
+        }
+        bytes.clear();
+        for (const auto& c : col->chunks)
+            bytes.insert(bytes.end(), c->begin(), c->end());
+        in_place &= info.assign(r, col->rows->data(), col->rows->size(), bytes.data());
+    }
+    return in_place;
+}
+
+void CheckpointStore::restoreContext(const Checkpoint& cp, entt::registry& r) const {
+    if (auto* net = r.ctx().find<FlowNetwork>(); net && net->head.size() == cp.heads.size())
+        net->head = cp.heads;
+    if (cp.kpis)
+        r.ctx().insert_or_assign(*cp.kpis);
+    if (auto* sites = r.ctx().find<SiteContext>(); sites && sites->size() == cp.site_kpis.size() + 1)
+        for (std::size_t i = 1; i < sites->size(); ++i)
+            sites->sites[i].kpis = cp.site_kpis[i - 1];
+    if (auto* alarms = r.ctx().find<AlarmEngine>(); alarms && cp.alarms)
+        alarms->restore(*cp.alarms);
+    if (cp.alarm_metrics) {
+        if (auto* metrics = r.ctx().find<AlarmMetrics>())
+            metrics->restore(*cp.alarm_metrics);
+        else
+            r.ctx().insert_or_assign(*cp.alarm_metrics);
+    }
+}
+
+void CheckpointStore::dropAfter(std::uint64_t step) {
+    while (!list_.empty() && list_.back().step > step) {
+        release(list_.back());
+        list_.pop_back();
+    }
+}
+
+// Context state is owned by its checkpoint; rows and chunks may be shared
+// with other checkpoints, so they are counted while anyone still holds them
+std::size_t CheckpointStore::ownBytes(const Checkpoint& cp) {
+    std::size_t total = cp.heads.size() * sizeof(float);
+    if (cp.kpis)
+        total += cp.kpis->bytes();
+    for (const auto& k : cp.site_kpis)
+        total += k.bytes();
+    if (cp.alarms)
+        total += cp.alarms->bytes();
+    if (cp.alarm_metrics)
+        total += cp.alarm_metrics->bytes();
+    if (cp.historian)
+        total += cp.historian->bytes();
+    return total;
+}
+
+void CheckpointStore::retain(const Checkpoint& cp) {
+    bytes_ += ownBytes(cp);
+    for (const auto& col : cp.columns) {
+        if (refs_[col.rows.get()]++ == 0)
+            bytes_ += col.rows->size() * sizeof(entt::entity);
+        for (const auto& c : col.chunks)
+            if (refs_[c.get()]++ == 0)
+                bytes_ += c->size();
+    }
+}
+
+void CheckpointStore::release(const Checkpoint& cp) {
+    bytes_ -= ownBytes(cp);
+    auto drop = [&](const void* p, std::size_t n) {
+        auto it = refs_.find(p);
+        if (--it->second == 0) {
+            refs_.erase(it);
+            bytes_ -= n;
+        }
+    };
+    for (const auto& col : cp.columns) {
+        drop(col.rows.get(), col.rows->size() * sizeof(entt::entity));
+        for (const auto& c : col.chunks)
+            drop(c.get(), c->size());
+    }
+}
+
+void CheckpointStore::enforceBudget() {
+    if (bytes_ <= cfg_.budget_bytes)
+        return;
+
+    while (bytes_ > cfg_.budget_bytes && list_.size() > 2) {
+        // Drop the interior checkpoint whose removal leaves the smallest gap
+        // relative to its age, so old history thins out first
+        const std::uint64_t newest = list_.back().step;
+        std::size_t victim = 1;
+        double best = -1.0;
+        for (std::size_t i = 1; i + 1 < list_.size(); ++i) {
+            const double gap = static_cast<double>(list_[i + 1].step - list_[i - 1].step);
+            const double age = static_cast<double>(newest - list_[i].step) + static_cast<double>(cfg_.interval_steps);
+            const double score = gap / age;
+            if (best < 0.0 || score < best) {
+                best = score;
+                victim = i;
+            }
+        }
+        release(list_[victim]);
+        list_.erase(list_.begin() + static_cast<std::ptrdiff_t>(victim));
+    }
+
+    // Two left and still over: history starts later
+    while (bytes_ > cfg_.budget_bytes && list_.size() > 1) {
+        release(list_.front());
+        list_.pop_front();
+    }
+}
+
+void CommandJournal::append(const Command& c) {
+    list_.push_back(c);
+}
+
+void CommandJournal::dropFrom(std::uint64_t step) {
+    auto it = std::lower_bound(list_.begin(), list_.end(), step,
+                               [](const Command& c, std::uint64_t s) { return c.step < s; });
+    list_.erase(it, list_.end());
+}
+
+void CommandJournal::dropBefore(std::uint64_t step) {
+    auto it = std::lower_bound(list_.begin(), list_.end(), step,
+                               [](const Command& c, std::uint64_t s) { return c.step < s; });
+    list_.erase(list_.begin(), it);
+}
+
+std::pair<const Command*, const Command*> CommandJournal::at(std::uint64_t step) const {
+    auto lo = std::lower_bound(list_.begin(), list_.end(), step,
+                               [](const Command& c, std::uint64_t s) { return c.step < s; });
+    auto hi = std::upper_bound(lo, list_.end(), step,
+                               [](std::uint64_t s, const Command& c) { return s < c.step; });
+    const Command* base = list_.data();
+    return {base + (lo - list_.begin()), base + (hi - list_.begin())};
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <entt/entt.hpp>
+#include "AlarmEngine.hpp"
+#include "AlarmMetrics.hpp"
+#include "Commands.hpp"
+#include "Historian.hpp"
+#include "KpiEngine.hpp"
+
+struct RecordingConfig {
+    std::uint64_t interval_steps{500};     // 10 s at 50 Hz
+    std::size_t   budget_bytes{64u << 20}; // checkpoint memory, shared chunks counted once
+    std::size_t   chunk_bytes{4096};
+};
+
+// Component bytes are split into fixed-size chunks; a chunk equal to the one
+// at the same position in the previous checkpoint is shared, not copied, so
+// static data (pipes, configs) costs nothing after the first checkpoint.
+using CheckpointChunk = std::shared_ptr<const std::vector<char>>;
+
+struct CheckpointColumn {
+    int component{-1};  // index in componentTable()
+    std::shared_ptr<const std::vector<entt::entity>> rows;  // packed order
+    std::vector<CheckpointChunk> chunks;
+};
+
+struct Checkpoint {
+    std::uint64_t step{0};    // state at the start of this tick, before its commands
+    double        sim_time{0.0};
+    float         dt{0.0f};
+    std::vector<CheckpointColumn> columns;
+    std::vector<float> heads; // FlowNetwork warm start, part of the state for bit-exact replay
+    std::optional<KpiEngine> kpis;  // estimator state, so KPIs after a seek match a straight run
+    std::vector<KpiEngine> site_kpis;  // the same for SiteContext sites after the primary
+    std::optional<AlarmTimerState> alarms;  // responses in flight and their deadlines
+    std::optional<AlarmMetrics> alarm_metrics;
+    std::optional<HistorianMark> historian;  // open rollup buckets, applied by SimRunner::seek
+};
+
+// Sorted by step. Over budget, interior checkpoints are thinned so that recent
+// history stays dense and old history gets sparser; replay from a sparse
+// region just runs more ticks.
+class CheckpointStore {
+public:
+    explicit CheckpointStore(const RecordingConfig& cfg = {}) : cfg_(cfg) {}
+
+    void capture(entt::registry& r, std::uint64_t step, double sim_time, float dt,
+                 const Historian* historian = nullptr);
+    bool has(std::uint64_t step) const;
+    const Checkpoint* latestAtOrBefore(std::uint64_t step) const;
+
+    // Returns false if storages were rebuilt (entities changed), in which
+    // case cached pointers such as FlowNetwork's must be recompiled before
+    // restoreContext().
+    bool restore(const Checkpoint& cp, entt::registry& r) const;
+    // State held in the registry context: network heads, KPI estimators, alarm timers and metrics
+    void restoreContext(const Checkpoint& cp, entt::registry& r) const;
+
+    void dropAfter(std::uint64_t step);
+    std::uint64_t oldestStep() const { return list_.empty() ? 0 : list_.front().step; }
+
+    std::size_t size() const { return list_.size(); }
+    std::size_t bytes() const { return bytes_; }
+    const RecordingConfig& config() const { return cfg_; }
+
+private:
+    static std::size_t ownBytes(const Checkpoint& cp);
+    // bytes_ counts each shared row list and chunk once, while refs_ says
+    // how many checkpoints hold it, so evicting one costs only its own size
+    void retain(const Checkpoint& cp);
+    void release(const Checkpoint& cp);
+    void enforceBudget();
+
+    RecordingConfig cfg_;
+    std::deque<Checkpoint> list_;
+    std::unordered_map<const void*, std::uint32_t> refs_;
+    std::size_t bytes_{0};
+};
+
+// Commands in the order they were applied, keyed by step.
+class CommandJournal {
+public:
+    void append(const Command& c);  // c.step must be >= the last entry's
+    void dropFrom(std::uint64_t step);    // forget step and later (new branch)
+    void dropBefore(std::uint64_t step);  // history older than any checkpoint
+
+    // Entries for one step: [first, last)
+    std::pair<const Command*, const Command*> at(std::uint64_t step) const;
+
+    std::size_t size() const { return list_.size(); }
+    const std::vector<Command>& entries() const { return list_; }
+
+private:
+    std::vector<Command> list_;
+};
+
+struct Recording {
+    explicit Recording(const RecordingConfig& cfg) : checkpoints(cfg) {}
+
+    CheckpointStore checkpoints;
+    CommandJournal  journal;
+};
@@ -0,0 +1,43 @@
+#include "Commands.hpp"
+#include "AlarmEngine.hpp"
+#include "Components.hpp"
+
+bool applyCommand(entt::registry& r, const Command& c) {
+    if (!r.valid(c.target))
+        return false;
+
+    switch (c.kind) {
+    case CommandKind::PumpStart:
+    case CommandKind::PumpStop:
+        if (auto* p = r.try_get<Pump>(c.target)) {
+            p->running = c.kind == CommandKind::PumpStart;
+            return true;
+        }
+        return false;
+
+    case CommandKind::SetSetpoint:
+        if (auto* pid = r.try_get<PID>(c.target)) {
+            pid->sp = c.value;
+            return true;
+        }
+        return false;
+
+    case CommandKind::AckAlarm:
+        if (auto* ar = r.try_get<AlarmResponse>(c.target)) {
+            if (ar->active && !ar->acknowledged) {
+                // ResponseSystem moves to repair this tick: the ack deadline
+                // becomes now, or the per-tick countdown hits zero
+                if (auto* alarms = r.ctx().find<AlarmEngine>()) {
+                    auto it = alarms->point_of.find(c.target);
+                    if (it != alarms->point_of.end() && alarms->slot[it->second] >= 0)
+                        alarms->reschedule(it->second, alarms->now);
+                } else {
+                    ar->ack_timer_s = 0.0f;
+                }
+            }
+            return true;
+        }
+        return false;
+    }
+    return false;
+}
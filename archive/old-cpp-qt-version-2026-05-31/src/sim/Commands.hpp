@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include <entt/entt.hpp>
+
+// Operator inputs. Everything that changes the sim from outside goes through
+// SimRunner::submit so it can be journaled and replayed (see Checkpoint.hpp).
+enum class CommandKind : std::uint8_t {
+    PumpStart,
+    PumpStop,
+    SetSetpoint,  // PID::sp = value
+    AckAlarm,     // skip the remaining ack delay, start repair
+};
+
+struct Command {
+    std::uint64_t step{0};  // tick it applies on; set by SimRunner
+    CommandKind   kind{CommandKind::PumpStart};
+    entt::entity  target{entt::null};
+    float         value{0.0f};
+};
+
+// Returns false if the target doesn't have the component the command needs.
+bool applyCommand(entt::registry& r, const Command& c);
@@ -0,0 +1,157 @@
+#include "ComponentReflect.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+template<typename M>
+constexpr FieldKind kindOf() {
+    if constexpr (std::is_same_v<M, bool>)     return FieldKind::Bool;
+    else if constexpr (std::is_same_v<M, int>) return FieldKind::Int;
+    else {
+        static_assert(std::is_same_v<M, float>, "reflected fields are float, int or bool");
+        return FieldKind::Float;
+    }
+}
+
+template<typename T>
+constexpr std::size_t fieldBytes() {
+    return std::apply([](auto... f) { return (std::size_t{0} + ... + sizeof(std::declval<T&>().*(f.ptr))); },
+                      Reflect<T>::fields);
+}
+
+// Copies a component so padding bytes come out zero: dumps of equal state are
+// then byte-identical, which checkpoint diffs and image comparisons rely on.
+template<typename T>
+void copyOut(char* dst, const T& src) {
+    if constexpr (fieldBytes<T>() == sizeof(T)) {
+        std::memcpy(dst, &src, sizeof(T));
+    } else {
+        T clean;
+        std::memset(static_cast<void*>(&clean), 0, sizeof(T));
+        std::apply([&](auto... f) { ((clean.*(f.ptr) = src.*(f.ptr)), ...); }, Reflect<T>::fields);
+        std::memcpy(dst, &clean, sizeof(T));
+    }
+}
+
+template<typename T>
+ComponentInfo makeInfo() {
+    static_assert(std::is_standard_layout_v<T> && std::is_trivially_copyable_v<T>,
+                  "components must stay plain data");
+    ComponentInfo info;
+    info.name  = Reflect<T>::name;
+    info.index = componentIndex<T>();
+    info.size  = sizeof(T);
+
+    const T probe{};
+    std::apply([&](auto... f) {
+        (info.fields.push_back({f.name, kindOf<std::remove_cv_t<std::remove_reference_t<decltype(probe.*(f.ptr))>>>(),
+                                static_cast<std::uint32_t>(reinterpret_cast<const char*>(&(probe.*(f.ptr))) -
+                                                           reinterpret_cast<const char*>(&probe))}), ...);
+    }, Reflect<T>::fields);
+
+    info.emplace = [](entt::registry& r, entt::entity e) -> void* { return &r.emplace_or_replace<T>(e); };
+    info.get     = [](entt::registry& r, entt::entity e) -> void* { return r.try_get<T>(e); };
+    info.remove  = [](entt::registry& r, entt::entity e) { r.remove<T>(e); };
+    info.rows    = [](entt::registry& r, const entt::entity*& first) -> std::size_t {
+        auto& s = r.storage<T>();
+        first = s.data();
+        return s.size();
+    };
+    info.dump    = [](entt::registry& r, std::vector<entt::entity>& ents, std::vector<char>& bytes) {
+        auto& s = r.storage<T>();
+        const entt::entity* packed = s.data();
+        const std::size_t n = s.size();
+        ents.insert(ents.end(), packed, packed + n);
+        const std::size_t at = bytes.size();
+        bytes.resize(at + n * sizeof(T));
+        for (std::size_t i = 0; i < n; ++i)
+            copyOut(bytes.data() + at + i * sizeof(T), s.get(packed[i]));
+    };
+    info.insert  = [](entt::registry& r, const entt::entity* ents, std::size_t n, const void* values) {
+        // values usually point straight into a mapped image (8-byte aligned);
+        // fall back to a copy for anything less aligned.
+        if (reinterpret_cast<std::uintptr_t>(values) % alignof(T) == 0) {
+            const T* v = static_cast<const T*>(values);
+            r.insert<T>(ents, ents + n, v);
+        } else {
+            std::vector<T> tmp(n);
+            std::memcpy(tmp.data(), values, n * sizeof(T));
+            r.insert<T>(ents, ents + n, tmp.data());
+        }
+    };
+    info.assign  = [](entt::registry& r, const entt::entity* ents, std::size_t n, const void* values) {
+        auto& s = r.storage<T>();
+        const char* src = static_cast<const char*>(values);
+        if (s.size() == n && std::equal(ents, ents + n, s.data())) {
+            for (std::size_t i = 0; i < n; ++i)
+                std::memcpy(static_cast<void*>(&s.get(ents[i])), src + i * sizeof(T), sizeof(T));
+            return true;
+        }
+        r.clear<T>();
+        std::vector<T> tmp(n);
+        if (n)
+            std::memcpy(static_cast<void*>(tmp.data()), src, n * sizeof(T));
+        r.insert<T>(ents, ents + n, tmp.data());
+        return false;
+    };
+    return info;
+}
+
+template<typename... T>
+std::vector<ComponentInfo> makeTable(ComponentTypes<T...>) {
+    return {makeInfo<T>()...};
+}
+
+} // namespace
+
+const FieldInfo* ComponentInfo::field(std::string_view n) const {
+    for (const auto& f : fields)
+        if (n == f.name)
+            return &f;
+    return nullptr;
+}
+
+const std::vector<ComponentInfo>& componentTable() {
+    static const std::vector<ComponentInfo> table = makeTable(AllComponents{});
+    return table;
+}
+
+const ComponentInfo* findComponent(std::string_view name) {
+    for (const auto& info : componentTable())
+        if (name == info.name)
+            return &info;
+    return nullptr;
+}
+
+bool findFieldRef(std::string_view ref, int& component, int& field) {
+    const auto dot = ref.find('.');
+    if (dot == std::string_view::npos)
+        return false;
+    const ComponentInfo* info = findComponent(ref.substr(0, dot));
+    const FieldInfo* f = info ? info->field(ref.substr(dot + 1)) : nullptr;
+    if (!f)
+        return false;
+    component = info->index;
+    field = static_cast<int>(f - info->fields.data());
+    return true;
+}
+
+double readField(const void* component, const FieldInfo& f) {
+    const char* p = static_cast<const char*>(component) + f.offset;
+    switch (f.kind) {
+    case FieldKind::Bool:  { bool b;  std::memcpy(&b, p, sizeof b); return b ? 1.0 : 0.0; }
+    case FieldKind::Int:   { int i;   std::memcpy(&i, p, sizeof i); return i; }
+    default:               { float x; std::memcpy(&x, p, sizeof x); return x; }
+    }
+}
+
+void writeField(void* component, const FieldInfo& f, double value) {
+    char* p = static_cast<char*>(component) + f.offset;
+    switch (f.kind) {
+    case FieldKind::Bool:  { const bool b = value != 0.0;           std::memcpy(p, &b, sizeof b); break; }
+    case FieldKind::Int:   { const int i = static_cast<int>(value); std::memcpy(p, &i, sizeof i); break; }
+    default:               { const float x = static_cast<float>(value); std::memcpy(p, &x, sizeof x); break; }
+    }
+}
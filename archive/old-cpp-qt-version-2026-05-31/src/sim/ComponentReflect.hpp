@@ -0,0 +1,188 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <entt/entt.hpp>
+#include "Components.hpp"
+
+// Compile-time reflection over every struct in Components.hpp: a name and
+// the list of fields. Loader, the binary format and the historian drive
+// everything through this one table, so a new component only needs a
+// Reflect<> entry here (and a slot in AllComponents).
+
+template<typename... T> struct ComponentTypes {};
+
+// Fixed order: the index is the component's bit in Scheduler's ComponentSet
+// and its id in binary files, so only ever append.
+using AllComponents = ComponentTypes<
+    Pump, ValveActuator, Tank, Pipe, PID, Alarmable, HumanFactors, AlarmResponse,
+    SiteKPI, HeatExchanger, Boiler, RefrigerationCompressor, CoolingTower, AirSystem,
+    WaterTreatment, Wastewater, SteamHeader, ChilledWaterLoop, SteamLoad, CoolingLoad,
+    PressureReducingValve, Area>;
+
+template<typename C, typename M>
+struct Field {
+  const char* name;
+  M C::* ptr;
+};
+
+template<typename T> struct Reflect;
+
+#define REFLECT_FIELD(T, f) Field<T, decltype(T::f)>{#f, &T::f}
+#define REFLECT_COMPONENT(T, ...)                                      \
+  template<> struct Reflect<T> {                                      \
+    static constexpr const char* name = #T;                           \
+    static constexpr auto fields = std::make_tuple(__VA_ARGS__);      \
+  };
+
+REFLECT_COMPONENT(Pump,
+  REFLECT_FIELD(Pump, running), REFLECT_FIELD(Pump, dp_nominal), REFLECT_FIELD(Pump, flow))
+REFLECT_COMPONENT(ValveActuator,
+  REFLECT_FIELD(ValveActuator, cmd), REFLECT_FIELD(ValveActuator, pos),
+  REFLECT_FIELD(ValveActuator, speed), REFLECT_FIELD(ValveActuator, fail_ATC))
+REFLECT_COMPONENT(Tank,
+  REFLECT_FIELD(Tank, level), REFLECT_FIELD(Tank, area),
+  REFLECT_FIELD(Tank, inflow), REFLECT_FIELD(Tank, outflow))
+REFLECT_COMPONENT(Pipe,
+  REFLECT_FIELD(Pipe, k),
+  REFLECT_FIELD(Pipe, turbulent))
+REFLECT_COMPONENT(PID,
+  REFLECT_FIELD(PID, kp), REFLECT_FIELD(PID, ki), REFLECT_FIELD(PID, kd), REFLECT_FIELD(PID, sp),
+  REFLECT_FIELD(PID, pv), REFLECT_FIELD(PID, out), REFLECT_FIELD(PID, integ))
+REFLECT_COMPONENT(Alarmable,
+  REFLECT_FIELD(Alarmable, hi), REFLECT_FIELD(Alarmable, lo), REFLECT_FIELD(Alarmable, latched),
+  REFLECT_FIELD(Alarmable, hiSP), REFLECT_FIELD(Alarmable, loSP),
+  REFLECT_FIELD(Alarmable, deadband), REFLECT_FIELD(Alarmable, source_component),
+  REFLECT_FIELD(Alarmable, source_field))
+REFLECT_COMPONENT(HumanFactors,
+  REFLECT_FIELD(HumanFactors, training), REFLECT_FIELD(HumanFactors, fatigue),
+  REFLECT_FIELD(HumanFactors, shift_length_hours), REFLECT_FIELD(HumanFactors, staff_on_shift),
+  REFLECT_FIELD(HumanFactors, reaction_time_mult))
+REFLECT_COMPONENT(AlarmResponse,
+  REFLECT_FIELD(AlarmResponse, active), REFLECT_FIELD(AlarmResponse, acknowledged),
+  REFLECT_FIELD(AlarmResponse, ack_timer_s), REFLECT_FIELD(AlarmResponse, repair_time_s),
+  REFLECT_FIELD(AlarmResponse, ack_delay_target_s), REFLECT_FIELD(AlarmResponse, repair_time_target_s),
+  REFLECT_FIELD(AlarmResponse, elapsed_s))
+REFLECT_COMPONENT(SiteKPI,
+  REFLECT_FIELD(SiteKPI, alarms_raised), REFLECT_FIELD(SiteKPI, alarms_active), REFLECT_FIELD(SiteKPI, downtime_s),
+  REFLECT_FIELD(SiteKPI, alarms_per_hour), REFLECT_FIELD(SiteKPI, median_ack_s),
+  REFLECT_FIELD(SiteKPI, median_repair_s), REFLECT_FIELD(SiteKPI, mttr_s),
+  REFLECT_FIELD(SiteKPI, downtime_min_hour), REFLECT_FIELD(SiteKPI, throughput),
+  REFLECT_FIELD(SiteKPI, throughput_delta), REFLECT_FIELD(SiteKPI, alarms_per_10min),
+  REFLECT_FIELD(SiteKPI, flood_pct), REFLECT_FIELD(SiteKPI, chattering), REFLECT_FIELD(SiteKPI, stale),
+  REFLECT_FIELD(SiteKPI, unmet_steam), REFLECT_FIELD(SiteKPI, unmet_cooling_kw),
+  REFLECT_FIELD(SiteKPI, unmet_cooling_kwh), REFLECT_FIELD(SiteKPI, utility_kw))
+REFLECT_COMPONENT(HeatExchanger,
+  REFLECT_FIELD(HeatExchanger, power_on), REFLECT_FIELD(HeatExchanger, comp_inlet_stream),
+  REFLECT_FIELD(HeatExchanger, comp_outlet_stream), REFLECT_FIELD(HeatExchanger, flow_rate),
+  REFLECT_FIELD(HeatExchanger, tau_s), REFLECT_FIELD(HeatExchanger, temp), REFLECT_FIELD(HeatExchanger, pressure))
+REFLECT_COMPONENT(Boiler,
+  REFLECT_FIELD(Boiler, pressure), REFLECT_FIELD(Boiler, steam_flow),
+  REFLECT_FIELD(Boiler, feedwater_temp), REFLECT_FIELD(Boiler, efficiency),
+  REFLECT_FIELD(Boiler, bus), REFLECT_FIELD(Boiler, capacity), REFLECT_FIELD(Boiler, firing),
+  REFLECT_FIELD(Boiler, firing_rate), REFLECT_FIELD(Boiler, tau_s), REFLECT_FIELD(Boiler, pressure_sp),
+  REFLECT_FIELD(Boiler, kp), REFLECT_FIELD(Boiler, ki), REFLECT_FIELD(Boiler, integ),
+  REFLECT_FIELD(Boiler, fuel_kw))
+REFLECT_COMPONENT(RefrigerationCompressor,
+  REFLECT_FIELD(RefrigerationCompressor, suction), REFLECT_FIELD(RefrigerationCompressor, discharge_pressure),
+  REFLECT_FIELD(RefrigerationCompressor, load), REFLECT_FIELD(RefrigerationCompressor, motor_kW),
+  REFLECT_FIELD(RefrigerationCompressor, bus), REFLECT_FIELD(RefrigerationCompressor, capacity_kw),
+  REFLECT_FIELD(RefrigerationCompressor, stages), REFLECT_FIELD(RefrigerationCompressor, stage),
+  REFLECT_FIELD(RefrigerationCompressor, stage_delay_s), REFLECT_FIELD(RefrigerationCompressor, since_stage_s),
+  REFLECT_FIELD(RefrigerationCompressor, kp), REFLECT_FIELD(RefrigerationCompressor, ki),
+  REFLECT_FIELD(RefrigerationCompressor, integ), REFLECT_FIELD(RefrigerationCompressor, cooling_kw),
+  REFLECT_FIELD(RefrigerationCompressor, rejected_kw), REFLECT_FIELD(RefrigerationCompressor, tripped))
+REFLECT_COMPONENT(CoolingTower,
+  REFLECT_FIELD(CoolingTower, fan_speed), REFLECT_FIELD(CoolingTower, approach_temp), REFLECT_FIELD(CoolingTower, cycles),
+  REFLECT_FIELD(CoolingTower, bus), REFLECT_FIELD(CoolingTower, wetbulb), REFLECT_FIELD(CoolingTower, design_kw),
+  REFLECT_FIELD(CoolingTower, design_approach), REFLECT_FIELD(CoolingTower, leaving_sp),
+  REFLECT_FIELD(CoolingTower, leaving_temp), REFLECT_FIELD(CoolingTower, heat_kw),
+  REFLECT_FIELD(CoolingTower, makeup_kg_s))
+REFLECT_COMPONENT(AirSystem,
+  REFLECT_FIELD(AirSystem, pressure), REFLECT_FIELD(AirSystem, dewpoint), REFLECT_FIELD(AirSystem, dryer_status))
+REFLECT_COMPONENT(WaterTreatment,
+  REFLECT_FIELD(WaterTreatment, RO_pressure), REFLECT_FIELD(WaterTreatment, hardness),
+  REFLECT_FIELD(WaterTreatment, chemical_dose))
+REFLECT_COMPONENT(Wastewater,
+  REFLECT_FIELD(Wastewater, flow_in), REFLECT_FIELD(Wastewater, flow_out),
+  REFLECT_FIELD(Wastewater, DO), REFLECT_FIELD(Wastewater, pH))
+REFLECT_COMPONENT(SteamHeader,
+  REFLECT_FIELD(SteamHeader, pressure), REFLECT_FIELD(SteamHeader, steam_supply_flow),
+  REFLECT_FIELD(SteamHeader, steam_demand_flow), REFLECT_FIELD(SteamHeader, unmet_demand_flow),
+  REFLECT_FIELD(SteamHeader, bus), REFLECT_FIELD(SteamHeader, capacitance),
+  REFLECT_FIELD(SteamHeader, pressure_min), REFLECT_FIELD(SteamHeader, pressure_relief),
+  REFLECT_FIELD(SteamHeader, vented_flow))
+REFLECT_COMPONENT(ChilledWaterLoop,
+  REFLECT_FIELD(ChilledWaterLoop, supply_temp), REFLECT_FIELD(ChilledWaterLoop, return_temp),
+  REFLECT_FIELD(ChilledWaterLoop, cooling_supply_kw), REFLECT_FIELD(ChilledWaterLoop, cooling_demand_kw),
+  REFLECT_FIELD(ChilledWaterLoop, unmet_cooling_kw), REFLECT_FIELD(ChilledWaterLoop, bus),
+  REFLECT_FIELD(ChilledWaterLoop, supply_sp), REFLECT_FIELD(ChilledWaterLoop, return_design),
+  REFLECT_FIELD(ChilledWaterLoop, flow_kg_s), REFLECT_FIELD(ChilledWaterLoop, thermal_mass),
+  REFLECT_FIELD(ChilledWaterLoop, unmet_kwh))
+REFLECT_COMPONENT(SteamLoad,
+  REFLECT_FIELD(SteamLoad, demand_flow), REFLECT_FIELD(SteamLoad, granted_flow), REFLECT_FIELD(SteamLoad, bus))
+REFLECT_COMPONENT(CoolingLoad,
+  REFLECT_FIELD(CoolingLoad, demand_kw), REFLECT_FIELD(CoolingLoad, granted_kw), REFLECT_FIELD(CoolingLoad, bus))
+REFLECT_COMPONENT(PressureReducingValve,
+  REFLECT_FIELD(PressureReducingValve, from_bus), REFLECT_FIELD(PressureReducingValve, to_bus),
+  REFLECT_FIELD(PressureReducingValve, setpoint), REFLECT_FIELD(PressureReducingValve, kp),
+  REFLECT_FIELD(PressureReducingValve, capacity), REFLECT_FIELD(PressureReducingValve, flow))
+REFLECT_COMPONENT(Area,
+  REFLECT_FIELD(Area, site))
+
+namespace detail {
+template<typename T, typename... L>
+constexpr int componentIndex(ComponentTypes<L...>) {
+  int i = 0, found = -1;
+  ((std::is_same_v<T, L> ? (found = i, ++i) : ++i), ...);
+  return found;
+}
+}
+
+template<typename T>
+constexpr int componentIndex() { return detail::componentIndex<T>(AllComponents{}); }
+
+// Runtime view of the table, for code that only knows names (JSON, files).
+enum class FieldKind : std::uint8_t { Float, Bool, Int };
+
+struct FieldInfo {
+  const char*   name;
+  FieldKind     kind;
+  std::uint32_t offset;  // byte offset inside the component
+};
+
+struct ComponentInfo {
+  const char*   name;
+  int           index;   // position in AllComponents
+  std::size_t   size;
+  std::vector<FieldInfo> fields;
+
+  void* (*emplace)(entt::registry&, entt::entity);  // emplace_or_replace, default values
+  void* (*get)(entt::registry&, entt::entity);      // nullptr if absent
+  void  (*remove)(entt::registry&, entt::entity);
+
+  // Bulk access in packed (iteration) order, so a dump/restore round trip
+  // keeps view order and therefore results bit-identical.
+  // The packed entities themselves, no copy; valid until the storage changes.
+  std::size_t (*rows)(entt::registry&, const entt::entity*& first);
+  void  (*dump)(entt::registry&, std::vector<entt::entity>& entities, std::vector<char>& bytes);
+  void  (*insert)(entt::registry&, const entt::entity* entities, std::size_t n, const void* values);
+  // Makes the column exactly (entities, values). Overwrites in place when the
+  // packed entities already match, so cached component pointers stay valid;
+  // returns false when it had to clear and re-insert instead.
+  bool  (*assign)(entt::registry&, const entt::entity* entities, std::size_t n, const void* values);
+
+  const FieldInfo* field(std::string_view name) const;
+};
+
+const std::vector<ComponentInfo>& componentTable();   // indexed by componentIndex
+const ComponentInfo* findComponent(std::string_view name);
+// "Tank.level" → indices into componentTable() and its fields.
+bool findFieldRef(std::string_view ref, int& component, int& field);
+
+// Reads/writes a field as double regardless of its kind.
+double readField(const void* component, const FieldInfo& f);
+void writeField(void* component, const FieldInfo& f, double value);
@@ -27,6 +27,7 @@ struct Tank {
 
 struct Pipe {
   float k{1.0f}; // simple resistance
+  bool turbulent{false}; // flow ~ sqrt(head) instead of linear in it
 };
 
 struct PID {
@@ -40,6 +41,11 @@ struct PID {
 struct Alarmable {
   bool  hi{false}, lo{false}, latched{false};
   float hiSP{0.90f}, loSP{0.10f};
+  float deadband{0.0f};     // an active alarm clears this far back inside its setpoint
+  // Watched float on the same entity, as componentTable()/field indices
+  // (JSON: "source": "Pump.flow"); -1 means Tank::level.
+  int   source_component{-1};
+  int   source_field{-1};
 };
 
 struct HumanFactors {
@@ -53,16 +59,42 @@ struct HumanFactors {
 struct AlarmResponse {
     bool active{false};
     bool acknowledged{false};
-    float ack_timer_s{1.0f};
-    float repair_time_s{1.0f};
+    float ack_timer_s{1.0f};         // durations drawn when raised; counted down
+    float repair_time_s{1.0f};       // per tick only without an AlarmEngine
     float ack_delay_target_s{1.0f};
     float repair_time_target_s{120.0f};
+    float elapsed_s{0.0f};           // raise → latest ack/repair
 };
 
 struct SiteKPI {
   int alarms_raised{0};
   int alarms_active{0};
   float downtime_s{0.0f};
+  // Rolling KPIs, kept current by AnalyticsSystem (see KpiEngine)
+  float alarms_per_hour{0.0f};
+  float median_ack_s{0.0f};
+  float median_repair_s{0.0f};
+  float mttr_s{0.0f};
+  float downtime_min_hour{0.0f};  // downtime_s accrued in the last window, in minutes
+  float throughput{0.0f};         // mean total pump flow over the last window
+  float throughput_delta{0.0f};   // vs the window before it
+  // Alarm-management metrics (see AlarmMetrics)
+  float alarms_per_10min{0.0f};   // activations per operator, trailing 10 min
+  float flood_pct{0.0f};          // share of 10-min periods in flood
+  int   chattering{0};            // points chattering now
+  int   stale{0};                 // points standing > 24 h
+  // Utilities (UtilitySystem)
+  float unmet_steam{0.0f};        // over all steam headers, now
+  float unmet_cooling_kw{0.0f};   // over all chilled-water loops, now
+  float unmet_cooling_kwh{0.0f};  // since load
+  float utility_kw{0.0f};         // boiler fuel plus compressor motors
+};
+
+// Which site (area, unit) an entity belongs to; absent means site 0. On an
+// entity carrying HumanFactors or SiteKPI it names the site those serve.
+// See SiteContext.
+struct Area {
+  int site{0};
 };
 
 struct HeatExchanger {
@@ -76,23 +108,56 @@ struct HeatExchanger {
 };
 
 struct Boiler {
-    float pressure{10.0f};
+    float pressure{10.0f};           // drum, follows its header
     float steam_flow{0.0f};
     float feedwater_temp{120.0f};
     float efficiency{0.90f};
-};
-
+    // Firing-rate dynamics (BoilerSystem, see SteamNetwork)
+    int   bus{0};                    // SteamHeader::bus it feeds
+    float capacity{50.0f};           // steam flow at full fire, 120 °C feedwater
+    float firing{0.5f};              // 0..1
+    float firing_rate{0.01f};        // max firing change per second
+    float tau_s{30.0f};              // steaming lag behind firing
+    float pressure_sp{10.0f};        // master: header demand feedforward plus PI trim
+    float kp{0.02f};
+    float ki{0.0001f};
+    float integ{0.0f};
+    float fuel_kw{0.0f};
+};
+
+// Ammonia screw/reciprocating compressor serving a chilled-water loop
+// (RefrigSystem, see CoolingNetwork)
 struct RefrigerationCompressor {
-    float suction{3.5f};
-    float discharge_pressure{12.0f};
-    float load{0.0f};
+    float suction{3.5f};             // bar, saturation at the evaporating temperature
+    float discharge_pressure{12.0f}; // bar, saturation at the condensing temperature
+    float load{0.0f};                // stage / stages
     float motor_kW{0.0f};
+    int   bus{0};                    // ChilledWaterLoop::bus it cools, CoolingTower::bus it rejects to
+    float capacity_kw{500.0f};       // refrigeration at full load, 2 °C → 35 °C lift
+    int   stages{4};                 // unloader steps
+    int   stage{0};
+    float stage_delay_s{60.0f};      // minimum time between steps
+    float since_stage_s{0.0f};
+    float kp{0.5f};                  // capacity per K of supply temperature error
+    float ki{0.002f};
+    float integ{0.0f};
+    float cooling_kw{0.0f};          // evaporator duty
+    float rejected_kw{0.0f};         // condenser duty
+    bool  tripped{false};            // freeze cutout, latched until the supply recovers
 };
 
 struct CoolingTower {
-    float fan_speed{0.0f};
-    float approach_temp{5.0f};
-    float cycles{3.0f};
+    float fan_speed{0.0f};           // 0..1
+    float approach_temp{5.0f};       // leaving water above wet bulb, now
+    float cycles{3.0f};              // of concentration
+    int   bus{0};
+    float wetbulb{20.0f};            // ambient
+    float design_kw{2500.0f};        // heat rejected at design_approach with fans at full speed
+    float design_approach{4.0f};
+    float leaving_sp{27.0f};         // fans modulate to hold this
+    float leaving_temp{25.0f};       // condenser water supply
+    float heat_kw{0.0f};
+    float makeup_kg_s{0.0f};         // evaporation plus blowdown
 };
 
 struct AirSystem {
@@ -120,23 +185,46 @@ struct SteamHeader {
     float steam_supply_flow{10.0f};
     float steam_demand_flow{10.0f};
     float unmet_demand_flow{10.0f};
+    int   bus{0};                    // boilers, loads and PRVs name headers by bus
+    float capacitance{50.0f};        // steam stored per unit of pressure
+    float pressure_min{8.0f};        // loads are curtailed rather than drawing below this
+    float pressure_relief{12.0f};    // safety valves vent above this
+    float vented_flow{0.0f};
 };
 
 struct ChilledWaterLoop {
-    float supply_temp{60.0f};
-    float return_temp{10.0f};
+    float supply_temp{7.0f};
+    float return_temp{12.0f};
     float cooling_supply_kw{10.0f};
     float cooling_demand_kw{10.0f};
     float unmet_cooling_kw{10.0f};
+    int   bus{0};
+    float supply_sp{7.0f};
+    float return_design{12.0f};      // coils carry no duty once the supply is this warm
+    float flow_kg_s{100.0f};
+    float thermal_mass{50000.0f};    // kJ/K of water in the loop
+    float unmet_kwh{0.0f};
 };
 
 // Consumers
 struct SteamLoad {
     float demand_flow{10.0f};
     float granted_flow{10.0f};
+    int   bus{0};
 };
 
 struct CoolingLoad {
     float demand_kw{10.0f};
     float granted_kw{10.0f};
+    int   bus{0};
+};
+
+// Lets steam down from one header to a lower-pressure one
+struct PressureReducingValve {
+    int   from_bus{0};
+    int   to_bus{1};
+    float setpoint{4.0f};            // downstream pressure
+    float kp{10.0f};                 // flow per unit of pressure below setpoint
+    float capacity{20.0f};
+    float flow{0.0f};
 };
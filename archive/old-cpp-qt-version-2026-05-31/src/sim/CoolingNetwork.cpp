@@ -0,0 +1,215 @@
+#include "CoolingNetwork.hpp"
+#include "BatchKernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+constexpr float kWaterCp        = 4.19f;   // kJ/kg/K
+constexpr float kEvapApproach   = 5.f;     // K, evaporating below chilled-water supply
+constexpr float kCondApproach   = 5.f;     // K, condensing above tower water
+constexpr float kAirCooled      = 35.f;    // °C condensing without a tower on the bus
+constexpr float kDesignLift     = 33.f;    // K, 2 °C → 35 °C, where capacity_kw is rated
+constexpr float kCarnotFraction = 0.6f;
+constexpr float kCutout         = 3.f;     // °C supply, evaporator freeze protection
+constexpr float kCutoutReset    = 2.f;     // K above kCutout before restarting
+constexpr float kCoilMargin     = 1.f;     // K above supply_sp still at full duty
+constexpr float kStageBand      = 0.75f;   // steps of hysteresis either side
+constexpr float kMinFan         = 0.15f;   // natural draft with fans off
+constexpr float kFanRate        = 0.02f;   // fan speed change per second
+constexpr float kTowerTau       = 120.f;   // s, basin and condenser water
+constexpr float kLatentHeat     = 2400.f;  // kJ/kg evaporated
+
+// NH3 saturation pressure in bar (Antoine fit, NIST, 239–371 K)
+float ammoniaPressure(float t_c) {
+    return std::pow(10.f, 4.86886f - 1113.928f / (t_c + 273.15f - 10.409f));
+}
+}
+
+CoolingNetwork CoolingNetwork::compile(entt::registry& r) {
+    CoolingNetwork net;
+
+    std::unordered_map<int, std::uint32_t> loop_of, tower_of;
+    auto lv = r.view<ChilledWaterLoop>();
+    for (auto e : lv) {
+        auto& l = lv.get<ChilledWaterLoop>(e);
+        if (!loop_of.emplace(l.bus, static_cast<std::uint32_t>(net.loop.size())).second) {
+            std::cerr << "Two chilled-water loops on bus " << l.bus << "; the second is ignored\n";
+            continue;
+        }
+        net.loop.push_back(&l);
+    }
+    if (net.loop.empty())
+        return net;
+    const std::size_t n = net.loop.size();
+
+    auto tv = r.view<CoolingTower>();
+    for (auto e : tv) {
+        auto& t = tv.get<CoolingTower>(e);
+        if (!tower_of.emplace(t.bus, static_cast<std::uint32_t>(net.tower.size())).second) {
+            std::cerr << "Two cooling towers on bus " << t.bus << "; the second is ignored\n";
+            continue;
+        }
+        net.tower.push_back(&t);
+    }
+
+    auto cv = r.view<RefrigerationCompressor>();
+    for (auto e : cv) {
+        auto& c = cv.get<RefrigerationCompressor>(e);
+        auto l = loop_of.find(c.bus);
+        if (l == loop_of.end()) {
+            std::cerr << "Compressor on bus " << c.bus << " has no chilled-water loop; ignored\n";
+            continue;
+        }
+        auto t = tower_of.find(c.bus);
+        net.compressor.push_back(&c);
+        net.compressor_loop.push_back(l->second);
+        net.compressor_tower.push_back(t == tower_of.end() ? -1 : static_cast<std::int32_t>(t->second));
+    }
+
+    std::vector<std::pair<std::uint32_t, CoolingLoad*>> loads;
+    std::size_t orphans = 0;
+    auto dv = r.view<CoolingLoad>();
+    for (auto e : dv) {
+        auto& d = dv.get<CoolingLoad>(e);
+        auto it = loop_of.find(d.bus);
+        if (it == loop_of.end()) {
+            ++orphans;
+            continue;
+        }
+        loads.emplace_back(it->second, &d);
+    }
+    if (orphans)
+        std::cerr << orphans << " cooling load(s) on a bus with no chilled-water loop get no cooling\n";
+    std::stable_sort(loads.begin(), loads.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    std::vector<std::uint32_t> load_loop;
+    for (auto [l, d] : loads) {
+        net.load.push_back(d);
+        load_loop.push_back(l);
+    }
+    net.load_ptr = BatchKernels::csrOffsets(load_loop, n);
+
+    net.capacity.assign(n, 0.f);
+    net.duty.assign(n, 0.f);
+    net.heat.assign(net.tower.size(), 0.f);
+    net.demand.assign(net.load.size(), 0.f);
+    net.granted.assign(net.load.size(), 0.f);
+    return net;
+}
+
+void CoolingNetwork::step(float dt, Integrator method) {
+    std::fill(duty.begin(), duty.end(), 0.f);
+    for (std::size_t c = 0; c < compressor.size(); ++c)
+        duty[compressor_loop[c]] += compressor[c]->cooling_kw;
+    for (std::size_t i = 0; i < load.size(); ++i)
+        demand[i] = load[i]->demand_kw;
+
+    for (std::size_t l = 0; l < loop.size(); ++l) {
+        ChilledWaterLoop& lp = *loop[l];
+
+        // Coil valves absorb the first kCoilMargin of warming, then duty falls
+        // away until the supply reaches return_design
+        const float span = std::max(0.1f, lp.return_design - lp.supply_sp - kCoilMargin);
+        const float frac = std::clamp((lp.return_design - lp.supply_temp) / span, 0.f, 1.f);
+        const std::uint32_t b = load_ptr[l];
+        const float want = BatchKernels::prorata(load_ptr[l + 1] - b, demand.data() + b, granted.data() + b, frac);
+        const float got  = want * frac;
+
+        lp.cooling_demand_kw = want;
+        lp.cooling_supply_kw = duty[l];
+        lp.unmet_cooling_kw  = want - got;
+        lp.unmet_kwh += lp.unmet_cooling_kw * dt / 3600.f;
+        lp.return_temp = lp.supply_temp + got / (std::max(1.f, lp.flow_kg_s) * kWaterCp);
+
+        const float mass = std::max(1.f, lp.thermal_mass);
+        if (method == Integrator::Euler) {
+            lp.supply_temp += (got - duty[l]) * dt / mass;
+        } else {
+            // Coil duty falls as the loop warms, which is what makes it stiff
+            // once the loads outweigh the water in it
+            auto rate = [&](float t) {
+                return (want * std::clamp((lp.return_design - t) / span, 0.f, 1.f) - duty[l]) / mass;
+            };
+            const float slope = (frac > 0.f && frac < 1.f) ? -want / (span * mass) : 0.f;
+            lp.supply_temp = advance(method, lp.supply_temp, dt, rate, slope);
+        }
+    }
+
+    for (std::size_t i = 0; i < load.size(); ++i)
+        load[i]->granted_kw = granted[i];
+}
+
+void CoolingNetwork::refrigerate(float dt, Integrator method) {
+    std::fill(capacity.begin(), capacity.end(), 0.f);
+    for (std::size_t c = 0; c < compressor.size(); ++c)
+        capacity[compressor_loop[c]] += std::max(0.f, compressor[c]->capacity_kw);
+    std::fill(heat.begin(), heat.end(), 0.f);
+
+    for (std::size_t c = 0; c < compressor.size(); ++c) {
+        RefrigerationCompressor& k = *compressor[c];
+        const ChilledWaterLoop& lp = *loop[compressor_loop[c]];
+        const std::int32_t t = compressor_tower[c];
+
+        // Capacity command: last tick's loop demand fed forward, supply
+        // temperature trimmed by PI; unloaders step toward it with
+        // hysteresis and a minimum dwell between steps
+        const float cap = capacity[compressor_loop[c]];
+        const float ff  = cap > 0.f ? lp.cooling_demand_kw / cap : 0.f;
+        const float err = lp.supply_temp - lp.supply_sp;
+        k.integ = std::clamp(k.integ + k.ki * err * dt, -1.f, 1.f);
+        const float cmd = std::clamp(ff + k.kp * err + k.integ, 0.f, 1.f);
+
+        const int stages = std::max(1, k.stages);
+        const float want = cmd * static_cast<float>(stages);
+        k.since_stage_s += dt;
+        if (k.since_stage_s >= k.stage_delay_s) {
+            if (want > static_cast<float>(k.stage) + kStageBand && k.stage < stages) {
+                ++k.stage;
+                k.since_stage_s = 0.f;
+            } else if (want < static_cast<float>(k.stage) - kStageBand && k.stage > 0) {
+                --k.stage;
+                k.since_stage_s = 0.f;
+            }
+        }
+        k.stage = std::clamp(k.stage, 0, stages);
+        k.load  = static_cast<float>(k.stage) / static_cast<float>(stages);
+
+        // Refrigeration cycle at this lift
+        const float t_evap = lp.supply_temp - kEvapApproach;
+        const float t_cond = t >= 0 ? tower[t]->leaving_temp + kCondApproach : kAirCooled;
+        const float lift   = std::max(5.f, t_cond - t_evap);
+        const float derate = std::clamp(1.f - 0.015f * (lift - kDesignLift), 0.3f, 1.3f);
+        if (lp.supply_temp < kCutout)
+            k.tripped = true;
+        else if (lp.supply_temp > kCutout + kCutoutReset)
+            k.tripped = false;
+        k.cooling_kw  = k.tripped ? 0.f : std::max(0.f, k.capacity_kw) * k.load * derate;
+        k.motor_kW    = k.cooling_kw * lift / (kCarnotFraction * (t_evap + 273.15f));
+        k.rejected_kw = k.cooling_kw + k.motor_kW;
+        k.suction            = ammoniaPressure(t_evap);
+        k.discharge_pressure = ammoniaPressure(t_cond);
+        if (t >= 0)
+            heat[t] += k.rejected_kw;
+    }
+
+    for (std::size_t t = 0; t < tower.size(); ++t) {
+        CoolingTower& ct = *tower[t];
+        const float load = heat[t] / std::max(1.f, ct.design_kw);
+
+        // Approach grows with heat load and shrinks with airflow (~ fan^0.8);
+        // fans slew toward the speed that holds leaving_sp
+        const float room = std::max(0.5f, ct.leaving_sp - ct.wetbulb);
+        const float fan  = std::clamp(std::pow(ct.design_approach * load / room, 1.25f), kMinFan, 1.f);
+        ct.fan_speed += std::clamp(fan - ct.fan_speed, -kFanRate * dt, kFanRate * dt);
+        ct.approach_temp = ct.design_approach * load / std::pow(std::max(kMinFan, ct.fan_speed), 0.8f);
+
+        const float alpha = lagAlpha(method, dt / kTowerTau);
+        ct.leaving_temp += alpha * (ct.wetbulb + ct.approach_temp - ct.leaving_temp);
+        ct.heat_kw = heat[t];
+
+        const float evaporated = heat[t] / kLatentHeat;
+        ct.makeup_kg_s = ct.cycles > 1.f ? evaporated * ct.cycles / (ct.cycles - 1.f) : evaporated;
+    }
+}
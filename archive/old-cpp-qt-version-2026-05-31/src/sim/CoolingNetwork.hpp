@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <entt/entt.hpp>
+#include "Components.hpp"
+#include "Integrator.hpp"
+
+// Chilled-water and ammonia refrigeration plant, compiled from the bus
+// numbers on ChilledWaterLoop, CoolingLoad, RefrigerationCompressor and
+// CoolingTower (the SteamNetwork scheme; PlantTopology edges are hydraulic).
+//
+// Each loop is a lumped mass of water at supply_temp. Coils deliver their
+// full demand up to 1 K above supply_sp and nothing once the supply has
+// warmed to return_design, so a short plant warms the loop until the coils'
+// share matches what the compressors remove and the rest is unmet cooling. The
+// compressors on a loop stage their unloaders together on demand
+// feedforward plus a PI trim on supply temperature. Capacity, COP and the
+// NH3 suction/discharge pressures follow the lift from evaporator to
+// condenser, and the condenser sits on its bus's tower, whose leaving water
+// tracks ambient wet bulb plus an approach set by heat load and fan speed.
+//
+// Every pass walks flat per-component arrays: loads go through
+// BatchKernels::prorata by loop, compressors and towers through their cached
+// pointers in index order. Re-run compile() after adding or removing
+// cooling components or changing a bus.
+struct CoolingNetwork {
+  // Per loop
+  std::vector<ChilledWaterLoop*> loop;
+  std::vector<std::uint32_t> load_ptr;  // loads of loop l: [load_ptr[l], load_ptr[l + 1])
+  std::vector<float> capacity, duty;    // scratch
+
+  // Per tower, one per bus
+  std::vector<CoolingTower*> tower;
+  std::vector<float> heat;              // scratch
+
+  // Per compressor
+  std::vector<RefrigerationCompressor*> compressor;
+  std::vector<std::uint32_t> compressor_loop;
+  std::vector<std::int32_t> compressor_tower;  // -1: air-cooled condenser
+
+  // Per load, grouped by loop
+  std::vector<CoolingLoad*> load;
+  std::vector<float> demand, granted;
+
+  std::size_t loopCount() const { return loop.size(); }
+  std::size_t loadCount() const { return load.size(); }
+
+  static CoolingNetwork compile(entt::registry& r);
+  // Cooling: coil duty and loop heat balance
+  void step(float dt, Integrator method = Integrator::Euler);
+  // RefrigSystem: compressor staging, then towers
+  void refrigerate(float dt, Integrator method = Integrator::Euler);
+};
@@ -0,0 +1,316 @@
+#include "FlowNetwork.hpp"
+#include "Loader.hpp"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace {
+constexpr float  kEps         = 1e-3f;  // same regularisation as the old per-pump formula
+constexpr double kLaminarHead = 1e-2;   // turbulent edges are linear below about this head
+constexpr double kGmin        = 1e-9;   // holds heads that no open edge pins down
+
+// Flow through an edge at head difference d, and its slope dq/dd
+inline void edgeLaw(double g, double d, bool turbulent, double& q, double& c) {
+    if (!turbulent) {
+        q = g * d;
+        c = g;
+        return;
+    }
+    // q = g*d/sqrt(|d| + h0): ~ g*sign(d)*sqrt(|d|) when |d| >> h0
+    const double a = std::fabs(d) + kLaminarHead;
+    const double s = std::sqrt(a);
+    q = g * d / s;
+    c = g * (0.5 * std::fabs(d) + kLaminarHead) / (a * s);
+}
+}
+
+FlowNetwork FlowNetwork::compile(entt::registry& r, const PlantTopology& topo) {
+    FlowNetwork net;
+    std::unordered_map<entt::entity, std::uint32_t> index;
+
+    auto addNode = [&](entt::entity e) {
+        auto [it, inserted] = index.try_emplace(e, static_cast<std::uint32_t>(net.entity.size()));
+        if (inserted) {
+            net.entity.push_back(e);
+            net.pump.push_back(r.try_get<Pump>(e));
+            net.valve.push_back(r.try_get<ValveActuator>(e));
+            net.pipe.push_back(r.try_get<Pipe>(e));
+            net.tank.push_back(r.try_get<Tank>(e));
+            net.pid.push_back(r.try_get<PID>(e));
+        }
+        return it->second;
+    };
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+    edges.reserve(topo.edges.size());
+    for (auto [from, to] : topo.edges) {
+        if (!r.valid(from) || !r.valid(to) || from == to)
+            continue;
+        const auto a = addNode(from);
+        const auto b = addNode(to);
+        edges.emplace_back(a, b);
+    }
+    // Unconnected pumps still run (legacy single-entity pump/valve/tank)
+    for (auto e : r.view<Pump>())
+        addNode(e);
+
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    const std::size_t n = net.entity.size();
+    const std::size_t m = edges.size();
+
+    net.out_ptr.assign(n + 1, 0);
+    net.edge_from.resize(m);
+    net.edge_to.resize(m);
+    for (std::size_t k = 0; k < m; ++k) {
+        net.edge_from[k] = edges[k].first;
+        net.edge_to[k]   = edges[k].second;
+        ++net.out_ptr[edges[k].first + 1];
+    }
+    for (std::size_t i = 0; i < n; ++i)
+        net.out_ptr[i + 1] += net.out_ptr[i];
+
+    // Incidence CSR
+    std::vector<std::uint32_t> in_deg(n, 0);
+    net.inc_ptr.assign(n + 1, 0);
+    for (std::size_t k = 0; k < m; ++k) {
+        ++net.inc_ptr[net.edge_from[k] + 1];
+        ++net.inc_ptr[net.edge_to[k] + 1];
+        ++in_deg[net.edge_to[k]];
+    }
+    for (std::size_t i = 0; i < n; ++i)
+        net.inc_ptr[i + 1] += net.inc_ptr[i];
+    net.inc_edge.resize(net.inc_ptr[n]);
+    std::vector<std::uint32_t> fill(net.inc_ptr.begin(), net.inc_ptr.end() - 1);
+    for (std::size_t k = 0; k < m; ++k) {
+        net.inc_edge[fill[net.edge_from[k]]++] = static_cast<std::uint32_t>(k);
+        net.inc_edge[fill[net.edge_to[k]]++]   = static_cast<std::uint32_t>(k);
+    }
+
+    net.fixed.resize(n);
+    net.head.assign(n, 0.f);
+    net.junction_row.assign(n, -1);
+    for (std::size_t i = 0; i < n; ++i) {
+        const bool root = in_deg[i] == 0;
+        const bool leaf = net.out_ptr[i + 1] == net.out_ptr[i];
+        net.fixed[i] = net.tank[i] || root || leaf;
+        if (!net.fixed[i]) {
+            net.junction_row[i] = static_cast<std::int32_t>(net.junctions.size());
+            net.junctions.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+
+    // Jacobian structure: one off-diagonal per edge between two junctions
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+    std::vector<std::uint32_t> pair_edge;
+    for (std::size_t k = 0; k < m; ++k) {
+        const std::int32_t a = net.junction_row[net.edge_from[k]], b = net.junction_row[net.edge_to[k]];
+        if (a >= 0 && b >= 0) {
+            pairs.emplace_back(static_cast<std::uint32_t>(a), static_cast<std::uint32_t>(b));
+            pair_edge.push_back(static_cast<std::uint32_t>(k));
+        }
+    }
+    net.jacobian.analyze(net.junctions.size(), pairs);
+    net.edge_slot.assign(m, kNoSlot);
+    for (std::size_t k = 0; k < pairs.size(); ++k)
+        net.edge_slot[pair_edge[k]] = net.jacobian.pairSlot(k);
+    net.residual.assign(net.junctions.size(), 0.0);
+    net.head_start.assign(net.junctions.size(), 0.f);
+
+    net.inflow.assign(n, 0.f);
+    net.outflow.assign(n, 0.f);
+    net.level0.assign(n, 0.f);
+    net.conductance.assign(m, 0.f);
+    net.edge_dp.assign(m, 0.f);
+    net.edge_flow.assign(m, 0.f);
+    net.turbulent.assign(m, 0);
+    net.factored_conductance.assign(m, 0.f);
+    net.flow_sum.assign(m, 0.f);
+    return net;
+}
+
+void FlowNetwork::solve() {
+    const std::size_t nj = junctions.size();
+    if (nj == 0)
+        return;
+    const std::size_t m = edge_to.size();
+
+    // A linear network's Jacobian is just its conductances
+    bool nonlinear = false;
+    for (std::size_t e = 0; e < m && !nonlinear; ++e)
+        nonlinear = turbulent[e] != 0;
+    bool refactor = !factored || nonlinear;
+    for (std::size_t e = 0; e < m && !refactor; ++e)
+        refactor = conductance[e] != factored_conductance[e];
+
+    for (std::size_t r = 0; r < nj; ++r)
+        head_start[r] = head[junctions[r]];
+
+    auto& A = jacobian.values();
+    for (int it = 0; it < max_iters; ++it) {
+        // Residual: net inflow at each junction, plus a gmin pull toward the
+        // head it started from so closed-off junctions stay where they were
+        for (std::size_t r = 0; r < nj; ++r)
+            residual[r] = kGmin * (static_cast<double>(head_start[r]) - head[junctions[r]]);
+        if (refactor) {
+            std::fill(A.begin(), A.end(), 0.0);
+            for (std::size_t r = 0; r < nj; ++r)
+                A[jacobian.diagSlot(static_cast<std::uint32_t>(r))] = kGmin;
+        }
+        for (std::size_t e = 0; e < m; ++e) {
+            const std::uint32_t a = edge_from[e], b = edge_to[e];
+            const std::int32_t ra = junction_row[a], rb = junction_row[b];
+            if (ra < 0 && rb < 0)
+                continue;
+            const double d = static_cast<double>(head[a]) + edge_dp[e] - head[b];
+            double q, c;
+            edgeLaw(conductance[e], d, turbulent[e] != 0, q, c);
+            if (ra >= 0) residual[ra] -= q;
+            if (rb >= 0) residual[rb] += q;
+            if (!refactor)
+                continue;
+            if (ra >= 0) A[jacobian.diagSlot(static_cast<std::uint32_t>(ra))] += c;
+            if (rb >= 0) A[jacobian.diagSlot(static_cast<std::uint32_t>(rb))] += c;
+            if (edge_slot[e] != kNoSlot) A[edge_slot[e]] -= c;
+        }
+
+        if (refactor) {
+            factored = jacobian.factor();
+            ++factorizations;
+            if (!factored)
+                return; // keep last heads; retried next tick
+            std::copy(conductance.begin(), conductance.end(), factored_conductance.begin());
+            refactor = nonlinear;
+        }
+
+        // J dh = -F with J = -(Laplacian), so the Laplacian solve gives dh directly
+        jacobian.solve(residual.data());
+        float change = 0.f;
+        for (std::size_t r = 0; r < nj; ++r) {
+            const float dh = static_cast<float>(residual[r]);
+            head[junctions[r]] += dh;
+            change = std::max(change, std::fabs(dh));
+        }
+        if (!nonlinear || change < tol)
+            break;
+    }
+}
+
+void FlowNetwork::flows() {
+    for (std::size_t e = 0; e < edge_to.size(); ++e) {
+        const float d = head[edge_from[e]] + edge_dp[e] - head[edge_to[e]];
+        if (!turbulent[e]) {
+            edge_flow[e] = conductance[e] * d;
+        } else {
+            double q, c;
+            edgeLaw(conductance[e], d, true, q, c);
+            edge_flow[e] = static_cast<float>(q);
+        }
+    }
+}
+
+void FlowNetwork::balance() {
+    const std::size_t n = entity.size();
+    std::fill(inflow.begin(), inflow.end(), 0.f);
+    std::fill(outflow.begin(), outflow.end(), 0.f);
+    for (std::size_t e = 0; e < edge_to.size(); ++e) {
+        const std::uint32_t a = edge_from[e], b = edge_to[e];
+        const float q = edge_flow[e];
+        if (q >= 0.f) { outflow[a] += q;  inflow[b] += q; }
+        else          { inflow[a]  -= q;  outflow[b] -= q; }
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!pump[i])
+            continue;
+        if (out_ptr[i + 1] == out_ptr[i]) {
+            // No downstream link: discharge into own tank (or away)
+            const float open = valve[i] ? valve[i]->pos : 1.f;
+            const float k    = pipe[i] ? pipe[i]->k : 1.f;
+            const float dp   = pump[i]->running ? pump[i]->dp_nominal : 0.f;
+            pump[i]->flow = open * dp / (k + kEps);
+            if (tank[i]) inflow[i] += pump[i]->flow;
+        } else {
+            pump[i]->flow = outflow[i] - inflow[i];
+        }
+    }
+}
+
+void FlowNetwork::step(float dt, Integrator method) {
+    const std::size_t n = entity.size();
+    const std::size_t m = edge_to.size();
+
+    // 1) Refresh boundary heads and per-edge coefficients from live components
+    for (std::size_t i = 0; i < n; ++i) {
+        if (tank[i])
+            head[i] = tank[i]->level;
+        else if (fixed[i])
+            head[i] = 0.f;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        const float open = valve[i] ? valve[i]->pos : 1.f;
+        const float k    = pipe[i] ? pipe[i]->k : 1.f;
+        const float dp   = (pump[i] && pump[i]->running) ? pump[i]->dp_nominal : 0.f;
+        const float g    = std::max(0.f, open) / (k + kEps);
+        for (std::uint32_t e = out_ptr[i]; e < out_ptr[i + 1]; ++e) {
+            conductance[e] = g;
+            edge_dp[e]     = dp;
+            turbulent[e]   = pipe[i] && pipe[i]->turbulent;
+        }
+    }
+
+    // 2) Junction heads and edge flows at the current tank levels
+    solve();
+    flows();
+
+    // RK4: three more solves with the tanks at the stage levels; the level
+    // then moves on the stage-weighted (1,2,2,1)/6 flows, which are also
+    // what gets reported, so the mass balance closes exactly
+    if (method == Integrator::RK4) {
+        for (std::size_t e = 0; e < m; ++e)
+            flow_sum[e] = edge_flow[e];
+        for (std::size_t i = 0; i < n; ++i)
+            if (tank[i])
+                level0[i] = tank[i]->level;
+
+        const float stage_h[3] = {0.5f * dt, 0.5f * dt, dt};
+        const float weight[3]  = {2.f, 2.f, 1.f};
+        for (int s = 0; s < 3; ++s) {
+            balance();
+            for (std::size_t i = 0; i < n; ++i)
+                if (tank[i])
+                    head[i] = std::clamp(level0[i] + (inflow[i] - outflow[i]) / tank[i]->area * stage_h[s], 0.f, 1.f);
+            solve();
+            flows();
+            for (std::size_t e = 0; e < m; ++e)
+                flow_sum[e] += weight[s] * edge_flow[e];
+        }
+        for (std::size_t e = 0; e < m; ++e)
+            edge_flow[e] = flow_sum[e] / 6.f;
+    }
+
+    // 3) Pump throughput and tank mass balance
+    balance();
+    for (std::size_t i = 0; i < n; ++i) {
+        Tank* t = tank[i];
+        if (!t)
+            continue;
+        t->inflow  = inflow[i];
+        t->outflow = outflow[i];
+        float rate = (t->inflow - t->outflow) / t->area;
+        if (method == Integrator::SemiImplicit) {
+            // d(rate)/d(level) = -(slope of the tank's own edges)/area
+            float g = 0.f;
+            for (std::uint32_t p = inc_ptr[i]; p < inc_ptr[i + 1]; ++p) {
+                const std::uint32_t e = inc_edge[p];
+                double q, c;
+                edgeLaw(conductance[e], head[edge_from[e]] + edge_dp[e] - head[edge_to[e]], turbulent[e] != 0, q, c);
+                g += static_cast<float>(c);
+            }
+            rate /= 1.f + dt * g / t->area;
+        }
+        t->level = std::clamp(t->level + rate * dt, 0.f, 1.f);
+        if (pid[i]) pid[i]->pv = t->level;
+    }
+}
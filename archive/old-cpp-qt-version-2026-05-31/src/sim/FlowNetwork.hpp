@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <entt/entt.hpp>
+#include "Components.hpp"
+#include "Integrator.hpp"
+#include "SparseLDL.hpp"
+
+struct PlantTopology;
+
+// Flat, index-based hydraulic graph compiled once after Loader::loadPlant.
+// Nodes are plant entities; each JSON `outputs` link is a directed edge whose
+// conductance comes from the upstream node's Pipe::k and ValveActuator::pos,
+// and whose driving head includes the upstream Pump::dp_nominal. Flow is
+// linear in head difference, or goes as its square root on a Pipe marked
+// turbulent (smoothed to linear for the last kLaminarHead near zero).
+//
+// Tanks hold their level as head, roots/leaves without a tank are open
+// boundaries at zero head, and every other node is a junction whose head is
+// solved each tick by Newton's method on net junction inflow. The Jacobian is
+// a weighted graph Laplacian over the junctions: its ordering and symbolic
+// LDLᵀ are computed in compile(), each tick only refactors numerically, and
+// not at all while every edge is linear and no conductance has changed.
+// Heads carry over as the warm start, so a linear network takes one Newton
+// step and a turbulent one typically two or three.
+//
+// Component pointers are cached at compile time (EnTT pages keep them
+// stable), so step() never touches a sparse set; re-run compile() after
+// adding or removing hydraulic components.
+//
+// Tank levels advance with the chosen Integrator: RK4 re-solves the junctions
+// at each stage and reports the stage-weighted flows, SemiImplicit damps each
+// level by the conductance of its own edges, so a tank on a short pipe no
+// longer limits dt.
+struct FlowNetwork {
+  // Per node
+  std::vector<entt::entity> entity;
+  std::vector<Pump*> pump;
+  std::vector<ValveActuator*> valve;
+  std::vector<Pipe*> pipe;
+  std::vector<Tank*> tank;
+  std::vector<PID*> pid;
+  std::vector<std::uint8_t> fixed;    // head known (tank or boundary)
+  std::vector<float> head;            // solved head, warm start for next tick
+  std::vector<float> inflow, outflow; // scratch for the mass balance
+  std::vector<float> level0;          // RK4 scratch: tank level at step start
+
+  // Edges sorted by source: CSR out_ptr over edge_to, plus edge_from
+  std::vector<std::uint32_t> out_ptr, edge_from, edge_to;
+  std::vector<float> conductance, edge_dp, edge_flow;
+  std::vector<std::uint8_t> turbulent;  // quadratic loss on this edge
+  std::vector<float> flow_sum;        // RK4 scratch: stage-weighted edge flow
+
+  // Node → incident edges (in and out)
+  std::vector<std::uint32_t> inc_ptr, inc_edge;
+
+  // Junction nodes only: row of the Newton system, and node → row (-1 fixed)
+  std::vector<std::uint32_t> junctions;
+  std::vector<std::int32_t> junction_row;
+
+  // Newton system: factor slot of each junction-junction edge (or kNoSlot),
+  // residual/step per junction, conductances the current factor was built from
+  static constexpr std::uint32_t kNoSlot = 0xffffffffu;
+  std::vector<std::uint32_t> edge_slot;
+  std::vector<double> residual;
+  std::vector<float> head_start;
+  std::vector<float> factored_conductance;
+  SparseLDL jacobian;
+  bool factored{false};
+
+  int   max_iters{20};  // Newton iterations
+  float tol{1e-6f};     // largest head change that counts as converged
+  std::uint64_t factorizations{0};
+
+  std::size_t nodeCount() const { return entity.size(); }
+  std::size_t edgeCount() const { return edge_to.size(); }
+
+  static FlowNetwork compile(entt::registry& r, const PlantTopology& topo);
+  void step(float dt, Integrator method = Integrator::Euler);
+
+private:
+  void solve();    // junction heads for the current tank heads
+  void flows();    // edge flows from heads
+  void balance();  // edge flows → node in/outflow and pump throughput
+};
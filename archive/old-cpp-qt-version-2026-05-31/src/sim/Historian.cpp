@@ -0,0 +1,788 @@
+#include "Historian.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+constexpr char kMagic[8] = {'E', 'X', 'S', 'I', 'M', 'H', 'S', 'T'};
+constexpr std::uint32_t kVersion = 1;
+
+// File: magic, version, then records of [RecordHeader][payload]
+enum RecordType : std::uint32_t { RecTags = 1, RecBlock = 2, RecRollup = 3, RecRewind = 4 };
+
+struct RecordHeader {
+    std::uint32_t type;
+    std::uint32_t reserved;
+    std::uint64_t bytes;
+};
+
+// RecBlock payload: BlockHeader, u32 offset[tags + 1], u64 words[offset[tags]]
+struct BlockHeader {
+    std::uint64_t start_step;
+    double        start_time;
+    float         dt;
+    std::uint32_t stride;
+    std::uint32_t count;
+    std::uint32_t tags;
+};
+
+// RecRollup payload: RollupHeader, {float min, max, mean}[tags]
+struct RollupHeader {
+    std::uint32_t level;
+    std::uint32_t tags;
+    double        t;
+};
+
+struct RewindRecord {
+    std::uint64_t step;
+    double        t;    // time of the first dropped sample
+    float         dt;
+    std::uint32_t reserved;
+};
+
+constexpr float kNaN = std::numeric_limits<float>::quiet_NaN();
+constexpr double kPeriods[3] = {1.0, 60.0, 3600.0};
+
+std::atomic<std::uint64_t> g_histories{0};
+
+// MSB-first bit append, n <= 32
+template<typename Enc>
+inline void putBits(Enc& s, std::uint64_t v, unsigned n) {
+    if (s.fill + n < 64) {
+        s.acc = (s.acc << n) | v;
+        s.fill += n;
+    } else {
+        const unsigned hi = 64 - s.fill;  // bits that still fit in acc
+        const unsigned lo = n - hi;
+        s.words.push_back((s.acc << hi) | (v >> lo));
+        s.acc = lo ? (v & ((std::uint64_t{1} << lo) - 1)) : 0;
+        s.fill = lo;
+    }
+}
+
+// Gorilla XOR encoding on float bits:
+//   '0'                          same as previous
+//   '10' + meaningful bits       fits the previous leading/trailing window
+//   '11' + lead(5) + len-1(5) + meaningful bits
+template<typename Enc>
+inline void encode(Enc& s, std::uint32_t bits, bool first) {
+    if (first) {
+        putBits(s, bits, 32);
+        s.prev = bits;
+        s.lead = 0xFF;
+        return;
+    }
+    const std::uint32_t x = bits ^ s.prev;
+    s.prev = bits;
+    if (x == 0) {
+        putBits(s, 0, 1);
+        return;
+    }
+    const unsigned lead  = static_cast<unsigned>(std::countl_zero(x));
+    const unsigned trail = static_cast<unsigned>(std::countr_zero(x));
+    if (s.lead != 0xFF && lead >= s.lead && trail >= s.trail) {
+        putBits(s, 0b10, 2);
+        putBits(s, x >> s.trail, 32u - s.lead - s.trail);
+    } else {
+        const unsigned len = 32u - lead - trail;
+        putBits(s, (0b11u << 10) | (lead << 5) | (len - 1), 12);
+        putBits(s, x >> trail, len);
+        s.lead  = static_cast<std::uint8_t>(lead);
+        s.trail = static_cast<std::uint8_t>(trail);
+    }
+}
+
+struct BitReader {
+    const std::uint64_t* w;
+    std::size_t pos{0};
+
+    std::uint64_t get(unsigned n) {  // 1..32
+        const std::size_t idx = pos >> 6;
+        const unsigned off = static_cast<unsigned>(pos & 63);
+        std::uint64_t cur = w[idx] << off;
+        if (off + n > 64)
+            cur |= w[idx + 1] >> (64 - off);
+        pos += n;
+        return cur >> (64 - n);
+    }
+};
+
+// Calls f(i, value) for the first `count` values of one stream
+template<typename F>
+void decode(const std::uint64_t* words, std::uint32_t count, F&& f) {
+    if (count == 0)
+        return;
+    BitReader rd{words};
+    std::uint32_t prev = static_cast<std::uint32_t>(rd.get(32));
+    f(0u, std::bit_cast<float>(prev));
+    unsigned trail = 0, len = 32;
+    for (std::uint32_t i = 1; i < count; ++i) {
+        if (rd.get(1)) {
+            if (rd.get(1)) {
+                const unsigned lead = static_cast<unsigned>(rd.get(5));
+                len   = static_cast<unsigned>(rd.get(5)) + 1;
+                trail = 32 - lead - len;
+            }
+            prev ^= static_cast<std::uint32_t>(rd.get(len) << trail);
+        }
+        f(i, std::bit_cast<float>(prev));
+    }
+}
+
+inline float readValue(const char* p, FieldKind k) {
+    switch (k) {
+    case FieldKind::Bool: { bool b; std::memcpy(&b, p, sizeof b); return b ? 1.0f : 0.0f; }
+    case FieldKind::Int:  { int i;  std::memcpy(&i, p, sizeof i); return static_cast<float>(i); }
+    default:              { float x; std::memcpy(&x, p, sizeof x); return x; }
+    }
+}
+
+double sampleTime(double start, std::uint32_t i, std::uint32_t stride, float dt) {
+    return start + static_cast<double>(i) * stride * static_cast<double>(dt);
+}
+
+// Archives outgrow a 32-bit long (Windows, 32-bit builds)
+std::int64_t tell(std::FILE* f) {
+#ifdef _WIN32
+    return _ftelli64(f);
+#else
+    return static_cast<std::int64_t>(ftello(f));
+#endif
+}
+
+bool seek(std::FILE* f, std::int64_t offset, int origin) {
+#ifdef _WIN32
+    return _fseeki64(f, offset, origin) == 0;
+#else
+    return fseeko(f, static_cast<off_t>(offset), origin) == 0;
+#endif
+}
+
+} // namespace
+
+Historian::Historian(const HistorianConfig& cfg) : cfg_(cfg), history_(++g_histories) {
+    cfg_.sample_every  = std::max(1u, cfg_.sample_every);
+    cfg_.block_samples = std::max(2u, cfg_.block_samples);
+
+    const std::uint32_t keep[3] = {cfg_.keep_seconds, cfg_.keep_minutes, cfg_.keep_hours};
+    for (int i = 0; i < 3; ++i) {
+        levels_[i].period   = kPeriods[i];
+        levels_[i].capacity = keep[i];
+    }
+
+    if (!cfg_.path.empty()) {
+        file_ = std::fopen(cfg_.path.c_str(), "wb");
+        if (!file_) {
+            std::cerr << "Historian: could not write " << cfg_.path << "\n";
+        } else {
+            std::fwrite(kMagic, 1, sizeof kMagic, file_);
+            std::fwrite(&kVersion, sizeof kVersion, 1, file_);
+            const std::uint32_t reserved = 0;
+            std::fwrite(&reserved, sizeof reserved, 1, file_);
+        }
+    }
+}
+
+Historian::~Historian() {
+    if (open_active_)
+        sealBlock();
+    if (file_)
+        std::fclose(file_);
+}
+
+int Historian::addTag(std::string name, entt::registry& r, entt::entity e,
+                      std::string_view component, std::string_view field) {
+    const int tag = bindTag(std::move(name), r, e, component, field);
+    if (tag >= 0)
+        resizeRollups();
+    return tag;
+}
+
+int Historian::bindTag(std::string name, entt::registry& r, entt::entity e,
+                       std::string_view component, std::string_view field) {
+    const ComponentInfo* info = findComponent(component);
+    const FieldInfo* f = info ? info->field(field) : nullptr;
+    void* c = f ? info->get(r, e) : nullptr;
+    if (!c)
+        return -1;
+
+    // A block holds a fixed set of tag streams
+    if (open_active_)
+        sealBlock();
+
+    tags_.push_back({std::move(name), e, info, f});
+    ptr_.push_back(static_cast<const char*>(c) + f->offset);
+    kind_.push_back(f->kind);
+    enc_.emplace_back();
+    return static_cast<int>(tags_.size() - 1);
+}
+
+std::size_t Historian::addDefaultTags(entt::registry& r, const std::unordered_map<std::string, entt::entity>& ids) {
+    static const std::pair<const char*, const char*> defaults[] = {
+        {"Tank", "level"},           {"Pump", "flow"},
+        {"PID", "out"},              {"ValveActuator", "pos"},
+        {"HeatExchanger", "temp"},   {"SteamHeader", "pressure"},
+        {"Boiler", "steam_flow"},    {"ChilledWaterLoop", "supply_temp"},
+        {"SiteKPI", "downtime_s"},     {"SiteKPI", "alarms_per_hour"},
+        {"SiteKPI", "throughput"},
+    };
+
+    std::unordered_map<entt::entity, const std::string*> names;
+    names.reserve(ids.size());
+    for (const auto& [id, e] : ids)
+        names[e] = &id;
+
+    std::size_t added = 0;
+    for (const auto& [comp, field] : defaults) {
+        const ComponentInfo* info = findComponent(comp);
+        const entt::entity* rows = nullptr;
+        const std::size_t n = info->rows(r, rows);
+        for (std::size_t i = 0; i < n; ++i) {
+            const entt::entity e = rows[i];
+            auto it = names.find(e);
+            std::string name = it != names.end() ? *it->second
+                                                 : std::string(comp) + "#" + std::to_string(entt::to_integral(e));
+            name += ".";
+            name += field;
+            added += bindTag(std::move(name), r, e, comp, field) >= 0;
+        }
+    }
+    resizeRollups();
+    return added;
+}
+
+void Historian::rebind(entt::registry& r) {
+    for (std::size_t i = 0; i < tags_.size(); ++i) {
+        const void* c = tags_[i].component->get(r, tags_[i].entity);
+        ptr_[i] = c ? static_cast<const char*>(c) + tags_[i].field->offset : nullptr;
+    }
+}
+
+int Historian::findTag(std::string_view name) const {
+    for (std::size_t i = 0; i < tags_.size(); ++i)
+        if (tags_[i].name == name)
+            return static_cast<int>(i);
+    return -1;
+}
+
+void Historian::resizeRollups() {
+    const std::size_t nt = tags_.size();
+    for (auto& lv : levels_) {
+        const std::size_t old = lv.min.size();
+        if (old != nt && !lv.cells.empty()) {
+            // Re-stride existing rows; the new tags have no history
+            const std::size_t rows = lv.time.size();
+            std::vector<RollupCell> cells(rows * nt, RollupCell{kNaN, kNaN, kNaN});
+            for (std::size_t s = 0; s < rows; ++s)
+                std::copy_n(lv.cells.begin() + s * old, old, cells.begin() + s * nt);
+            lv.cells.swap(cells);
+        }
+        lv.min.resize(nt, std::numeric_limits<float>::infinity());
+        lv.max.resize(nt, -std::numeric_limits<float>::infinity());
+        lv.sum.resize(nt, 0.0);
+        lv.n.resize(nt, 0);
+    }
+}
+
+void Historian::openBlock(std::uint64_t step, double sim_time, float dt) {
+    open_.start_step = step;
+    open_.start_time = sim_time;
+    open_.dt         = dt;
+    open_.stride     = cfg_.sample_every;
+    open_.count      = 0;
+    open_.tags       = static_cast<std::uint32_t>(tags_.size());
+    for (auto& e : enc_) {
+        e.words.clear();
+        e.acc  = 0;
+        e.fill = 0;
+        e.lead = 0xFF;
+    }
+    open_active_ = true;
+}
+
+void Historian::sealBlock() {
+    open_active_ = false;
+    if (open_.count == 0)
+        return;
+
+    Block b;
+    b.start_step = open_.start_step;
+    b.start_time = open_.start_time;
+    b.dt         = open_.dt;
+    b.stride     = open_.stride;
+    b.count      = open_.count;
+    b.tags       = open_.tags;
+    b.offset.resize(b.tags + 1);
+
+    std::size_t total = 0;
+    for (std::uint32_t t = 0; t < b.tags; ++t)
+        total += enc_[t].words.size() + (enc_[t].fill ? 1 : 0);
+    b.words.reserve(total);
+    for (std::uint32_t t = 0; t < b.tags; ++t) {
+        auto& e = enc_[t];
+        b.offset[t] = static_cast<std::uint32_t>(b.words.size());
+        b.words.insert(b.words.end(), e.words.begin(), e.words.end());
+        if (e.fill)
+            b.words.push_back(e.acc << (64 - e.fill));
+    }
+    b.offset[b.tags] = static_cast<std::uint32_t>(b.words.size());
+
+    if (file_) {
+        writeTags();
+        const BlockHeader bh{b.start_step, b.start_time, b.dt, b.stride, b.count, b.tags};
+        const std::size_t off_bytes = b.offset.size() * sizeof(std::uint32_t);
+        const RecordHeader rh{RecBlock, 0, sizeof bh + off_bytes + b.words.size() * sizeof(std::uint64_t)};
+        std::fwrite(&rh, sizeof rh, 1, file_);
+        std::fwrite(&bh, sizeof bh, 1, file_);
+        std::fwrite(b.offset.data(), 1, off_bytes, file_);
+        std::fwrite(b.words.data(), sizeof(std::uint64_t), b.words.size(), file_);
+    }
+
+    sealed_bytes_ += b.words.size() * sizeof(std::uint64_t) + b.offset.size() * sizeof(std::uint32_t);
+    sealed_.push_back(std::move(b));
+    trimRaw();
+}
+
+void Historian::trimRaw() {
+    while (sealed_bytes_ > cfg_.raw_budget_bytes && sealed_.size() > 1) {
+        const Block& b = sealed_.front();
+        sealed_bytes_ -= b.words.size() * sizeof(std::uint64_t) + b.offset.size() * sizeof(std::uint32_t);
+        sealed_.pop_front();
+    }
+}
+
+void Historian::sample(std::uint64_t step, double sim_time, float dt) {
+    if (tags_.empty())
+        return;
+    if (any_sample_ && step <= last_step_)
+        rewind(step, sim_time);
+    if (step % cfg_.sample_every != 0)
+        return;
+
+    if (!open_active_ || step != next_step_ || dt != open_.dt || open_.count == cfg_.block_samples) {
+        if (open_active_)
+            sealBlock();
+        openBlock(step, sim_time, dt);
+    }
+    next_step_  = step + cfg_.sample_every;
+    last_step_  = step;
+    last_dt_    = dt;
+    any_sample_ = true;
+
+    RollupLevel& lv = levels_[0];
+    const double bucket = std::floor(sim_time / lv.period);
+    if (bucket != lv.bucket) {
+        closeBucket(0);
+        lv.bucket = bucket;
+    }
+    lv.dirty = true;
+
+    const bool first = open_.count == 0;
+    const std::size_t nt = tags_.size();
+    float* mn = lv.min.data();
+    float* mx = lv.max.data();
+    double* sm = lv.sum.data();
+    std::uint32_t* cnt = lv.n.data();
+    for (std::size_t i = 0; i < nt; ++i) {
+        const float v = ptr_[i] ? readValue(ptr_[i], kind_[i]) : kNaN;
+        encode(enc_[i], std::bit_cast<std::uint32_t>(v), first);
+        if (v == v) {
+            mn[i] = std::min(mn[i], v);
+            mx[i] = std::max(mx[i], v);
+            sm[i] += v;
+            ++cnt[i];
+        }
+    }
+    ++open_.count;
+    samples_ += nt;
+}
+
+void Historian::closeBucket(std::size_t level) {
+    RollupLevel& lv = levels_[level];
+    if (!lv.dirty)
+        return;
+
+    const std::size_t nt = tags_.size();
+    const double t = lv.bucket * lv.period;
+
+    // Parent bucket first, so a finished parent is emitted before it takes this one
+    RollupLevel* up = level + 1 < 3 ? &levels_[level + 1] : nullptr;
+    if (up) {
+        const double ub = std::floor(t / up->period);
+        if (ub != up->bucket) {
+            closeBucket(level + 1);
+            up->bucket = ub;
+        }
+        up->dirty = true;
+    }
+
+    RollupCell* row = nullptr;
+    if (lv.capacity) {
+        std::uint32_t slot;
+        if (lv.size < lv.capacity) {
+            slot = (lv.head + lv.size) % lv.capacity;
+            ++lv.size;
+        } else {
+            slot = lv.head;
+            lv.head = (lv.head + 1) % lv.capacity;
+        }
+        if (slot >= lv.time.size()) {
+            lv.time.resize(slot + 1);
+            lv.cells.resize((slot + 1) * nt);
+        }
+        lv.time[slot] = t;
+        row = &lv.cells[static_cast<std::size_t>(slot) * nt];
+    }
+
+    std::vector<RollupCell> file_row;
+    if (file_ && !row)
+        file_row.resize(nt);
+    RollupCell* out = row ? row : file_row.data();
+
+    for (std::size_t i = 0; i < nt; ++i) {
+        RollupCell c{kNaN, kNaN, kNaN};
+        if (lv.n[i]) {
+            c.min  = lv.min[i];
+            c.max  = lv.max[i];
+            c.mean = static_cast<float>(lv.sum[i] / lv.n[i]);
+            if (up) {
+                up->min[i] = std::min(up->min[i], c.min);
+                up->max[i] = std::max(up->max[i], c.max);
+                // Sample-weighted: a short (first, rewound) bucket counts for what it holds
+                up->sum[i] += lv.sum[i];
+                up->n[i]   += lv.n[i];
+            }
+        }
+        if (out)
+            out[i] = c;
+        lv.min[i] = std::numeric_limits<float>::infinity();
+        lv.max[i] = -std::numeric_limits<float>::infinity();
+        lv.sum[i] = 0.0;
+        lv.n[i]   = 0;
+    }
+    lv.dirty = false;
+
+    if (file_) {
+        writeTags();
+        const RollupHeader hdr{static_cast<std::uint32_t>(level), static_cast<std::uint32_t>(nt), t};
+        writeRecord(RecRollup, &hdr, sizeof hdr, out, nt * sizeof(RollupCell));
+    }
+}
+
+HistorianMark Historian::mark(std::uint64_t step, double sim_time, float dt) const {
+    HistorianMark m;
+    m.history = history_;
+    m.step = step;
+    m.t    = sim_time;
+    m.dt   = dt;
+    for (std::size_t l = 0; l < 3; ++l) {
+        const RollupLevel& lv = levels_[l];
+        m.levels[l] = {lv.bucket, lv.dirty, lv.min, lv.max, lv.sum, lv.n};
+    }
+    return m;
+}
+
+bool Historian::rewindTo(const HistorianMark& m) {
+    if (m.history != history_)
+        return false;
+    for (const auto& b : m.levels)
+        if (b.n.size() != tags_.size())
+            return false;
+    // Keep samples through m.step; the rewind record names the first one dropped
+    rewind(m.step + 1, m.t + m.dt, &m);
+    return true;
+}
+
+std::size_t HistorianMark::bytes() const {
+    std::size_t total = sizeof(HistorianMark);
+    for (const auto& b : levels)
+        total += b.min.size() * (2 * sizeof(float) + sizeof(double) + sizeof(std::uint32_t));
+    return total;
+}
+
+void Historian::rewind(std::uint64_t step, double sim_time, const HistorianMark* mark) {
+    if (open_active_)
+        sealBlock();
+
+    // Keep samples strictly before `step`
+    while (!sealed_.empty()) {
+        Block& b = sealed_.back();
+        if (b.start_step >= step) {
+            sealed_bytes_ -= b.words.size() * sizeof(std::uint64_t) + b.offset.size() * sizeof(std::uint32_t);
+            sealed_.pop_back();
+            continue;
+        }
+        const std::uint64_t keep = (step - b.start_step + b.stride - 1) / b.stride;
+        b.count = static_cast<std::uint32_t>(std::min<std::uint64_t>(b.count, keep));
+        break;
+    }
+
+    // Rollup buckets from the rewind point on are dropped; the one spanning
+    // it resumes from the mark, or restarts from the replayed samples
+    for (std::size_t l = 0; l < 3; ++l) {
+        RollupLevel& lv = levels_[l];
+        const HistorianMark::Bucket* kept = mark ? &mark->levels[l] : nullptr;
+        const double cutoff = kept && kept->bucket >= 0.0 ? kept->bucket * lv.period
+                                                          : std::floor(sim_time / lv.period) * lv.period;
+        while (lv.size > 0) {
+            const std::uint32_t newest = (lv.head + lv.size - 1) % lv.capacity;
+            if (lv.time[newest] < cutoff)
+                break;
+            --lv.size;
+        }
+        if (kept) {
+            lv.bucket = kept->bucket;
+            lv.dirty  = kept->dirty;
+            lv.min = kept->min;
+            lv.max = kept->max;
+            lv.sum = kept->sum;
+            lv.n   = kept->n;
+            continue;
+        }
+        std::fill(lv.min.begin(), lv.min.end(), std::numeric_limits<float>::infinity());
+        std::fill(lv.max.begin(), lv.max.end(), -std::numeric_limits<float>::infinity());
+        std::fill(lv.sum.begin(), lv.sum.end(), 0.0);
+        std::fill(lv.n.begin(), lv.n.end(), 0u);
+        lv.dirty = false;
+        lv.bucket = -1.0;
+    }
+
+    if (file_) {
+        const RewindRecord rr{step, sim_time, last_dt_, 0};
+        writeRecord(RecRewind, &rr, sizeof rr);
+    }
+    any_sample_ = false;
+}
+
+void Historian::writeRecord(std::uint32_t type, const void* a, std::size_t na, const void* b, std::size_t nb) {
+    const RecordHeader rh{type, 0, na + nb};
+    std::fwrite(&rh, sizeof rh, 1, file_);
+    std::fwrite(a, 1, na, file_);
+    if (nb)
+        std::fwrite(b, 1, nb, file_);
+}
+
+// RecTags payload: u32 first, u32 count, then per tag three u32-length-prefixed
+// strings: name, component, field
+void Historian::writeTags() {
+    if (tags_written_ == tags_.size())
+        return;
+
+    std::vector<char> buf;
+    auto putU32 = [&](std::uint32_t v) {
+        const char* p = reinterpret_cast<const char*>(&v);
+        buf.insert(buf.end(), p, p + sizeof v);
+    };
+    auto putStr = [&](std::string_view s) {
+        putU32(static_cast<std::uint32_t>(s.size()));
+        buf.insert(buf.end(), s.begin(), s.end());
+    };
+
+    putU32(static_cast<std::uint32_t>(tags_written_));
+    putU32(static_cast<std::uint32_t>(tags_.size() - tags_written_));
+    for (std::size_t i = tags_written_; i < tags_.size(); ++i) {
+        putStr(tags_[i].name);
+        putStr(tags_[i].component->name);
+        putStr(tags_[i].field->name);
+    }
+    writeRecord(RecTags, buf.data(), buf.size());
+    tags_written_ = tags_.size();
+}
+
+// Seals the open block too, so a reader sees everything sampled so far
+void Historian::flush() {
+    if (!file_)
+        return;
+    if (open_active_)
+        sealBlock();
+    std::fflush(file_);
+}
+
+void Historian::query(std::size_t tag, double t0, double t1, std::vector<HistSample>& out) const {
+    auto scan = [&](double start, float dt, std::uint32_t stride, std::uint32_t count, const std::uint64_t* words) {
+        if (count == 0 || sampleTime(start, count - 1, stride, dt) < t0 || start >= t1)
+            return;
+        decode(words, count, [&](std::uint32_t i, float v) {
+            const double t = sampleTime(start, i, stride, dt);
+            if (t >= t0 && t < t1)
+                out.push_back({t, v});
+        });
+    };
+
+    for (const auto& b : sealed_)
+        if (tag < b.tags)
+            scan(b.start_time, b.dt, b.stride, b.count, b.words.data() + b.offset[tag]);
+
+    if (open_active_ && tag < open_.tags && open_.count) {
+        const Encoder& e = enc_[tag];
+        std::vector<std::uint64_t> words(e.words);
+        words.push_back(e.fill ? e.acc << (64 - e.fill) : 0);
+        words.push_back(0);
+        scan(open_.start_time, open_.dt, open_.stride, open_.count, words.data());
+    }
+}
+
+void Historian::queryRollup(std::size_t tag, HistResolution res, double t0, double t1,
+                            std::vector<HistRollup>& out) const {
+    if (res == HistResolution::Raw) {
+        std::vector<HistSample> raw;
+        query(tag, t0, t1, raw);
+        for (const auto& s : raw)
+            out.push_back({s.t, s.value, s.value, s.value});
+        return;
+    }
+
+    const RollupLevel& lv = levels_[static_cast<int>(res) - 1];
+    const std::size_t nt = tags_.size();
+    if (tag >= nt)
+        return;
+
+    for (std::uint32_t k = 0; k < lv.size; ++k) {
+        const std::uint32_t slot = (lv.head + k) % lv.capacity;
+        if (lv.time[slot] + lv.period > t0 && lv.time[slot] < t1) {
+            const RollupCell& c = lv.cells[static_cast<std::size_t>(slot) * nt + tag];
+            out.push_back({lv.time[slot], c.min, c.max, c.mean});
+        }
+    }
+
+    // Bucket still filling: provisional point so live trends reach "now"
+    const double open_t = lv.bucket * lv.period;
+    if (lv.dirty && lv.n[tag] && open_t + lv.period > t0 && open_t < t1)
+        out.push_back({open_t, lv.min[tag], lv.max[tag], static_cast<float>(lv.sum[tag] / lv.n[tag])});
+}
+
+HistResolution Historian::pickResolution(double t0, double t1, std::size_t max_points) const {
+    const double span = std::max(0.0, t1 - t0);
+    const double points = static_cast<double>(std::max<std::size_t>(1, max_points));
+
+    const double raw_dt = static_cast<double>(last_dt_) * cfg_.sample_every;
+    const double raw_from = !sealed_.empty() ? sealed_.front().start_time
+                          : open_active_    ? open_.start_time
+                                            : std::numeric_limits<double>::infinity();
+    if (raw_dt > 0.0 && span / raw_dt <= points && t0 >= raw_from)
+        return HistResolution::Raw;
+
+    for (int i = 0; i < 2; ++i) {
+        const RollupLevel& lv = levels_[i];
+        const double from = lv.size ? lv.time[lv.head] : lv.bucket * lv.period;
+        if (span / lv.period <= points && t0 >= from)
+            return static_cast<HistResolution>(i + 1);
+    }
+    return HistResolution::Hour;
+}
+
+void Historian::trend(std::size_t tag, double t0, double t1, std::size_t max_points,
+                      std::vector<HistRollup>& out) const {
+    queryRollup(tag, pickResolution(t0, t1, max_points), t0, t1, out);
+}
+
+std::size_t Historian::memoryBytes() const {
+    std::size_t bytes = sealed_bytes_;
+    for (const auto& e : enc_)
+        bytes += e.words.capacity() * sizeof(std::uint64_t);
+    for (const auto& lv : levels_)
+        bytes += lv.cells.size() * sizeof(RollupCell) + lv.time.size() * sizeof(double) +
+                 lv.min.size() * (2 * sizeof(float) + sizeof(double) + sizeof(std::uint32_t));
+    return bytes;
+}
+
+bool Historian::readFile(const std::string& path, std::string_view tag,
+                         double t0, double t1, std::vector<HistSample>& out) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        std::cerr << "Could not open " << path << "\n";
+        return false;
+    }
+
+    char magic[sizeof kMagic];
+    std::uint32_t version = 0, reserved = 0;
+    if (std::fread(magic, 1, sizeof magic, f) != sizeof magic || std::memcmp(magic, kMagic, sizeof kMagic) != 0 ||
+        std::fread(&version, sizeof version, 1, f) != 1 || std::fread(&reserved, sizeof reserved, 1, f) != 1 ||
+        version != kVersion) {
+        std::cerr << path << ": not a historian file\n";
+        std::fclose(f);
+        return false;
+    }
+
+    long long index = -1;
+    RecordHeader rh;
+    while (std::fread(&rh, sizeof rh, 1, f) == 1) {
+        const std::int64_t payload_end = tell(f) + static_cast<std::int64_t>(rh.bytes);
+
+        if (rh.type == RecTags && index < 0) {
+            std::vector<char> buf(rh.bytes);
+            if (std::fread(buf.data(), 1, buf.size(), f) != buf.size())
+                break;
+            std::size_t at = 0;
+            auto getU32 = [&]() {
+                std::uint32_t v = 0;
+                if (at + sizeof v <= buf.size())
+                    std::memcpy(&v, buf.data() + at, sizeof v);
+                at += sizeof v;
+                return v;
+            };
+            const std::uint32_t first = getU32(), count = getU32();
+            for (std::uint32_t i = 0; i < count && at <= buf.size(); ++i) {
+                std::string_view fields[3];
+                for (auto& s : fields) {
+                    const std::uint32_t len = getU32();
+                    if (at + len > buf.size())
+                        break;
+                    s = std::string_view(buf.data() + at, len);
+                    at += len;
+                }
+                if (fields[0] == tag)
+                    index = first + i;
+            }
+        } else if (rh.type == RecBlock && index >= 0) {
+            BlockHeader bh;
+            if (std::fread(&bh, sizeof bh, 1, f) != 1)
+                break;
+            const double last = sampleTime(bh.start_time, bh.count ? bh.count - 1 : 0, bh.stride, bh.dt);
+            if (index < bh.tags && bh.count && last >= t0 && bh.start_time < t1) {
+                std::uint32_t range[2];
+                if (!seek(f, index * static_cast<std::int64_t>(sizeof(std::uint32_t)), SEEK_CUR) ||
+                    std::fread(range, sizeof(std::uint32_t), 2, f) != 2)
+                    break;
+                const std::int64_t words_at =
+                    tell(f) + (bh.tags - index - 1) * static_cast<std::int64_t>(sizeof(std::uint32_t));
+                // The tag's words must lie inside this record
+                if (range[1] < range[0] ||
+                    words_at + std::int64_t{range[1]} * static_cast<std::int64_t>(sizeof(std::uint64_t)) > payload_end) {
+                    std::cerr << path << ": bad block index\n";
+                    std::fclose(f);
+                    return false;
+                }
+                std::vector<std::uint64_t> words(range[1] - range[0] + 2, 0);
+                if (!seek(f, words_at + std::int64_t{range[0]} * static_cast<std::int64_t>(sizeof(std::uint64_t)), SEEK_SET))
+                    break;
+                if (std::fread(words.data(), sizeof(std::uint64_t), range[1] - range[0], f) != range[1] - range[0])
+                    break;
+                decode(words.data(), bh.count, [&](std::uint32_t i, float v) {
+                    const double t = sampleTime(bh.start_time, i, bh.stride, bh.dt);
+                    if (t >= t0 && t < t1)
+                        out.push_back({t, v});
+                });
+            }
+        } else if (rh.type == RecRewind) {
+            RewindRecord rr;
+            if (std::fread(&rr, sizeof rr, 1, f) != 1)
+                break;
+            const double cut = rr.t - 0.5 * rr.dt;
+            while (!out.empty() && out.back().t >= cut)
+                out.pop_back();
+        }
+        if (!seek(f, payload_end, SEEK_SET))
+            break;
+    }
+
+    std::fclose(f);
+    return index >= 0;
+}
@@ -0,0 +1,189 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <entt/entt.hpp>
+#include "ComponentReflect.hpp"
+
+struct HistorianConfig {
+    std::uint32_t sample_every{1};            // ticks between samples
+    std::uint32_t block_samples{1024};        // samples per compressed block
+    std::size_t   raw_budget_bytes{256u << 20}; // sealed blocks kept in memory
+    std::uint32_t keep_seconds{300};          // rollup points kept per tag,
+    std::uint32_t keep_minutes{720};          // allocated as history accrues
+    std::uint32_t keep_hours{168};
+    std::string   path;                       // streamed to disk when set
+};
+
+struct HistSample {
+    double t;
+    float  value;
+};
+
+struct HistRollup {
+    double t;  // bucket start
+    float  min, max, mean;
+};
+
+enum class HistResolution : std::uint8_t { Raw, Second, Minute, Hour };
+
+// Open rollup buckets as of a step, kept with a checkpoint so a seek resumes
+// them instead of restarting each one from the replayed samples.
+struct HistorianMark {
+    struct Bucket {
+        double bucket{-1.0};
+        bool dirty{false};
+        std::vector<float> min, max;
+        std::vector<double> sum;
+        std::vector<std::uint32_t> n;
+    };
+
+    std::uint64_t history{0};  // Historian it was taken from
+    std::uint64_t step{0};     // sampled through this step
+    double        t{0.0};
+    float         dt{0.0f};
+    Bucket        levels[3];
+
+    std::size_t bytes() const;
+};
+
+// In-process historian. Tags are reflected component fields (Tank::level,
+// Pump::flow, ...) read through cached pointers, so sample() is one pass
+// over flat arrays.
+//
+// Raw samples are stored column-wise: a block covers block_samples ticks and
+// holds one Gorilla-style XOR bit stream per tag (unchanged values cost one
+// bit). Every sample also feeds 1 s / 1 min / 1 h min-max-mean rollups kept
+// in per-level rings, which trend queries over long ranges read instead of
+// decoding raw blocks. With a path set, sealed blocks and rollup rows are
+// appended to a record stream that readFile() (or any tail -f style reader)
+// can consume while the sim is running.
+//
+// Stepping backwards (SimRunner::seek) truncates history at that step; the
+// file gets a rewind record so readers drop what follows it. Buckets open at
+// the rewind point restart empty unless restored from a mark.
+class Historian {
+public:
+    explicit Historian(const HistorianConfig& cfg = {});
+    ~Historian();
+
+    Historian(const Historian&) = delete;
+    Historian& operator=(const Historian&) = delete;
+
+    // Returns the tag index, or -1 if the entity lacks the component/field.
+    int addTag(std::string name, entt::registry& r, entt::entity e,
+               std::string_view component, std::string_view field);
+    // Tank::level, Pump::flow, PID::out, SteamHeader::pressure, ... on every
+    // entity that has them; named "<id>.<field>".
+    std::size_t addDefaultTags(entt::registry& r, const std::unordered_map<std::string, entt::entity>& ids);
+    // Re-resolve cached pointers after storages were rebuilt.
+    void rebind(entt::registry& r);
+
+    void sample(std::uint64_t step, double sim_time, float dt);
+    void flush();
+
+    HistorianMark mark(std::uint64_t step, double sim_time, float dt) const;
+    // Truncate to the mark's step and reopen its buckets. False if the mark is
+    // from another Historian or tags were added since; the next sample then
+    // rewinds without it.
+    bool rewindTo(const HistorianMark& m);
+
+    std::size_t tagCount() const { return tags_.size(); }
+    const std::string& tagName(std::size_t tag) const { return tags_[tag].name; }
+    int findTag(std::string_view name) const;
+
+    void query(std::size_t tag, double t0, double t1, std::vector<HistSample>& out) const;
+    void queryRollup(std::size_t tag, HistResolution res, double t0, double t1, std::vector<HistRollup>& out) const;
+    // Finest resolution that fits [t0, t1] in max_points, for trend plots.
+    HistResolution pickResolution(double t0, double t1, std::size_t max_points) const;
+    void trend(std::size_t tag, double t0, double t1, std::size_t max_points, std::vector<HistRollup>& out) const;
+
+    std::uint64_t samples() const { return samples_; }
+    std::size_t memoryBytes() const;
+
+    static bool readFile(const std::string& path, std::string_view tag,
+                         double t0, double t1, std::vector<HistSample>& out);
+
+private:
+    struct Tag {
+        std::string name;
+        entt::entity entity;
+        const ComponentInfo* component;
+        const FieldInfo* field;
+    };
+
+    struct Encoder {
+        std::uint32_t prev{0};
+        std::uint8_t  lead{0xFF}, trail{0};  // lead 0xFF: no window yet
+        std::uint32_t fill{0};               // bits in acc
+        std::uint64_t acc{0};
+        std::vector<std::uint64_t> words;
+    };
+
+    struct Block {
+        std::uint64_t start_step{0};
+        double        start_time{0.0};
+        float         dt{0.0f};
+        std::uint32_t stride{1};
+        std::uint32_t count{0};
+        std::uint32_t tags{0};
+        std::vector<std::uint32_t> offset;   // word offset per tag, tags + 1 entries
+        std::vector<std::uint64_t> words;
+    };
+
+    struct RollupCell {
+        float min, max, mean;
+    };
+
+    struct RollupLevel {
+        double        period{1.0};
+        std::uint32_t capacity{0};
+        std::uint32_t head{0}, size{0};   // ring over slots, grown up to capacity
+        std::vector<double> time;         // bucket start per slot
+        std::vector<RollupCell> cells;    // slot-major: [slot * tags + tag]
+        // Open bucket, per tag so tags added mid-bucket average correctly
+        double bucket{-1.0};
+        bool dirty{false};
+        std::vector<float> min, max;
+        std::vector<double> sum;
+        std::vector<std::uint32_t> n;
+    };
+
+    int bindTag(std::string name, entt::registry& r, entt::entity e,
+                std::string_view component, std::string_view field);
+    void sealBlock();
+    void openBlock(std::uint64_t step, double sim_time, float dt);
+    void rewind(std::uint64_t step, double sim_time, const HistorianMark* mark = nullptr);
+    void resizeRollups();
+    void closeBucket(std::size_t level);
+    void writeRecord(std::uint32_t type, const void* a, std::size_t na, const void* b = nullptr, std::size_t nb = 0);
+    void writeTags();
+    void trimRaw();
+
+    HistorianConfig cfg_;
+    std::vector<Tag> tags_;
+    std::vector<const char*> ptr_;  // field address per tag
+    std::vector<FieldKind> kind_;
+    std::vector<Encoder> enc_;
+
+    Block open_;
+    bool open_active_{false};
+    std::deque<Block> sealed_;  // oldest first
+    std::size_t sealed_bytes_{0};
+
+    RollupLevel levels_[3];
+    std::uint64_t next_step_{0};
+    std::uint64_t last_step_{0};
+    float last_dt_{0.0f};
+    bool any_sample_{false};
+    std::uint64_t samples_{0};
+
+    std::FILE* file_{nullptr};
+    std::size_t tags_written_{0};
+    std::uint64_t history_{0};
+};
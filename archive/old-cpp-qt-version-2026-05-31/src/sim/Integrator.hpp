@@ -0,0 +1,85 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// How a subsystem advances its state over one step h.
+//
+//   Euler         x += h*f(x), the original scheme. Cheap, but a first-order
+//                 lag is only stable for h < 2*tau, so one fast component
+//                 forces a small dt on the whole plant.
+//   RK4           classic fourth-order Runge-Kutta: far smaller error at the
+//                 same h. A single step amplifies instead of decaying past
+//                 h ~ 2.78*tau, so steps longer than one time constant of the
+//                 local mode are split into substeps (rk4Substeps).
+//   SemiImplicit  linearly implicit (Rosenbrock) Euler, x += h*f / (1 - h*J)
+//                 with J the local df/dx. Unconditionally stable for decaying
+//                 modes, so stiff lags and tank levels survive a large h.
+enum class Integrator : std::uint8_t { Euler, RK4, SemiImplicit };
+
+// Per-domain choice, kept in the registry ctx (absent means Euler throughout,
+// which reproduces the original pipeline bit for bit).
+struct IntegrationConfig {
+  Integrator hydraulics{Integrator::Euler};  // tank levels (FlowNetwork)
+  Integrator thermal{Integrator::Euler};     // HX outlet, boiler steaming, tower basin, chilled-water loop
+};
+
+// Longest RK4 substep in time constants, r = h/tau. At r = 1 one step is
+// within 1% of the exact decay; the cap bounds the work for absurd r.
+constexpr float kRk4MaxR = 1.0f;
+constexpr float kRk4MaxSubsteps = 1024.0f;
+
+inline int rk4Substeps(float r) {
+  return r > kRk4MaxR ? static_cast<int>(std::min(std::ceil(r / kRk4MaxR), kRk4MaxSubsteps)) : 1;
+}
+
+// Fraction of the gap a first-order lag closes in one step, r = h/tau.
+// Exact would be 1 - exp(-r); each method is its own rational/polynomial
+// approximation of that, written out so BatchKernels::hxLag can mirror it.
+inline float lagAlpha(Integrator m, float r) {
+  switch (m) {
+  case Integrator::RK4: {
+    auto step = [](float s) { return s * (1.0f - s * (0.5f - s * (1.0f / 6.0f - s * (1.0f / 24.0f)))); };
+    if (r > 64.0f)
+      return 1.0f;  // e^-64 of the gap left: settled
+    const int n = rk4Substeps(r);
+    if (n == 1)
+      return step(r);
+    // A linear lag composes exactly: n substeps leave (1 - alpha(r/n))^n of the gap
+    const float keep1 = 1.0f - step(r / static_cast<float>(n));
+    float keep = keep1;
+    for (int k = 1; k < n; ++k)
+      keep *= keep1;
+    return 1.0f - keep;
+  }
+  case Integrator::SemiImplicit: return r / (1.0f + r);
+  case Integrator::Euler:        break;
+  }
+  return std::clamp(r, 0.0f, 1.0f);
+}
+
+// One step of dx/dt = f(x). dfdx is the local slope of f (negative for a
+// stable mode), or 0 where x isn't stiff: SemiImplicit divides by it and
+// RK4 sizes its substeps from it.
+template<typename F>
+float advance(Integrator m, float x, float h, F&& f, float dfdx = 0.0f) {
+  switch (m) {
+  case Integrator::RK4: {
+    const int n = rk4Substeps(-h * std::min(0.0f, dfdx));
+    const float hs = h / static_cast<float>(n);
+    for (int k = 0; k < n; ++k) {
+      const float k1 = f(x);
+      const float k2 = f(x + 0.5f * hs * k1);
+      const float k3 = f(x + 0.5f * hs * k2);
+      const float k4 = f(x + hs * k3);
+      x = x + hs * (k1 + 2.0f * k2 + 2.0f * k3 + k4) / 6.0f;
+    }
+    return x;
+  }
+  case Integrator::SemiImplicit:
+    return x + h * f(x) / (1.0f - h * std::min(0.0f, dfdx));
+  case Integrator::Euler:
+    break;
+  }
+  return x + h * f(x);
+}
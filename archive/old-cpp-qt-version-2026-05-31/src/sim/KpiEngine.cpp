@@ -0,0 +1,161 @@
+#include "KpiEngine.hpp"
+#include <algorithm>
+#include <cmath>
+
+P2Quantile::P2Quantile(double p) : p_(std::clamp(p, 0.0, 1.0)) {
+    pos_  = {1.0, 2.0, 3.0, 4.0, 5.0};
+    want_ = {1.0, 1.0 + 2.0 * p_, 1.0 + 4.0 * p_, 3.0 + 2.0 * p_, 5.0};
+    inc_  = {0.0, p_ / 2.0, p_, (1.0 + p_) / 2.0, 1.0};
+}
+
+void P2Quantile::add(double x) {
+    if (n_ < 5) {
+        q_[n_++] = x;
+        if (n_ == 5)
+            std::sort(q_.begin(), q_.end());
+        return;
+    }
+    ++n_;
+
+    // Cell the sample falls in; extremes stretch the end markers
+    int k;
+    if (x < q_[0]) {
+        q_[0] = x;
+        k = 0;
+    } else if (x >= q_[4]) {
+        q_[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while (k < 3 && x >= q_[k + 1])
+            ++k;
+    }
+    for (int i = k + 1; i < 5; ++i)
+        pos_[i] += 1.0;
+    for (int i = 0; i < 5; ++i)
+        want_[i] += inc_[i];
+
+    // Nudge the middle markers towards their desired positions
+    for (int i = 1; i < 4; ++i) {
+        const double d = want_[i] - pos_[i];
+        if ((d >= 1.0 && pos_[i + 1] - pos_[i] > 1.0) || (d <= -1.0 && pos_[i - 1] - pos_[i] < -1.0)) {
+            const double s = d > 0.0 ? 1.0 : -1.0;
+            const double parabolic = q_[i] + s / (pos_[i + 1] - pos_[i - 1]) *
+                ((pos_[i] - pos_[i - 1] + s) * (q_[i + 1] - q_[i]) / (pos_[i + 1] - pos_[i]) +
+                 (pos_[i + 1] - pos_[i] - s) * (q_[i] - q_[i - 1]) / (pos_[i] - pos_[i - 1]));
+            if (q_[i - 1] < parabolic && parabolic < q_[i + 1]) {
+                q_[i] = parabolic;
+            } else {
+                const int j = i + static_cast<int>(s);
+                q_[i] += s * (q_[j] - q_[i]) / (pos_[j] - pos_[i]);
+            }
+            pos_[i] += s;
+        }
+    }
+}
+
+double P2Quantile::value() const {
+    if (n_ >= 5)
+        return q_[2];
+    if (n_ == 0)
+        return 0.0;
+    // Too few samples for the markers: exact quantile of what we have
+    std::array<double, 5> s = q_;
+    std::sort(s.begin(), s.begin() + n_);
+    const double at = p_ * static_cast<double>(n_ - 1);
+    const auto lo = static_cast<std::size_t>(at);
+    const auto hi = std::min<std::size_t>(lo + 1, n_ - 1);
+    return s[lo] + (at - static_cast<double>(lo)) * (s[hi] - s[lo]);
+}
+
+SlidingWindow::SlidingWindow(std::size_t buckets, double width_s)
+    : buckets_(std::max<std::size_t>(1, buckets)), width_(std::max(1e-3, width_s)),
+      ring_(2 * buckets_, 0.0) {}
+
+void SlidingWindow::advance(double now_s) {
+    const auto target = static_cast<std::int64_t>(std::floor(now_s / width_));
+    if (target <= current_)
+        return;
+
+    const auto n = static_cast<std::int64_t>(buckets_);
+    if (target - current_ >= 2 * n) {
+        std::fill(ring_.begin(), ring_.end(), 0.0);
+        recent_ = previous_ = 0.0;
+        current_ = target;
+        return;
+    }
+
+    const auto size = static_cast<std::int64_t>(ring_.size());
+    while (current_ < target) {
+        ++current_;
+        // The slot the new bucket reuses held the oldest bucket of `previous`
+        double& oldest = ring_[static_cast<std::size_t>(current_ % size)];
+        previous_ -= oldest;
+        oldest = 0.0;
+        // and the bucket that just aged past the recent window moves over
+        // (before the first full window that slot is still empty)
+        const double aged = current_ >= n ? ring_[static_cast<std::size_t>((current_ - n) % size)] : 0.0;
+        recent_   -= aged;
+        previous_ += aged;
+    }
+}
+
+void SlidingWindow::add(double now_s, double v) {
+    advance(now_s);
+    ring_[static_cast<std::size_t>(current_ % static_cast<std::int64_t>(ring_.size()))] += v;
+    recent_ += v;
+}
+
+namespace {
+double bucketWidth(const KpiConfig& cfg) {
+    return cfg.window_s / static_cast<double>(std::max<std::size_t>(1, cfg.buckets));
+}
+}
+
+KpiEngine::KpiEngine(const KpiConfig& cfg)
+    : cfg_(cfg),
+      raised_(cfg.buckets, bucketWidth(cfg)),
+      downtime_(cfg.buckets, bucketWidth(cfg)),
+      flow_(cfg.buckets, bucketWidth(cfg)),
+      covered_(cfg.buckets, bucketWidth(cfg)) {}
+
+std::size_t KpiEngine::bytes() const {
+    return sizeof(*this) + raised_.bytes() + downtime_.bytes() + flow_.bytes() + covered_.bytes()
+         - 4 * sizeof(SlidingWindow);
+}
+
+void KpiEngine::acknowledged(float seconds) {
+    ack_median_.add(seconds);
+}
+
+void KpiEngine::repaired(float seconds) {
+    repair_median_.add(seconds);
+    repair_sum_s_ += seconds;
+}
+
+void KpiEngine::update(SiteKPI& kpi, float throughput, float dt) {
+    // Attribute this tick to the bucket it started in
+    raised_.add(now_, static_cast<double>(kpi.alarms_raised - last_raised_));
+    downtime_.add(now_, static_cast<double>(kpi.downtime_s - last_downtime_s_));
+    flow_.add(now_, static_cast<double>(throughput) * dt);
+    covered_.add(now_, dt);
+    last_raised_     = kpi.alarms_raised;
+    last_downtime_s_ = kpi.downtime_s;
+    now_ += dt;
+
+    // Rates over what the window has seen so far, but at least one bucket
+    // so the first alarm doesn't read as thousands per hour
+    const double seen = std::max(covered_.recent(), bucketWidth(cfg_));
+    kpi.alarms_per_hour   = static_cast<float>(raised_.recent() * 3600.0 / seen);
+    kpi.downtime_min_hour = static_cast<float>(downtime_.recent() / 60.0);
+
+    kpi.median_ack_s    = static_cast<float>(ack_median_.value());
+    kpi.median_repair_s = static_cast<float>(repair_median_.value());
+    kpi.mttr_s = repair_median_.count()
+        ? static_cast<float>(repair_sum_s_ / static_cast<double>(repair_median_.count())) : 0.0f;
+
+    const double mean = covered_.recent() > 0.0 ? flow_.recent() / covered_.recent() : 0.0;
+    kpi.throughput = static_cast<float>(mean);
+    kpi.throughput_delta = covered_.previous() > 0.0
+        ? static_cast<float>(mean - flow_.previous() / covered_.previous()) : 0.0f;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Components.hpp"
+
+// Streaming KPI estimators. Every update is O(1) and nothing grows with run
+// length, so AnalyticsSystem keeps the KPIs current each tick and a query
+// (or a Monte Carlo replica reading SiteKPI at the end) never rescans history.
+
+// P² quantile estimate (Jain & Chlamtac, 1985): five markers, no samples kept.
+class P2Quantile {
+public:
+    explicit P2Quantile(double p = 0.5);
+
+    void add(double x);
+    double value() const;
+    std::uint64_t count() const { return n_; }
+
+private:
+    double p_;
+    std::uint64_t n_{0};
+    std::array<double, 5> q_{};     // marker heights (the first five samples until n_ == 5)
+    std::array<double, 5> pos_{};   // actual marker positions, 1-based
+    std::array<double, 5> want_{};  // desired positions
+    std::array<double, 5> inc_{};   // desired position step per sample
+};
+
+// Time-bucketed sliding sum over the last `buckets` buckets, plus the sum of
+// the window before it (for period-over-period deltas). Buckets are retired
+// as time moves past them, never rescanned.
+class SlidingWindow {
+public:
+    SlidingWindow(std::size_t buckets, double width_s);
+
+    void add(double now_s, double v);
+    void advance(double now_s);
+
+    double recent() const { return recent_; }
+    double previous() const { return previous_; }
+    double span() const { return width_ * static_cast<double>(buckets_); }
+    std::size_t bytes() const { return sizeof(*this) + ring_.size() * sizeof(double); }
+
+private:
+    std::size_t buckets_;
+    double width_;
+    std::vector<double> ring_;  // 2 * buckets_, slot = bucket % size
+    std::int64_t current_{0};   // absolute index of the newest bucket
+    double recent_{0.0};
+    double previous_{0.0};
+};
+
+struct KpiConfig {
+    double window_s{3600.0};     // alarms/hour, downtime and throughput windows
+    std::size_t buckets{60};     // 1 min resolution at the default window
+};
+
+// Lives in the registry context. ResponseSystem reports ack and repair
+// durations as they happen; AnalyticsSystem advances the windows once per
+// tick from SiteKPI's counters and publishes the result back into SiteKPI.
+class KpiEngine {
+public:
+    explicit KpiEngine(const KpiConfig& cfg = {});
+
+    void acknowledged(float seconds);  // raise → ack
+    void repaired(float seconds);      // raise → cleared
+
+    // kpi carries the running counters; throughput is this tick's total.
+    void update(SiteKPI& kpi, float throughput, float dt);
+
+    double now() const { return now_; }
+    std::size_t bytes() const;
+
+private:
+    KpiConfig cfg_;
+    double now_{0.0};
+
+    int last_raised_{0};
+    float last_downtime_s_{0.0f};
+
+    SlidingWindow raised_;
+    SlidingWindow downtime_;
+    SlidingWindow flow_;     // ∫ throughput dt
+    SlidingWindow covered_;  // ∫ dt, so partial windows average correctly
+
+    P2Quantile ack_median_{0.5};
+    P2Quantile repair_median_{0.5};
+    double repair_sum_s_{0.0};
+};
@@ -1,64 +1,209 @@
 #include "Loader.hpp"
+#include "ComponentReflect.hpp"
 #include "Components.hpp"
-#include <fstream>
-#include <nlohmann/json.hpp>
+#include <cstdio>
 #include <iostream>
+#include <string_view>
+#include <unordered_set>
+#include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
 
-bool Loader::loadPlant(const std::string& path,
-                       entt::registry& reg,
-                       std::unordered_map<std::string, entt::entity>& entityFromId)
+namespace {
+
+// Walks {"components":[{id,type,params{},outputs[],attach{Type{}}}, ...]}
+// and skips anything else (e.g. "connections") without materialising it.
+class PlantSax : public nlohmann::json_sax<json> {
+public:
+    explicit PlantSax(PlantDescription& out) : out_(out) {}
+
+    bool null() override                                  { return scalar(nullptr, 0.0, false); }
+    bool boolean(bool v) override                         { return scalar(nullptr, v ? 1.0 : 0.0, true); }
+    bool number_integer(number_integer_t v) override      { return scalar(nullptr, static_cast<double>(v), false); }
+    bool number_unsigned(number_unsigned_t v) override    { return scalar(nullptr, static_cast<double>(v), false); }
+    bool number_float(number_float_t v, const string_t&) override { return scalar(nullptr, v, false); }
+    bool string(string_t& v) override                     { return scalar(&v, 0.0, false); }
+    bool binary(binary_t&) override                       { return true; }
+
+    bool key(string_t& k) override {
+        key_ = std::move(k);
+        return true;
+    }
+
+    bool start_object(std::size_t) override {
+        Ctx next = Ctx::Skip;
+        switch (top()) {
+        case Ctx::None:       next = Ctx::Root; break;
+        case Ctx::Components: next = Ctx::Component; out_.components.emplace_back(); break;
+        case Ctx::Component:
+            if (key_ == "params")      next = Ctx::Params;
+            else if (key_ == "attach") next = Ctx::Attach;
+            break;
+        case Ctx::Attach:
+            next = Ctx::AttachParams;
+            current().attach.push_back({key_, {}});
+            break;
+        default: break;
+        }
+        stack_.push_back(next);
+        return true;
+    }
+
+    bool end_object() override { stack_.pop_back(); return true; }
+
+    bool start_array(std::size_t) override {
+        Ctx next = Ctx::Skip;
+        if (top() == Ctx::Root && key_ == "components") {
+            next = Ctx::Components;
+            saw_components_ = true;
+        }
+        else if (top() == Ctx::Component && key_ == "outputs")
+            next = Ctx::Outputs;
+        stack_.push_back(next);
+        return true;
+    }
+
+    bool sawComponents() const { return saw_components_; }
+
+    bool end_array() override { stack_.pop_back(); return true; }
+
+    bool parse_error(std::size_t pos, const std::string&, const nlohmann::detail::exception& ex) override {
+        std::cerr << "Plant JSON error at byte " << pos << ": " << ex.what() << "\n";
+        return false;
+    }
+
+private:
+    enum class Ctx { None, Root, Components, Component, Params, Attach, AttachParams, Outputs, Skip };
+
+    Ctx top() const { return stack_.empty() ? Ctx::None : stack_.back(); }
+    ComponentSpec& current() { return out_.components.back(); }
+
+    // Strings matter for id/type/outputs and the few string params; numbers
+    // and bools for params.
+    bool scalar(string_t* s, double v, bool is_bool) {
+        switch (top()) {
+        case Ctx::Component:
+            if (s && key_ == "id")        current().id = std::move(*s);
+            else if (s && key_ == "type") current().type = std::move(*s);
+            break;
+        case Ctx::Params:
+            current().params.push_back({key_, v, is_bool, s ? std::move(*s) : std::string{}});
+            break;
+        case Ctx::AttachParams:
+            current().attach.back().params.push_back({key_, v, is_bool, s ? std::move(*s) : std::string{}});
+            break;
+        case Ctx::Outputs:
+            if (s) current().outputs.push_back(std::move(*s));
+            break;
+        default: break;
+        }
+        return true;
+    }
+
+    PlantDescription& out_;
+    std::vector<Ctx> stack_;
+    std::string key_;
+    bool saw_components_{false};
+};
+
+// File type names that predate the component structs
+const ComponentInfo* componentForType(std::string_view type) {
+    if (type == "Valve")
+        return findComponent("ValveActuator");
+    return findComponent(type);
+}
+
+void applyParams(void* comp, const ComponentInfo& info, const std::vector<ParamValue>& params) {
+    for (const auto& p : params) {
+        if (!p.text.empty()) {
+            // Alarmable "source": "Component.field" → source_component/source_field
+            if (info.index == componentIndex<Alarmable>() && p.key == "source") {
+                auto* a = static_cast<Alarmable*>(comp);
+                if (!findFieldRef(p.text, a->source_component, a->source_field))
+                    std::cerr << "Unknown alarm source " << p.text << "\n";
+            }
+            continue;
+        }
+        if (const FieldInfo* f = info.field(p.key))
+            writeField(comp, *f, p.value);
+    }
+}
+
+} // namespace
+
+bool Loader::parsePlant(const std::string& path, PlantDescription& out)
 {
-    std::ifstream in(path);
-    if (!in.is_open()) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
         std::cerr << "Could not open " << path << "\n";
         return false;
     }
 
-    json j;
-    in >> j;
-    if (!j.contains("components"))
-        return false;
+    out.components.clear();
+    PlantSax sax(out);
+    const bool ok = json::sax_parse(f, &sax) && sax.sawComponents();
+    std::fclose(f);
+    return ok;
+}
 
-    for (auto& c : j["components"])
-    {
-        std::string id   = c.value("id", "");
-        std::string type = c.value("type", "");
+bool Loader::buildPlant(const PlantDescription& plant,
+                        entt::registry& reg,
+                        std::unordered_map<std::string, entt::entity>& entityFromId)
+{
+    std::unordered_set<std::string> unknown;
+    auto resolve = [&](const std::string& type) -> const ComponentInfo* {
+        const ComponentInfo* info = componentForType(type);
+        if (!info && unknown.insert(type).second)
+            std::cerr << "Unknown component type " << type << "\n";
+        return info;
+    };
 
+    entityFromId.reserve(entityFromId.size() + plant.components.size());
+    std::vector<entt::entity> created;
+    created.reserve(plant.components.size());
+
+    for (const auto& c : plant.components)
+    {
         // Create ECS entity
         entt::entity e = reg.create();
+        created.push_back(e);
 
         // Store mapping id → entity
-        if (!id.empty())
-            entityFromId[id] = e;
+        if (!c.id.empty())
+            entityFromId[c.id] = e;
 
-        auto& params = c["params"];
+        if (const ComponentInfo* info = resolve(c.type))
+            applyParams(info->emplace(reg, e), *info, c.params);
 
-        if (type == "Pump") {
-            reg.emplace<Pump>(e,
-                              params.value("running",    true),
-                              params.value("dp_nominal", 1.8f),
-                              0.0f);
-        }
-        else if (type == "Tank") {
-            reg.emplace<Tank>(e,
-                              params.value("level", 0.3f),
-                              params.value("area",  2.0f),
-                              0.f, 0.f);
-        }
-        else if (type == "HeatExchanger") {
-            reg.emplace<HeatExchanger>(e,
-                                       params.value("power_on",            true),
-                                       params.value("comp_inlet_stream",   1.0f),
-                                       params.value("comp_outlet_stream",  1.0f),
-                                       params.value("flow_rate",           1.0f),
-                                       params.value("tau_s",               5.0f),
-                                       params.value("temp",                70.0f),
-                                       params.value("pressure",            1.0f));
+        for (const auto& a : c.attach)
+            if (const ComponentInfo* info = resolve(a.type))
+                applyParams(info->emplace(reg, e), *info, a.params);
+    }
+
+    // Outputs may name components declared later in the file
+    auto& topo = reg.ctx().emplace<PlantTopology>();
+    for (std::size_t i = 0; i < plant.components.size(); ++i)
+    {
+        const auto& c = plant.components[i];
+        for (const auto& out : c.outputs) {
+            auto to = entityFromId.find(out);
+            if (to == entityFromId.end()) {
+                std::cerr << "Unknown output " << out << " on " << c.id << "\n";
+                continue;
+            }
+            topo.edges.emplace_back(created[i], to->second);
         }
     }
 
     return true;
 }
 
+bool Loader::loadPlant(const std::string& path,
+                       entt::registry& reg,
+                       std::unordered_map<std::string, entt::entity>& entityFromId)
+{
+    PlantDescription plant;
+    if (!parsePlant(path, plant))
+        return false;
+    return buildPlant(plant, reg, entityFromId);
+}
@@ -1,14 +1,58 @@
 #pragma once
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include <entt/entt.hpp>
 
+// Directed links from the JSON `outputs` arrays, kept in the registry context
+// so FlowNetwork::compile can build the hydraulic graph.
+struct PlantTopology {
+    std::vector<std::pair<entt::entity, entt::entity>> edges;
+};
+
+// Qt-free result of one parse of a plant file. Both the ECS (Loader::buildPlant)
+// and the UI model (PlantModel::loadFromDescription) are built from it, so the
+// file is only read once.
+struct ParamValue {
+    std::string key;
+    double value{0.0};
+    bool   is_bool{false};
+    std::string text;  // string params (field references such as "Tank.level")
+};
+
+struct AttachedComponent {
+    std::string type;
+    std::vector<ParamValue> params;
+};
+
+struct ComponentSpec {
+    std::string id;
+    std::string type;
+    std::vector<ParamValue> params;        // fields of `type`, in file order
+    std::vector<std::string> outputs;
+    std::vector<AttachedComponent> attach; // extra components on the same entity
+};
+
+struct PlantDescription {
+    std::vector<ComponentSpec> components;
+};
 
 struct Loader {
+    // Streaming (SAX) parse; never builds a JSON DOM.
+    static bool parsePlant(const std::string& path, PlantDescription& out);
+
+    // Creates one entity per spec. `type` and every `attach` key name a struct
+    // in Components.hpp (see ComponentReflect.hpp); params set matching fields.
+    static bool buildPlant(
+        const PlantDescription& plant,
+        entt::registry& reg,
+        std::unordered_map<std::string, entt::entity>& entityFromId
+        );
+
     static bool loadPlant(
         const std::string& path,
         entt::registry& reg,
         std::unordered_map<std::string, entt::entity>& entityFromId
         );
 };
-
@@ -0,0 +1,136 @@
+#include "MonteCarlo.hpp"
+#include "PlantImage.hpp"
+#include "SimRunner.hpp"
+#include "WorkPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+std::uint64_t MonteCarlo::replicaSeed(std::uint64_t base, std::size_t index) {
+    // Hash (base, index) so neighbouring replicas get uncorrelated streams
+    SplitMix64 mix(base ^ (0xD1B54A32D192ED03ull * (static_cast<std::uint64_t>(index) + 1)));
+    return mix.next();
+}
+
+ReplicaResult MonteCarlo::runReplica(const MonteCarloConfig& cfg, std::size_t index,
+                                     const PlantDescription* plant) {
+    ReplicaResult res;
+    res.index = index;
+    res.seed  = replicaSeed(cfg.seed, index);
+
+    // Draw in a fixed order so results only depend on the seed
+    SplitMix64 rng(res.seed);
+    res.hf.training           = rng.uniform(cfg.training.lo, cfg.training.hi);
+    res.hf.fatigue            = rng.uniform(cfg.fatigue.lo, cfg.fatigue.hi);
+    res.hf.shift_length_hours = rng.uniform(cfg.shift_length_hours.lo, cfg.shift_length_hours.hi);
+    res.hf.staff_on_shift     = rng.uniformInt(cfg.staff_min, std::max(cfg.staff_min, cfg.staff_max));
+    res.ack_delay_target_s    = rng.uniform(cfg.ack_delay_target_s.lo, cfg.ack_delay_target_s.hi);
+    res.repair_time_target_s  = rng.uniform(cfg.repair_time_target_s.lo, cfg.repair_time_target_s.hi);
+
+    SimRunner sim(cfg.dt);
+    const bool loaded = plant ? sim.loadDefaultScenario(*plant) : sim.loadDefaultScenario(cfg.plant_path);
+    if (!loaded) {
+        res.failed = true;
+        return res;
+    }
+
+    auto& r = sim.reg();
+    for (auto e : r.view<HumanFactors>())
+        r.get<HumanFactors>(e) = res.hf;
+
+    // Only the sampled targets: the plant's own response settings and any
+    // state it was built with stay as they are
+    for (auto e : r.view<Alarmable>()) {
+        if (!r.all_of<AlarmResponse>(e))
+            r.emplace<AlarmResponse>(e);
+        auto& ar = r.get<AlarmResponse>(e);
+        ar.ack_delay_target_s   = res.ack_delay_target_s;
+        ar.repair_time_target_s = res.repair_time_target_s;
+    }
+    sim.compileAlarms();
+    sim.preallocate();
+
+    sim.run_until(cfg.horizon_s);
+
+    if (auto kpis = r.view<SiteKPI>(); !kpis.empty())
+        res.kpi = kpis.get<SiteKPI>(*kpis.begin());
+    return res;
+}
+
+KpiStats MonteCarlo::summarize(std::vector<double> samples) {
+    KpiStats s;
+    if (samples.empty())
+        return s;
+
+    std::sort(samples.begin(), samples.end());
+    const double n = static_cast<double>(samples.size());
+
+    double sum = 0.0;
+    for (double x : samples) sum += x;
+    s.mean = sum / n;
+
+    double ss = 0.0;
+    for (double x : samples) ss += (x - s.mean) * (x - s.mean);
+    s.stddev = samples.size() > 1 ? std::sqrt(ss / (n - 1.0)) : 0.0;
+
+    // Normal approximation; replica counts are large enough for it
+    const double half = 1.96 * s.stddev / std::sqrt(n);
+    s.ci95_lo = s.mean - half;
+    s.ci95_hi = s.mean + half;
+
+    auto pct = [&](double p) {
+        const double pos = p * (n - 1.0);
+        const auto lo = static_cast<std::size_t>(std::floor(pos));
+        const auto hi = std::min(lo + 1, samples.size() - 1);
+        return samples[lo] + (pos - static_cast<double>(lo)) * (samples[hi] - samples[lo]);
+    };
+    s.p05 = pct(0.05);
+    s.p50 = pct(0.50);
+    s.p95 = pct(0.95);
+    s.min = samples.front();
+    s.max = samples.back();
+    return s;
+}
+
+MonteCarloReport MonteCarlo::run(const MonteCarloConfig& cfg) {
+    MonteCarloReport report;
+    report.replicas.resize(cfg.replicas);
+
+    const auto t0 = std::chrono::steady_clock::now();
+
+    // Parse once; every replica builds its registry from the same description.
+    // Binary images are mapped per replica instead, which is already cheap.
+    PlantDescription plant;
+    const bool parsed = !PlantImage::isImage(cfg.plant_path) && Loader::parsePlant(cfg.plant_path, plant);
+    {
+        // One task per replica; replicas vary in cost so stealing keeps cores busy
+        WorkPool pool(cfg.threads);
+        pool.parallel_for(cfg.replicas, [&](std::size_t i) {
+            report.replicas[i] = runReplica(cfg, i, parsed ? &plant : nullptr);
+        });
+    }
+    report.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    for (const auto& rr : report.replicas)
+        report.failed += rr.failed;
+
+    // A replica that never ran has all-zero KPIs; averaging those in would
+    // pull every statistic toward zero
+    auto across = [&](auto field) {
+        std::vector<double> xs;
+        xs.reserve(report.replicas.size());
+        for (const auto& rr : report.replicas)
+            if (!rr.failed)
+                xs.push_back(static_cast<double>(rr.kpi.*field));
+        return summarize(std::move(xs));
+    };
+    report.alarms_raised    = across(&SiteKPI::alarms_raised);
+    report.downtime_s       = across(&SiteKPI::downtime_s);
+    report.alarms_per_hour  = across(&SiteKPI::alarms_per_hour);
+    report.median_ack_s     = across(&SiteKPI::median_ack_s);
+    report.mttr_s           = across(&SiteKPI::mttr_s);
+    report.throughput_delta = across(&SiteKPI::throughput_delta);
+    report.alarms_per_10min = across(&SiteKPI::alarms_per_10min);
+    report.flood_pct        = across(&SiteKPI::flood_pct);
+    return report;
+}
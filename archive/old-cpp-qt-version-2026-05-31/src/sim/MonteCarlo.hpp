@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Components.hpp"
+#include "Loader.hpp"
+
+// Monte Carlo scenario engine: runs independent registry replicas with
+// sampled HumanFactors / AlarmResponse targets and aggregates SiteKPI
+// into percentile and confidence bands.
+
+// Small deterministic RNG (splitmix64) so a replica reproduces from its seed
+// regardless of the standard library's distribution implementations.
+struct SplitMix64 {
+  std::uint64_t state;
+
+  explicit SplitMix64(std::uint64_t seed) : state(seed) {}
+
+  std::uint64_t next() {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+  double uniform() { return static_cast<double>(next() >> 11) * 0x1.0p-53; } // [0,1)
+  float uniform(float lo, float hi) { return lo + static_cast<float>(uniform()) * (hi - lo); }
+  int uniformInt(int lo, int hi) { return lo + static_cast<int>(next() % static_cast<std::uint64_t>(hi - lo + 1)); }
+};
+
+struct SampleRange {
+  float lo{0.f};
+  float hi{0.f};
+};
+
+struct MonteCarloConfig {
+  std::string plant_path{"plant_default.json"};
+  std::size_t replicas{1000};
+  double horizon_s{8.0 * 3600.0};
+  float dt{0.1f};
+  std::uint64_t seed{12345};
+  unsigned threads{0};            // 0 = all cores
+
+  // HumanFactors sampling
+  SampleRange training{0.6f, 0.8f};
+  SampleRange fatigue{0.1f, 0.5f};
+  SampleRange shift_length_hours{8.f, 12.f};
+  int staff_min{2};
+  int staff_max{5};
+
+  // AlarmResponse targets (applied to every Alarmable entity)
+  SampleRange ack_delay_target_s{30.f, 120.f};
+  SampleRange repair_time_target_s{300.f, 1800.f};
+};
+
+struct ReplicaResult {
+  std::size_t index{0};
+  std::uint64_t seed{0};
+  HumanFactors hf;
+  float ack_delay_target_s{0.f};
+  float repair_time_target_s{0.f};
+  SiteKPI kpi;
+  bool failed{false};             // plant didn't load; left out of the stats
+};
+
+struct KpiStats {
+  double mean{0}, stddev{0};
+  double ci95_lo{0}, ci95_hi{0};  // confidence interval of the mean
+  double p05{0}, p50{0}, p95{0};  // spread across replicas
+  double min{0}, max{0};
+};
+
+struct MonteCarloReport {
+  std::vector<ReplicaResult> replicas;  // ordered by replica index
+  std::size_t failed{0};                // replicas excluded from the stats
+  KpiStats alarms_raised;
+  KpiStats downtime_s;
+  KpiStats alarms_per_hour;   // rolling KPIs as of the end of each replica
+  KpiStats median_ack_s;
+  KpiStats mttr_s;
+  KpiStats throughput_delta;
+  KpiStats alarms_per_10min;  // ISA-18.2 rate and flood share (AlarmMetrics)
+  KpiStats flood_pct;
+  double wall_s{0};
+};
+
+struct MonteCarlo {
+  static MonteCarloReport run(const MonteCarloConfig& cfg);
+  // plant == nullptr parses cfg.plant_path; run() parses once and shares it.
+  static ReplicaResult runReplica(const MonteCarloConfig& cfg, std::size_t index,
+                                  const PlantDescription* plant = nullptr);
+
+  static std::uint64_t replicaSeed(std::uint64_t base, std::size_t index);
+  static KpiStats summarize(std::vector<double> samples);
+};
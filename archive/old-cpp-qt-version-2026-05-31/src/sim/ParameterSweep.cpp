@@ -0,0 +1,412 @@
+#include "ParameterSweep.hpp"
+#include "ComponentReflect.hpp"
+#include "Checkpoint.hpp"
+#include "PlantImage.hpp"
+#include "SimRunner.hpp"
+#include "SiteContext.hpp"
+#include "WorkPool.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+
+namespace {
+
+// Sobol sequence after Bratley & Fox with Joe & Kuo's direction numbers
+// (new-joe-kuo-6.21201), gray-code order, the all-zero first point skipped.
+// 21 dimensions cover Saltelli's 2k for up to 10 parameters.
+class SobolSequence {
+public:
+    static constexpr unsigned kMaxDims = 21;
+
+    explicit SobolSequence(unsigned dims) : v_(dims), x_(dims, 0) {
+        struct Poly { unsigned s, a; std::array<std::uint32_t, 7> m; };
+        static constexpr Poly kPolys[kMaxDims - 1] = {
+            {1, 0, {1}},                        {2, 1, {1, 3}},
+            {3, 1, {1, 3, 1}},                  {3, 2, {1, 1, 1}},
+            {4, 1, {1, 1, 3, 3}},               {4, 4, {1, 3, 5, 13}},
+            {5, 2, {1, 1, 5, 5, 17}},           {5, 4, {1, 1, 5, 5, 5}},
+            {5, 7, {1, 1, 7, 11, 19}},          {5, 11, {1, 1, 5, 1, 1}},
+            {5, 13, {1, 1, 1, 3, 11}},          {5, 14, {1, 3, 5, 5, 31}},
+            {6, 1, {1, 3, 3, 9, 7, 49}},        {6, 13, {1, 1, 1, 15, 21, 21}},
+            {6, 16, {1, 3, 1, 13, 27, 49}},     {6, 19, {1, 1, 1, 15, 7, 5}},
+            {6, 22, {1, 3, 1, 15, 13, 25}},     {6, 25, {1, 1, 5, 5, 19, 61}},
+            {7, 1, {1, 3, 7, 11, 23, 15, 103}}, {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+        };
+        for (unsigned i = 0; i < 32; ++i)
+            v_[0][i] = 1u << (31 - i);
+        for (unsigned d = 1; d < dims; ++d) {
+            const Poly& p = kPolys[d - 1];
+            auto& v = v_[d];
+            for (unsigned i = 0; i < 32; ++i) {
+                if (i < p.s) {
+                    v[i] = p.m[i] << (31 - i);
+                    continue;
+                }
+                v[i] = v[i - p.s] ^ (v[i - p.s] >> p.s);
+                for (unsigned k = 1; k < p.s; ++k)
+                    if ((p.a >> (p.s - 1 - k)) & 1u)
+                        v[i] ^= v[i - k];
+            }
+        }
+    }
+
+    void next(double* out) {
+        unsigned c = 0;
+        for (std::uint64_t n = index_++; n & 1u; n >>= 1)
+            ++c;
+        for (std::size_t d = 0; d < x_.size(); ++d) {
+            x_[d] ^= v_[d][c];
+            out[d] = static_cast<double>(x_[d]) * 0x1.0p-32;
+        }
+    }
+
+private:
+    std::vector<std::array<std::uint32_t, 32>> v_;
+    std::vector<std::uint32_t> x_;
+    std::uint64_t index_{0};
+};
+
+struct ResolvedParam {
+    const ComponentInfo* info;
+    const FieldInfo* field;
+    const SweepParameter* p;
+
+    // Ints take every value in [lo, hi] with equal width
+    double value(double u) const {
+        if (field->kind == FieldKind::Int)
+            return std::min<double>(p->hi, std::floor(p->lo + u * (p->hi - p->lo + 1.0)));
+        return p->lo + u * (p->hi - p->lo);
+    }
+};
+
+// Every Alarmable gets a response to sweep, as MonteCarlo gives it one.
+// Warm-up and cases both do this first so their storages match and resume()
+// restores in place.
+void prepare(SimRunner& sim) {
+    auto& r = sim.reg();
+    for (auto e : r.view<Alarmable>())
+        if (!r.all_of<AlarmResponse>(e))
+            r.emplace<AlarmResponse>(e);
+    sim.compileAlarms();
+    sim.preallocate();
+}
+
+bool load(SimRunner& sim, const SweepConfig& cfg, const PlantDescription* plant) {
+    const bool ok = plant ? sim.loadDefaultScenario(*plant) : sim.loadDefaultScenario(cfg.plant_path);
+    if (ok)
+        prepare(sim);
+    return ok;
+}
+
+void apply(entt::registry& r, const ResolvedParam& rp, double value) {
+    const entt::entity* rows = nullptr;
+    const std::size_t n = rp.info->rows(r, rows);
+    for (std::size_t i = 0; i < n; ++i) {
+        void* c = rp.info->get(r, rows[i]);
+        writeField(c, *rp.field, rp.p->scale ? readField(c, *rp.field) * value : value);
+    }
+}
+
+SweepCase runCase(const SweepConfig& cfg, const std::vector<ResolvedParam>& params,
+                  const std::vector<double>& unit, std::size_t index,
+                  const CheckpointStore& warm, const PlantDescription* plant) {
+    SweepCase out;
+    out.index = index;
+
+    for (std::size_t j = 0; j < params.size(); ++j)
+        out.values.push_back(params[j].value(unit[j]));
+
+    // Failed until it has run, so nothing half-done reaches the statistics
+    out.failed = true;
+    SimRunner sim(cfg.dt);
+    if (!load(sim, cfg, plant) || !sim.resume(warm))
+        return out;
+    auto& r = sim.reg();
+    for (std::size_t j = 0; j < params.size(); ++j)
+        apply(r, params[j], out.values[j]);
+
+    const SiteKPI* kpi = r.ctx().get<SiteContext>().primary().kpi;
+    if (!kpi)
+        return out;
+    const double t0 = sim.simTime();
+    const double d0 = kpi->downtime_s;
+    const double end = t0 + cfg.horizon_s;
+
+    double rate = 0.0, last = -1.0;
+    unsigned settled = 0;
+    while (sim.simTime() + 0.5 * cfg.dt < end) {
+        sim.run_until(std::min(end, sim.simTime() + std::max<double>(cfg.check_s, cfg.dt)));
+        const double t = sim.simTime() - t0;
+        rate = (kpi->downtime_s - d0) / t;
+        if (cfg.patience == 0 || t < cfg.min_s) {
+            last = rate;
+            continue;
+        }
+        // No downtime yet is not a settled rate: 0 vs 0 would pass any tolerance
+        const bool steady = rate > 0.0 && std::abs(rate - last) <= cfg.rel_tol * rate;
+        settled = steady ? settled + 1 : 0;
+        last = rate;
+        if (settled >= cfg.patience && sim.simTime() + 0.5 * cfg.dt < end) {
+            out.converged = true;
+            break;
+        }
+    }
+    out.stopped_at_s = sim.simTime() - t0;
+    out.downtime_s = out.converged ? rate * cfg.horizon_s : kpi->downtime_s - d0;
+    out.kpi = *kpi;
+    out.failed = false;
+    return out;
+}
+
+// Spread below rounding of the extrapolated totals counts as none, so a
+// parameter the output ignores doesn't get an index of noise / noise
+double variance(const std::vector<double>& y) {
+    if (y.empty())
+        return 0.0;
+    const double mean = std::accumulate(y.begin(), y.end(), 0.0) / static_cast<double>(y.size());
+    double ss = 0.0;
+    for (double v : y) ss += (v - mean) * (v - mean);
+    const double var = ss / static_cast<double>(y.size());
+    return var > 1e-12 * mean * mean ? var : 0.0;
+}
+
+// Var(E[Y | X_j]) / Var(Y) over groups of cases: equal X_j for a grid,
+// about sqrt(n) equal-count bins of X_j otherwise
+double binnedFirstOrder(const std::vector<SweepCase>& cases, std::size_t j, bool exact) {
+    std::vector<std::size_t> order(cases.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t a, std::size_t b) { return cases[a].values[j] < cases[b].values[j]; });
+    std::vector<double> y;
+    for (const auto& c : cases) y.push_back(c.downtime_s);
+    const double var = variance(y);
+    if (var <= 0.0)
+        return 0.0;
+    const double mean = std::accumulate(y.begin(), y.end(), 0.0) / static_cast<double>(y.size());
+
+    const std::size_t n = cases.size();
+    const std::size_t bins = std::min(n, std::max<std::size_t>(2, static_cast<std::size_t>(std::lround(std::sqrt(static_cast<double>(n))))));
+    double between = 0.0;
+    auto group = [&](std::size_t lo, std::size_t hi) {
+        double sum = 0.0;
+        for (std::size_t k = lo; k < hi; ++k) sum += y[order[k]];
+        const double m = sum / static_cast<double>(hi - lo);
+        between += static_cast<double>(hi - lo) * (m - mean) * (m - mean);
+    };
+    if (exact) {
+        for (std::size_t lo = 0, hi; lo < n; lo = hi) {
+            for (hi = lo + 1; hi < n && cases[order[hi]].values[j] == cases[order[lo]].values[j]; ++hi) {}
+            group(lo, hi);
+        }
+    } else {
+        for (std::size_t q = 0; q < bins; ++q)
+            if (q * n / bins < (q + 1) * n / bins)
+                group(q * n / bins, (q + 1) * n / bins);
+    }
+    return between / static_cast<double>(n) / var;
+}
+
+// Saltelli 2010 first order and Jansen total effect on rows `pick` of the
+// A, B and AB_j blocks
+void saltelli(const std::vector<double>& fA, const std::vector<double>& fB, const std::vector<double>& fAB,
+              const std::vector<std::size_t>& pick, double& first, double& total) {
+    std::vector<double> both;
+    for (auto i : pick) { both.push_back(fA[i]); both.push_back(fB[i]); }
+    const double var = variance(both);
+    double s1 = 0.0, st = 0.0;
+    for (auto i : pick) {
+        s1 += fB[i] * (fAB[i] - fA[i]);
+        st += (fA[i] - fAB[i]) * (fA[i] - fAB[i]);
+    }
+    const double n = static_cast<double>(pick.size());
+    first = var > 0.0 ? s1 / n / var : 0.0;
+    total = var > 0.0 ? st / (2.0 * n) / var : 0.0;
+}
+
+} // namespace
+
+void ParameterSweep::sobolIndices(const std::vector<double>& fA, const std::vector<double>& fB,
+                                  const std::vector<double>& fAB, double& first, double& total) {
+    std::vector<std::size_t> pick(fA.size());
+    std::iota(pick.begin(), pick.end(), 0);
+    saltelli(fA, fB, fAB, pick, first, total);
+}
+
+std::vector<SweepParameter> SweepConfig::defaultParameters() {
+    return {
+        {"HumanFactors.shift_length_hours", 8.f, 12.f, 2},
+        {"HumanFactors.training", 0.6f, 0.8f, 3},
+        {"HumanFactors.staff_on_shift", 2.f, 5.f, 4},
+        {"PID.kp", 0.5f, 2.f, 3, true},
+        {"PID.ki", 0.5f, 2.f, 3, true},
+        {"AlarmResponse.ack_delay_target_s", 30.f, 120.f, 2},
+        {"AlarmResponse.repair_time_target_s", 300.f, 1800.f, 2},
+    };
+}
+
+std::vector<std::vector<double>> ParameterSweep::unitDesign(const SweepConfig& cfg) {
+    const std::size_t k = cfg.params.size();
+    std::vector<std::vector<double>> pts;
+    switch (cfg.design) {
+    case SweepDesign::Grid: {
+        std::size_t cells = 1;
+        for (const auto& p : cfg.params) cells *= std::max(1u, p.levels);
+        for (std::size_t c = 0; c < cells; ++c) {
+            // Mixed radix, last parameter fastest
+            std::vector<double> u(k);
+            std::size_t rest = c;
+            for (std::size_t j = k; j-- > 0;) {
+                const unsigned levels = std::max(1u, cfg.params[j].levels);
+                const std::size_t l = rest % levels;
+                rest /= levels;
+                u[j] = levels == 1 ? 0.5 : static_cast<double>(l) / static_cast<double>(levels - 1);
+            }
+            pts.push_back(std::move(u));
+        }
+        break;
+    }
+    case SweepDesign::LatinHypercube: {
+        const std::size_t n = cfg.samples;
+        SplitMix64 rng(cfg.seed);
+        pts.assign(n, std::vector<double>(k));
+        std::vector<std::size_t> perm(n);
+        for (std::size_t j = 0; j < k; ++j) {
+            std::iota(perm.begin(), perm.end(), 0);
+            for (std::size_t i = n; i > 1; --i)
+                std::swap(perm[i - 1], perm[rng.next() % i]);
+            for (std::size_t i = 0; i < n; ++i)
+                pts[i][j] = (static_cast<double>(perm[i]) + rng.uniform()) / static_cast<double>(n);
+        }
+        break;
+    }
+    case SweepDesign::Sobol: {
+        // Rows of A, then B, then AB_j (A with column j from B) for each j
+        const std::size_t n = cfg.samples;
+        SobolSequence seq(static_cast<unsigned>(2 * k));
+        std::vector<std::vector<double>> a(n, std::vector<double>(k)), b(n, std::vector<double>(k));
+        std::vector<double> row(2 * k);
+        for (std::size_t i = 0; i < n; ++i) {
+            seq.next(row.data());
+            std::copy(row.begin(), row.begin() + k, a[i].begin());
+            std::copy(row.begin() + k, row.end(), b[i].begin());
+        }
+        pts = a;
+        pts.insert(pts.end(), b.begin(), b.end());
+        for (std::size_t j = 0; j < k; ++j) {
+            for (std::size_t i = 0; i < n; ++i) {
+                pts.push_back(a[i]);
+                pts.back()[j] = b[i][j];
+            }
+        }
+        break;
+    }
+    }
+    return pts;
+}
+
+SweepReport ParameterSweep::run(const SweepConfig& cfg) {
+    SweepReport report;
+    const std::size_t k = cfg.params.size();
+    if (cfg.design == SweepDesign::Sobol && 2 * k > SobolSequence::kMaxDims) {
+        std::cerr << "Sobol sweep supports at most " << SobolSequence::kMaxDims / 2 << " parameters\n";
+        return report;
+    }
+    std::vector<ResolvedParam> params;
+    for (const auto& p : cfg.params) {
+        int c = -1, f = -1;
+        if (!findFieldRef(p.field, c, f)) {
+            std::cerr << "Unknown sweep parameter " << p.field << "\n";
+            return report;
+        }
+        const ComponentInfo& info = componentTable()[c];
+        params.push_back({&info, &info.fields[f], &p});
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+
+    // Parse once, warm up once; every case resumes from the fork
+    PlantDescription plant;
+    const bool parsed = !PlantImage::isImage(cfg.plant_path) && Loader::parsePlant(cfg.plant_path, plant);
+    std::shared_ptr<const CheckpointStore> warm;
+    {
+        SimRunner sim(cfg.dt);
+        if (!load(sim, cfg, parsed ? &plant : nullptr)) {
+            std::cerr << "Could not load " << cfg.plant_path << "\n";
+            return report;
+        }
+        sim.run_until(cfg.warmup_s);
+        warm = sim.fork();
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    report.warmup_wall_s = std::chrono::duration<double>(t1 - t0).count();
+
+    const auto unit = unitDesign(cfg);
+    report.cases.resize(unit.size());
+    {
+        WorkPool pool(cfg.threads);
+        pool.parallel_for(unit.size(), [&](std::size_t i) {
+            report.cases[i] = runCase(cfg, params, unit[i], i, *warm, parsed ? &plant : nullptr);
+        });
+    }
+    report.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    // Failed cases have no downtime to speak of: they stay in `cases` (in
+    // design order) but out of every statistic and index
+    std::vector<double> all, y;
+    std::vector<SweepCase> ok;
+    for (const auto& c : report.cases) {
+        all.push_back(c.downtime_s);
+        report.failed += c.failed;
+        if (c.failed)
+            continue;
+        y.push_back(c.downtime_s);
+        ok.push_back(c);
+        report.stopped_early += c.converged;
+    }
+    report.downtime_s = MonteCarlo::summarize(y);
+    report.no_signal  = variance(y) <= 0.0;
+
+    for (std::size_t j = 0; j < k; ++j) {
+        SensitivityIndex s;
+        s.field = cfg.params[j].field;
+        if (cfg.design != SweepDesign::Sobol) {
+            s.first = binnedFirstOrder(ok, j, cfg.design == SweepDesign::Grid);
+            report.indices.push_back(s);
+            continue;
+        }
+
+        const std::size_t n = cfg.samples;
+        std::vector<double> fA(all.begin(), all.begin() + n), fB(all.begin() + n, all.begin() + 2 * n);
+        std::vector<double> fAB(all.begin() + (2 + j) * n, all.begin() + (3 + j) * n);
+        // Rows whose A, B and AB_j cases all ran
+        std::vector<std::size_t> rows;
+        for (std::size_t i = 0; i < n; ++i)
+            if (!report.cases[i].failed && !report.cases[n + i].failed && !report.cases[(2 + j) * n + i].failed)
+                rows.push_back(i);
+        if (rows.empty()) {
+            report.indices.push_back(s);
+            continue;
+        }
+        saltelli(fA, fB, fAB, rows, s.first, s.total);
+
+        // Same resamples for every parameter, so the intervals are comparable
+        SplitMix64 rng(cfg.seed ^ 0xB007u);
+        std::vector<std::size_t> pick(rows.size());
+        std::vector<double> firsts, totals;
+        for (std::size_t b = 0; b < cfg.bootstrap && rows.size() > 1; ++b) {
+            for (auto& i : pick)
+                i = rows[static_cast<std::size_t>(rng.next() % rows.size())];
+            double f = 0.0, t = 0.0;
+            saltelli(fA, fB, fAB, pick, f, t);
+            firsts.push_back(f);
+            totals.push_back(t);
+        }
+        s.first_ci = 1.96 * MonteCarlo::summarize(firsts).stddev;
+        s.total_ci = 1.96 * MonteCarlo::summarize(totals).stddev;
+        report.indices.push_back(s);
+    }
+    return report;
+}
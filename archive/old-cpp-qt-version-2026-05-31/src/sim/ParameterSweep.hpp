@@ -0,0 +1,106 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Components.hpp"
+#include "MonteCarlo.hpp"
+
+// Design-of-experiments driver: structured sweeps over HumanFactors,
+// process and AlarmResponse parameters, with sensitivity indices on the
+// downtime SiteKPI accrues over the horizon.
+//
+// The plant is warmed up once with its own parameters and forked
+// (SimRunner::fork); every case resumes from that state, applies its
+// values and runs the horizon, so no case repeats the startup transient.
+// A case stops early once its downtime rate has settled and extrapolates
+// the rest of the horizon from that rate. Cases run in parallel on a
+// WorkPool, as MonteCarlo's replicas do.
+
+enum class SweepDesign : std::uint8_t {
+  Grid,            // full factorial over each parameter's levels
+  LatinHypercube,  // `samples` points, one per stratum of every parameter
+  Sobol,           // Saltelli scheme on a Sobol sequence: samples * (k + 2) cases
+};
+
+struct SweepParameter {
+  std::string field;      // "HumanFactors.training", "PID.kp", ...
+  float lo{0.f};
+  float hi{0.f};
+  unsigned levels{2};     // Grid only
+  bool scale{false};      // multiply each entity's warm value instead of setting it
+};
+
+struct SweepConfig {
+  std::string plant_path{"plant_default.json"};
+  SweepDesign design{SweepDesign::LatinHypercube};
+  std::vector<SweepParameter> params{defaultParameters()};
+  std::size_t samples{64};        // LatinHypercube points, Sobol base size
+  double warmup_s{3600.0};        // shared startup transient, run once
+  double horizon_s{8.0 * 3600.0}; // measured after the warm-up
+  float dt{0.1f};
+  std::uint64_t seed{12345};
+  unsigned threads{0};            // 0 = all cores
+
+  // Early stopping: every check_s of sim time after min_s, a case whose
+  // downtime rate is non-zero and moved by no more than rel_tol (relative)
+  // on `patience` checks running stops there. A case without downtime runs
+  // to the end. patience = 0 runs every case to the end.
+  double check_s{600.0};
+  double min_s{3600.0};
+  double rel_tol{0.01};
+  unsigned patience{3};
+
+  std::size_t bootstrap{200};     // resamples for the Sobol confidence intervals
+
+  // Shift length 8 vs 12 h, training 0.6 → 0.8, staffing, PID gains
+  // (scaled) and the AlarmResponse targets.
+  static std::vector<SweepParameter> defaultParameters();
+};
+
+struct SweepCase {
+  std::size_t index{0};
+  std::vector<double> values;     // per parameter, in SweepConfig::params order
+  double downtime_s{0};           // over the horizon, extrapolated if stopped early
+  double stopped_at_s{0};         // horizon time actually simulated
+  bool converged{false};
+  bool failed{false};             // plant didn't load or resume; left out of the stats
+  SiteKPI kpi;                    // as of the stop
+};
+
+// Share of downtime variance explained by one parameter. Grid and Latin
+// hypercube give first-order indices from the variance of conditional means
+// (exact main effects for a grid, binned for LHS); Sobol adds total-effect
+// indices (Saltelli 2010, Jansen) and bootstrap 95% half-widths.
+struct SensitivityIndex {
+  std::string field;
+  double first{0};
+  double total{-1};               // -1: not estimated by this design
+  double first_ci{0};
+  double total_ci{0};
+};
+
+struct SweepReport {
+  std::vector<SweepCase> cases;   // in design order
+  std::vector<SensitivityIndex> indices;
+  KpiStats downtime_s;
+  std::size_t stopped_early{0};
+  std::size_t failed{0};          // cases excluded from the stats and indices
+  bool no_signal{false};          // same downtime in every case: the indices are 0 by construction
+  double warmup_wall_s{0};
+  double wall_s{0};
+};
+
+struct ParameterSweep {
+  // Empty report (and a message on stderr) for an unknown field or a plant
+  // that doesn't load.
+  static SweepReport run(const SweepConfig& cfg);
+
+  // Points of the design in [0, 1]^k, before mapping onto the ranges.
+  static std::vector<std::vector<double>> unitDesign(const SweepConfig& cfg);
+
+  // Saltelli 2010 first order and Jansen total effect of parameter j from
+  // the outputs on the A, B and AB_j blocks of a Sobol design.
+  static void sobolIndices(const std::vector<double>& fA, const std::vector<double>& fB,
+                           const std::vector<double>& fAB, double& first, double& total);
+};
@@ -0,0 +1,292 @@
+#include "PlantFleet.hpp"
+#include "AlarmEngine.hpp"
+#include "BatchKernels.hpp"
+#include "PlantImage.hpp"
+#include "SimRunner.hpp"
+#include "SiteContext.hpp"
+#include "WorkPool.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+
+namespace {
+template<typename... V>
+void resizeAll(std::size_t n, V&... lanes) {
+    (lanes.resize(n), ...);
+}
+
+// All instances or none: on a failure the fleet keeps its old runners, so
+// the lanes and stages still point into live registries
+template<typename Source>
+bool loadInstances(std::vector<std::unique_ptr<SimRunner>>& runners, const Source& source,
+                   std::size_t instances, float dt, const IntegrationConfig& integration) {
+    std::vector<std::unique_ptr<SimRunner>> loaded;
+    loaded.reserve(instances);
+    for (std::size_t i = 0; i < instances; ++i) {
+        auto runner = std::make_unique<SimRunner>(dt);
+        runner->setIntegration(integration);
+        if (!runner->loadDefaultScenario(source))
+            return false;
+        loaded.push_back(std::move(runner));
+    }
+    runners.swap(loaded);
+    return true;
+}
+}
+
+PlantFleet::PlantFleet(float dt) : dt_(dt) {}
+
+PlantFleet::~PlantFleet() = default;
+
+bool PlantFleet::load(const std::string& path, std::size_t instances) {
+    // Parse once, as MonteCarlo does; binary images are mapped per instance
+    if (!PlantImage::isImage(path)) {
+        PlantDescription plant;
+        return Loader::parsePlant(path, plant) && load(plant, instances);
+    }
+    if (!loadInstances(runners_, path, instances, dt_, integration_))
+        return false;
+    rebind();
+    return true;
+}
+
+bool PlantFleet::load(const PlantDescription& plant, std::size_t instances) {
+    if (!loadInstances(runners_, plant, instances, dt_, integration_))
+        return false;
+    rebind();
+    return true;
+}
+
+void PlantFleet::rebind() {
+    auto& c = control_;
+    auto& a = actuator_;
+    auto& h = hx_;
+    auto& l = alarm_;
+    c.pid.clear(); a.valve.clear(); a.pid.clear(); h.hx.clear(); h.valve.clear();
+    c.off.assign(1, 0); a.off.assign(1, 0); h.off.assign(1, 0); l.off.assign(1, 0);
+
+    // Same views in the same order as BatchSystems, one instance after another
+    for (auto& runner : runners_) {
+        auto& r = runner->reg();
+        auto pv = r.view<PID>();
+        for (auto e : pv)
+            c.pid.push_back(&pv.get<PID>(e));
+        c.off.push_back(static_cast<std::uint32_t>(c.pid.size()));
+
+        auto vv = r.view<ValveActuator, PID>();
+        for (auto e : vv) {
+            a.valve.push_back(&vv.get<ValveActuator>(e));
+            a.pid.push_back(&vv.get<PID>(e));
+        }
+        a.off.push_back(static_cast<std::uint32_t>(a.valve.size()));
+
+        auto hv = r.view<HeatExchanger, ValveActuator>();
+        for (auto e : hv) {
+            h.hx.push_back(&hv.get<HeatExchanger>(e));
+            h.valve.push_back(&hv.get<ValveActuator>(e));
+        }
+        h.off.push_back(static_cast<std::uint32_t>(h.hx.size()));
+
+        const auto* alarms = r.ctx().find<AlarmEngine>();
+        l.off.push_back(l.off.back() + static_cast<std::uint32_t>(alarms ? alarms->size() : 0));
+    }
+    resizeAll(c.pid.size(), c.kp, c.ki, c.sp, c.pv, c.integ, c.out);
+    resizeAll(a.valve.size(), a.target, a.speed, a.pos);
+    resizeAll(h.hx.size(), h.inlet, h.pos, h.tau, h.flow, h.outlet, h.on);
+    resizeAll(l.off.back(), l.level, l.hiSP, l.loSP, l.hi, l.lo);
+
+    shards_ = std::max<std::size_t>(1, std::min<std::size_t>(runners_.size(), threads()));
+    if (pool_)
+        pool_->reserve(shards_);
+    buildStages();
+}
+
+// Runs of consecutive per-instance systems become one stage, so a tick has
+// a barrier per batched pass rather than per system
+void PlantFleet::buildStages() {
+    stages_.clear();
+    if (runners_.empty())
+        return;
+
+    bool alarms = true;
+    for (auto& runner : runners_)
+        alarms &= runner->reg().ctx().find<AlarmEngine>() != nullptr;
+
+    const Scheduler& sched = runners_.front()->scheduler();
+    for (std::size_t i = 0; i < sched.size(); ++i) {
+        const SystemDesc& sys = sched.system(i);
+        Pass pass = Pass::Instances;
+        // Multi-rate entries keep their own schedule in each instance
+        if (sys.rate.every == 1 && sys.rate.substeps == 1) {
+            if (sys.name == "Control")            pass = Pass::Control;
+            else if (sys.name == "Actuator")      pass = Pass::Actuator;
+            else if (sys.name == "HeatExchanger") pass = Pass::HeatExchanger;
+            else if (sys.name == "Alarm" && alarms) pass = Pass::Alarm;
+        }
+        if (pass == Pass::Instances && !stages_.empty() && stages_.back().pass == Pass::Instances)
+            stages_.back().last = i + 1;
+        else
+            stages_.push_back({pass, i, i + 1});
+    }
+}
+
+void PlantFleet::setThreads(unsigned threads) {
+    if (threads > 1)
+        pool_ = std::make_unique<WorkPool>(threads);
+    else
+        pool_.reset();
+    shards_ = std::max<std::size_t>(1, std::min<std::size_t>(runners_.size(), this->threads()));
+    if (pool_)
+        pool_->reserve(shards_);
+}
+
+unsigned PlantFleet::threads() const {
+    return pool_ ? pool_->size() : 1u;
+}
+
+void PlantFleet::setIntegration(const IntegrationConfig& cfg) {
+    integration_ = cfg;
+    for (auto& runner : runners_)
+        runner->setIntegration(cfg);
+}
+
+void PlantFleet::submit(std::size_t i, const Command& c) {
+    runners_[i]->submit(c);
+}
+
+const SiteKPI* PlantFleet::kpi(std::size_t i) {
+    const auto* sites = runners_[i]->reg().ctx().find<SiteContext>();
+    return sites ? sites->sites.front().kpi : nullptr;
+}
+
+std::uint64_t PlantFleet::step() const {
+    return runners_.empty() ? 0 : runners_.front()->step();
+}
+
+double PlantFleet::simTime() const {
+    return runners_.empty() ? 0.0 : runners_.front()->simTime();
+}
+
+void PlantFleet::tick() {
+    SIM_PROFILE_SCOPE("FleetTick", runners_.size());
+    SIM_NO_ALLOC_SCOPE();
+    for (auto& runner : runners_)
+        runner->beginTick();
+    for (const auto& stage : stages_)
+        runStage(stage);
+    for (auto& runner : runners_)
+        runner->endTick();
+}
+
+void PlantFleet::run(std::uint64_t steps) {
+    for (std::uint64_t i = 0; i < steps; ++i)
+        tick();
+}
+
+void PlantFleet::run_until(double sim_time_s) {
+    while (simTime() + 0.5 * dt_ < sim_time_s)
+        tick();
+}
+
+void PlantFleet::runStage(const Stage& stage) {
+    run_stage_ = &stage;
+    if (!pool_ || shards_ <= 1) {
+        for (std::size_t k = 0; k < shards_; ++k)
+            runShard(k);
+        return;
+    }
+    // Tasks capture only (this, k) so submit() doesn't allocate
+    for (std::size_t k = 0; k < shards_; ++k)
+        pool_->submit([this, k] { runShard(k); });
+    pool_->wait();
+}
+
+void PlantFleet::runShard(std::size_t k) {
+    SIM_NO_ALLOC_SCOPE();
+    const std::size_t n = runners_.size();
+    const std::size_t a = k * n / shards_, b = (k + 1) * n / shards_;
+    const Stage& stage = *run_stage_;
+    switch (stage.pass) {
+    case Pass::Instances:
+        for (std::size_t i = a; i < b; ++i)
+            for (std::size_t s = stage.first; s < stage.last; ++s)
+                runners_[i]->runSystem(s);
+        break;
+    case Pass::Control:       control(a, b); break;
+    case Pass::Actuator:      actuator(a, b); break;
+    case Pass::HeatExchanger: heatExchanger(a, b); break;
+    case Pass::Alarm:         alarm(a, b); break;
+    }
+}
+
+void PlantFleet::control(std::size_t a, std::size_t b) {
+    auto& L = control_;
+    const std::uint32_t lo = L.off[a], hi = L.off[b];
+    for (std::uint32_t j = lo; j < hi; ++j) {
+        const PID& pid = *L.pid[j];
+        L.kp[j] = pid.kp;
+        L.ki[j] = pid.ki;
+        L.sp[j] = pid.sp;
+        L.pv[j] = pid.pv;
+        L.integ[j] = pid.integ;
+    }
+    BatchKernels::pidUpdate(hi - lo, L.kp.data() + lo, L.ki.data() + lo, L.sp.data() + lo, L.pv.data() + lo,
+                            L.integ.data() + lo, L.out.data() + lo, dt_);
+    for (std::uint32_t j = lo; j < hi; ++j) {
+        L.pid[j]->integ = L.integ[j];
+        L.pid[j]->out   = L.out[j];
+    }
+}
+
+void PlantFleet::actuator(std::size_t a, std::size_t b) {
+    auto& L = actuator_;
+    const std::uint32_t lo = L.off[a], hi = L.off[b];
+    for (std::uint32_t j = lo; j < hi; ++j) {
+        L.target[j] = L.pid[j]->out;
+        L.speed[j]  = L.valve[j]->speed;
+        L.pos[j]    = L.valve[j]->pos;
+    }
+    BatchKernels::valveTravel(hi - lo, L.target.data() + lo, L.speed.data() + lo, L.pos.data() + lo, dt_);
+    for (std::uint32_t j = lo; j < hi; ++j)
+        L.valve[j]->pos = L.pos[j];
+}
+
+void PlantFleet::heatExchanger(std::size_t a, std::size_t b) {
+    auto& L = hx_;
+    const std::uint32_t lo = L.off[a], hi = L.off[b];
+    for (std::uint32_t j = lo; j < hi; ++j) {
+        const HeatExchanger& hx = *L.hx[j];
+        L.inlet[j]  = hx.comp_inlet_stream;
+        L.pos[j]    = L.valve[j]->pos;
+        L.tau[j]    = hx.tau_s;
+        L.flow[j]   = hx.flow_rate;
+        L.outlet[j] = hx.comp_outlet_stream;
+        L.on[j]     = hx.power_on ? ~0u : 0u;
+    }
+    BatchKernels::hxLag(hi - lo, L.inlet.data() + lo, L.pos.data() + lo, L.tau.data() + lo, L.flow.data() + lo,
+                        L.on.data() + lo, L.outlet.data() + lo, dt_, integration_.thermal);
+    for (std::uint32_t j = lo; j < hi; ++j)
+        L.hx[j]->comp_outlet_stream = L.outlet[j];
+}
+
+void PlantFleet::alarm(std::size_t a, std::size_t b) {
+    auto& L = alarm_;
+    for (std::size_t i = a; i < b; ++i) {
+        auto& alarms = runners_[i]->reg().ctx().get<AlarmEngine>();
+        alarms.events.clear();
+        for (std::uint32_t p = 0, j = L.off[i]; j < L.off[i + 1]; ++p, ++j) {
+            const Alarmable& alarm = *alarms.alarm[p];
+            L.level[j] = *alarms.source[p];
+            L.hiSP[j]  = AlarmEngine::hiLimit(alarm);
+            L.loSP[j]  = AlarmEngine::loLimit(alarm);
+        }
+    }
+    const std::uint32_t lo = L.off[a], hi = L.off[b];
+    BatchKernels::alarmCompare(hi - lo, L.level.data() + lo, L.hiSP.data() + lo, L.loSP.data() + lo,
+                               L.hi.data() + lo, L.lo.data() + lo);
+    for (std::size_t i = a; i < b; ++i) {
+        auto& alarms = runners_[i]->reg().ctx().get<AlarmEngine>();
+        for (std::uint32_t p = 0, j = L.off[i]; j < L.off[i + 1]; ++p, ++j)
+            if (!alarms.settled(p, L.hi[j], L.lo[j]))
+                alarms.update(p, L.level[j], L.hi[j], L.lo[j]);
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <entt/entt.hpp>
+#include "Commands.hpp"
+#include "Components.hpp"
+#include "Integrator.hpp"
+#include "Loader.hpp"
+
+class SimRunner;
+class WorkPool;
+
+// N independent instances of one plant stepped together, e.g. a classroom
+// of trainees each operating their own copy of plant_default.json from one
+// timer. Every instance is a full SimRunner with its own registry, so
+// commands, recording, alarms and SiteKPI stay per instance; the fleet only
+// owns the clock and the order of work.
+//
+// A tick walks the pipeline system by system across all instances. The
+// per-entity systems (Control, Actuator, HeatExchanger, Alarm) run as one
+// batched pass over fleet-wide SoA lanes laid out instance-major (instance
+// i's PIDs, then instance i+1's), split into contiguous shards of
+// instances, one task each. The rest run per instance, the instances of a
+// shard back to back. Results match each instance ticking on its own, bit
+// for bit.
+//
+// Lanes gather through component pointers cached by rebind(), like
+// FlowNetwork's; call it after structural edits to any instance.
+class PlantFleet {
+public:
+  explicit PlantFleet(float dt = 0.02f);
+  ~PlantFleet();
+
+  PlantFleet(const PlantFleet&) = delete;
+  PlantFleet& operator=(const PlantFleet&) = delete;
+
+  // `instances` copies of the default scenario; the JSON is parsed once.
+  // False if any instance fails to load, leaving the fleet as it was.
+  bool load(const std::string& path, std::size_t instances);
+  bool load(const PlantDescription& plant, std::size_t instances);
+
+  void rebind();
+
+  // threads > 1 shards each pass over a pool; instances keep none of their own.
+  void setThreads(unsigned threads);
+  unsigned threads() const;
+
+  // Same method for every instance; the batched HX pass assumes it.
+  void setIntegration(const IntegrationConfig& cfg);
+
+  void tick();
+  void run(std::uint64_t steps);
+  void run_until(double sim_time_s);
+
+  std::size_t size() const { return runners_.size(); }
+  SimRunner& instance(std::size_t i) { return *runners_[i]; }
+
+  // Operator input for one instance; the others never see it.
+  void submit(std::size_t i, const Command& c);
+  // Primary-site KPIs of instance i, null if it has none.
+  const SiteKPI* kpi(std::size_t i);
+
+  std::uint64_t step() const;
+  double simTime() const;
+
+private:
+  enum class Pass : std::uint8_t { Instances, Control, Actuator, HeatExchanger, Alarm };
+  struct Stage {
+    Pass pass;
+    std::size_t first, last;  // pipeline entries [first, last)
+  };
+
+  // Fleet-wide lanes; instance i owns [off[i], off[i + 1])
+  struct ControlLanes {
+    std::vector<PID*> pid;
+    std::vector<std::uint32_t> off;
+    std::vector<float> kp, ki, sp, pv, integ, out;
+  };
+  struct ActuatorLanes {
+    std::vector<ValveActuator*> valve;
+    std::vector<const PID*> pid;
+    std::vector<std::uint32_t> off;
+    std::vector<float> target, speed, pos;
+  };
+  struct HeatExchangerLanes {
+    std::vector<HeatExchanger*> hx;
+    std::vector<const ValveActuator*> valve;
+    std::vector<std::uint32_t> off;
+    std::vector<float> inlet, pos, tau, flow, outlet;
+    std::vector<std::uint32_t> on;
+  };
+  struct AlarmLanes {
+    std::vector<std::uint32_t> off;
+    std::vector<float> level, hiSP, loSP;
+    std::vector<std::uint8_t> hi, lo;
+  };
+
+  void buildStages();
+  void runStage(const Stage& stage);
+  void runShard(std::size_t k);
+  void control(std::size_t a, std::size_t b);
+  void actuator(std::size_t a, std::size_t b);
+  void heatExchanger(std::size_t a, std::size_t b);
+  void alarm(std::size_t a, std::size_t b);
+
+  float dt_;
+  IntegrationConfig integration_;
+  std::vector<std::unique_ptr<SimRunner>> runners_;
+  std::vector<Stage> stages_;
+
+  ControlLanes control_;
+  ActuatorLanes actuator_;
+  HeatExchangerLanes hx_;
+  AlarmLanes alarm_;
+
+  std::unique_ptr<WorkPool> pool_;
+  std::size_t shards_{1};
+  const Stage* run_stage_{nullptr};  // stage in progress, for the shard tasks
+};
@@ -0,0 +1,423 @@
+#include "PlantImage.hpp"
+#include "ComponentReflect.hpp"
+#include "Loader.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char kMagic[8] = {'E', 'X', 'S', 'I', 'M', 'I', 'M', 'G'};
+constexpr std::uint32_t kEndianTag = 0x01020304u;
+constexpr std::size_t kNameLen = 32;
+
+static_assert(sizeof(entt::entity) == sizeof(std::uint32_t), "image stores 32-bit entity ids");
+
+struct FileHeader {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t endian;
+    std::uint32_t entity_count;
+    std::uint32_t column_count;
+    std::uint32_t edge_count;
+    std::uint32_t id_count;
+    std::uint64_t step;
+    double        sim_time;
+    float         dt;
+    std::uint32_t reserved;
+    std::uint64_t strings_size;
+};
+static_assert(sizeof(FileHeader) == 64);
+
+struct IdRecord {
+    std::uint32_t entity;
+    std::uint32_t offset;
+    std::uint32_t length;
+};
+
+struct ColumnHeader {
+    char          name[kNameLen];
+    std::uint32_t struct_size;
+    std::uint32_t field_count;
+    std::uint32_t row_count;
+    std::uint32_t reserved;
+};
+
+struct FieldRecord {
+    char          name[kNameLen];
+    std::uint32_t kind;
+    std::uint32_t offset;
+};
+
+// Read-only view of a whole file; unmapped on destruction.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE)
+            return;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0)
+            return;
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_)
+            return;
+        data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        if (data_)
+            size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0)
+            return;
+        struct stat st;
+        if (::fstat(fd_, &st) != 0 || st.st_size == 0)
+            return;
+        void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (p == MAP_FAILED)
+            return;
+        data_ = static_cast<const char*>(p);
+        size_ = static_cast<std::size_t>(st.st_size);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+#else
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+        if (fd_ >= 0) ::close(fd_);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    const char* data_{nullptr};
+    std::size_t size_{0};
+#ifdef _WIN32
+    HANDLE file_{INVALID_HANDLE_VALUE};
+    HANDLE mapping_{nullptr};
+#else
+    int fd_{-1};
+#endif
+};
+
+// Bounds-checked walk over the mapping; take() returns nullptr past the end.
+struct Cursor {
+    const char* base;
+    std::size_t size;
+    std::size_t pos{0};
+
+    template<typename T>
+    const T* take(std::size_t count = 1) {
+        const std::size_t bytes = count * sizeof(T);
+        if (pos > size || bytes > size - pos)
+            return nullptr;
+        const T* p = reinterpret_cast<const T*>(base + pos);
+        pos += bytes;
+        return p;
+    }
+
+    const char* bytes(std::size_t n) { return take<char>(n); }
+    void align() { pos = (pos + 7) & ~std::size_t{7}; }
+};
+
+struct Writer {
+    std::FILE* f;
+    std::size_t pos{0};
+    bool ok{true};
+
+    void put(const void* p, std::size_t n) {
+        if (n && std::fwrite(p, 1, n, f) != n)
+            ok = false;
+        pos += n;
+    }
+    void align() {
+        static const char zeros[8] = {};
+        put(zeros, ((pos + 7) & ~std::size_t{7}) - pos);
+    }
+};
+
+void copyName(char (&dst)[kNameLen], const char* src) {
+    std::memset(dst, 0, kNameLen);
+    std::strncpy(dst, src, kNameLen - 1);
+}
+
+std::string_view nameOf(const char (&src)[kNameLen]) {
+    return std::string_view(src, strnlen(src, kNameLen));
+}
+
+struct Column {
+    const ComponentInfo* info;
+    std::vector<entt::entity> rows;
+    std::vector<char> bytes;
+};
+
+// True when the stored layout is exactly what this build's struct looks like,
+// so the column can be inserted without touching individual fields.
+bool layoutMatches(const ComponentInfo& info, const ColumnHeader& col, const FieldRecord* fields) {
+    if (col.struct_size != info.size || col.field_count != info.fields.size())
+        return false;
+    for (std::uint32_t i = 0; i < col.field_count; ++i) {
+        const FieldInfo& f = info.fields[i];
+        if (nameOf(fields[i].name) != f.name ||
+            fields[i].kind != static_cast<std::uint32_t>(f.kind) || fields[i].offset != f.offset)
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool PlantImage::isImage(const std::string& path) {
+    char magic[sizeof kMagic] = {};
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+    const bool ok = std::fread(magic, 1, sizeof magic, f) == sizeof magic &&
+                    std::memcmp(magic, kMagic, sizeof kMagic) == 0;
+    std::fclose(f);
+    return ok;
+}
+
+bool PlantImage::save(const std::string& path,
+                      entt::registry& reg,
+                      const std::unordered_map<std::string, entt::entity>& entityFromId,
+                      const ImageClock& clock)
+{
+    std::vector<Column> columns;
+    std::vector<std::uint32_t> entities;
+    for (const auto& info : componentTable()) {
+        Column c{&info, {}, {}};
+        info.dump(reg, c.rows, c.bytes);
+        if (c.rows.empty())
+            continue;
+        for (auto e : c.rows)
+            entities.push_back(entt::to_integral(e));
+        columns.push_back(std::move(c));
+    }
+
+    std::vector<std::uint32_t> edges;
+    if (auto* topo = reg.ctx().find<PlantTopology>()) {
+        edges.reserve(topo->edges.size() * 2);
+        for (auto [from, to] : topo->edges) {
+            edges.push_back(entt::to_integral(from));
+            edges.push_back(entt::to_integral(to));
+        }
+    }
+    entities.insert(entities.end(), edges.begin(), edges.end());
+
+    std::vector<IdRecord> ids;
+    std::string strings;
+    ids.reserve(entityFromId.size());
+    for (const auto& [id, e] : entityFromId) {
+        ids.push_back({entt::to_integral(e), static_cast<std::uint32_t>(strings.size()),
+                       static_cast<std::uint32_t>(id.size())});
+        strings += id;
+        entities.push_back(entt::to_integral(e));
+    }
+
+    // Every entity referenced anywhere, ascending so restore can create them in order
+    std::sort(entities.begin(), entities.end());
+    entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        std::cerr << "Could not write " << path << "\n";
+        return false;
+    }
+
+    FileHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof kMagic);
+    h.version      = kVersion;
+    h.endian       = kEndianTag;
+    h.entity_count = static_cast<std::uint32_t>(entities.size());
+    h.column_count = static_cast<std::uint32_t>(columns.size());
+    h.edge_count   = static_cast<std::uint32_t>(edges.size() / 2);
+    h.id_count     = static_cast<std::uint32_t>(ids.size());
+    h.step         = clock.step;
+    h.sim_time     = clock.sim_time;
+    h.dt           = clock.dt;
+    h.strings_size = strings.size();
+
+    Writer w{f};
+    w.put(&h, sizeof h);
+    w.put(entities.data(), entities.size() * sizeof(std::uint32_t));
+    w.align();
+    w.put(edges.data(), edges.size() * sizeof(std::uint32_t));
+    w.align();
+    w.put(ids.data(), ids.size() * sizeof(IdRecord));
+    w.align();
+    w.put(strings.data(), strings.size());
+    w.align();
+
+    for (const auto& c : columns) {
+        ColumnHeader ch{};
+        copyName(ch.name, c.info->name);
+        ch.struct_size = static_cast<std::uint32_t>(c.info->size);
+        ch.field_count = static_cast<std::uint32_t>(c.info->fields.size());
+        ch.row_count   = static_cast<std::uint32_t>(c.rows.size());
+        w.put(&ch, sizeof ch);
+        for (const auto& fi : c.info->fields) {
+            FieldRecord fr{};
+            copyName(fr.name, fi.name);
+            fr.kind   = static_cast<std::uint32_t>(fi.kind);
+            fr.offset = fi.offset;
+            w.put(&fr, sizeof fr);
+        }
+        w.align();
+        w.put(c.rows.data(), c.rows.size() * sizeof(entt::entity));
+        w.align();
+        w.put(c.bytes.data(), c.bytes.size());
+        w.align();
+    }
+
+    const bool ok = w.ok && std::fclose(f) == 0;
+    if (!ok)
+        std::cerr << "Error writing " << path << "\n";
+    return ok;
+}
+
+bool PlantImage::load(const std::string& path,
+                      entt::registry& reg,
+                      std::unordered_map<std::string, entt::entity>& entityFromId,
+                      ImageClock* clock)
+{
+    MappedFile file(path);
+    if (!file.data()) {
+        std::cerr << "Could not open " << path << "\n";
+        return false;
+    }
+
+    auto bad = [&](const char* what) {
+        std::cerr << path << ": " << what << "\n";
+        return false;
+    };
+
+    Cursor in{file.data(), file.size()};
+    const FileHeader* h = in.take<FileHeader>();
+    if (!h || std::memcmp(h->magic, kMagic, sizeof kMagic) != 0)
+        return bad("not a plant image");
+    if (h->version != kVersion)
+        return bad("unsupported image version");
+    if (h->endian != kEndianTag)
+        return bad("image written on a machine with different byte order");
+
+    const auto* entities = in.take<std::uint32_t>(h->entity_count);
+    in.align();
+    const auto* edges = in.take<std::uint32_t>(std::size_t{h->edge_count} * 2);
+    in.align();
+    const auto* ids = in.take<IdRecord>(h->id_count);
+    in.align();
+    const char* strings = in.bytes(h->strings_size);
+    in.align();
+    if (!entities || !edges || !ids || !strings)
+        return bad("truncated");
+
+    // Ids must come back exactly, so anything already in reg (or an id the
+    // image lists twice) would remap rows onto the wrong entities
+    for (const ComponentInfo& info : componentTable()) {
+        const entt::entity* first = nullptr;
+        if (info.rows(reg, first) != 0)
+            return bad("registry not empty");
+    }
+    for (std::uint32_t i = 0; i < h->entity_count; ++i) {
+        const auto hint = static_cast<entt::entity>(entities[i]);
+        if (reg.valid(hint) || reg.create(hint) != hint)
+            return bad("duplicate entity");
+    }
+
+    auto& topo = reg.ctx().insert_or_assign(PlantTopology{});
+    topo.edges.reserve(h->edge_count);
+    for (std::uint32_t i = 0; i < h->edge_count; ++i)
+        topo.edges.emplace_back(static_cast<entt::entity>(edges[2 * i]),
+                                static_cast<entt::entity>(edges[2 * i + 1]));
+
+    entityFromId.reserve(entityFromId.size() + h->id_count);
+    for (std::uint32_t i = 0; i < h->id_count; ++i) {
+        if (std::uint64_t{ids[i].offset} + ids[i].length > h->strings_size)
+            return bad("bad id record");
+        entityFromId[std::string(strings + ids[i].offset, ids[i].length)] =
+            static_cast<entt::entity>(ids[i].entity);
+    }
+
+    for (std::uint32_t c = 0; c < h->column_count; ++c) {
+        const ColumnHeader* ch = in.take<ColumnHeader>();
+        const FieldRecord* fields = ch ? in.take<FieldRecord>(ch->field_count) : nullptr;
+        in.align();
+        const entt::entity* rows = ch ? in.take<entt::entity>(ch->row_count) : nullptr;
+        in.align();
+        const char* bytes = ch ? in.bytes(std::size_t{ch->row_count} * ch->struct_size) : nullptr;
+        in.align();
+        if (!ch || !fields || !rows || !bytes)
+            return bad("truncated column");
+
+        const ComponentInfo* info = findComponent(nameOf(ch->name));
+        if (!info) {
+            std::cerr << path << ": skipping unknown component " << nameOf(ch->name) << "\n";
+            continue;
+        }
+
+        // Rows must be entities listed above, each at most once per column
+        // and not already given this component by an earlier column
+        std::vector<entt::entity> sorted(rows, rows + ch->row_count);
+        std::sort(sorted.begin(), sorted.end());
+        if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+            return bad("duplicate row");
+        for (entt::entity e : sorted)
+            if (!reg.valid(e) || info->get(reg, e))
+                return bad("bad row entity");
+
+        if (layoutMatches(*info, *ch, fields)) {
+            info->insert(reg, rows, ch->row_count, bytes);
+            continue;
+        }
+
+        // Struct changed since the image was written: copy the fields both sides know
+        std::vector<std::pair<const FieldInfo*, FieldInfo>> map;
+        for (std::uint32_t i = 0; i < ch->field_count; ++i) {
+            const FieldRecord& fr = fields[i];
+            const std::uint32_t width = fr.kind == static_cast<std::uint32_t>(FieldKind::Bool) ? 1 : 4;
+            if (fr.kind > static_cast<std::uint32_t>(FieldKind::Int) || std::uint64_t{fr.offset} + width > ch->struct_size)
+                return bad("bad field record");
+            if (const FieldInfo* now = info->field(nameOf(fr.name)))
+                map.push_back({now, FieldInfo{now->name, static_cast<FieldKind>(fr.kind), fr.offset}});
+        }
+        for (std::uint32_t r = 0; r < ch->row_count; ++r) {
+            void* comp = info->emplace(reg, rows[r]);
+            const char* src = bytes + std::size_t{r} * ch->struct_size;
+            for (const auto& [now, stored] : map)
+                writeField(comp, *now, readField(src, stored));
+        }
+    }
+
+    if (clock) {
+        clock->step     = h->step;
+        clock->sim_time = h->sim_time;
+        clock->dt       = h->dt;
+    }
+    return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <entt/entt.hpp>
+
+// Sim clock stored alongside the registry so a snapshot resumes where it left off.
+struct ImageClock {
+    std::uint64_t step{0};
+    double sim_time{0.0};
+    float dt{0.0f};
+};
+
+// Versioned binary image of a registry: every reflected component column in
+// packed order, entityFromId, PlantTopology and the clock. Loading maps the
+// file and bulk-inserts columns straight from the mapping; a column whose
+// layout no longer matches Components.hpp falls back to per-field copy by name.
+//
+//   header | entities | topology edges | id records | id strings | columns...
+//   column = header | field records | rows (entity ids) | component bytes
+//
+// Sections are 8-byte aligned. Plant files produced by plantconv are just
+// images of a freshly loaded plant at step 0.
+struct PlantImage {
+    static constexpr std::uint32_t kVersion = 1;
+
+    static bool isImage(const std::string& path);
+
+    static bool save(const std::string& path,
+                     entt::registry& reg,
+                     const std::unordered_map<std::string, entt::entity>& entityFromId,
+                     const ImageClock& clock = {});
+
+    // reg should be empty: entity ids are restored exactly so cached
+    // topology and entityFromId stay valid.
+    static bool load(const std::string& path,
+                     entt::registry& reg,
+                     std::unordered_map<std::string, entt::entity>& entityFromId,
+                     ImageClock* clock = nullptr);
+};
@@ -0,0 +1,209 @@
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <unordered_set>
+#if defined(EXECSIM_ALLOC_CHECK) && EXECSIM_ALLOC_CHECK && __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define SIM_HAVE_BACKTRACE 1
+#endif
+
+namespace {
+
+thread_local std::uint64_t tl_allocs = 0;
+thread_local unsigned tl_no_alloc = 0;
+thread_local bool tl_reporting = false;  // the report itself may allocate
+std::atomic<std::uint64_t> g_violations{0};
+constexpr std::uint64_t kTracedViolations = 8;  // the rest are only counted
+
+struct RingRegistry {
+  std::mutex m;
+  std::vector<std::shared_ptr<ProfileRing>> rings;  // outlive their threads
+  std::unordered_set<std::string> names;
+};
+
+RingRegistry& rings() {
+  static RingRegistry reg;
+  return reg;
+}
+
+} // namespace
+
+#if (defined(EXECSIM_PROFILING) && EXECSIM_PROFILING) || (defined(EXECSIM_ALLOC_CHECK) && EXECSIM_ALLOC_CHECK)
+namespace {
+
+void violation(std::size_t n) {
+    const std::uint64_t k = g_violations.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (k > kTracedViolations)
+        return;
+    tl_reporting = true;
+    std::fprintf(stderr, "heap allocation of %zu bytes inside SIM_NO_ALLOC_SCOPE (violation %llu)\n",
+                 n, static_cast<unsigned long long>(k));
+#if defined(SIM_HAVE_BACKTRACE)
+    void* frames[32];
+    backtrace_symbols_fd(frames, backtrace(frames, 32), 2);  // straight to stderr, no malloc
+#endif
+    if (k == kTracedViolations)
+        std::fprintf(stderr, "further violations are counted but not traced\n");
+    tl_reporting = false;
+}
+
+void* counted(std::size_t n) {
+    ++tl_allocs;
+    if (tl_no_alloc && !tl_reporting)
+        violation(n);
+    if (void* p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+// Count every heap allocation per thread so scopes can report them, and
+// flag the ones made where the tick promised not to allocate.
+void* operator new(std::size_t n) { return counted(n); }
+void* operator new[](std::size_t n) { return counted(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#endif
+
+void ProfileRing::snapshot(std::vector<ProfileEvent>& out) const {
+    const std::uint64_t h0 = head_.load(std::memory_order_acquire);
+    const std::uint64_t first = h0 > kCapacity ? h0 - kCapacity : 0;
+    const std::size_t base = out.size();
+    for (std::uint64_t i = first; i < h0; ++i)
+        out.push_back(buf_[i & (kCapacity - 1)]);
+
+    // Slots the writer reused during the copy are no longer trustworthy
+    const std::uint64_t h1 = head_.load(std::memory_order_acquire);
+    const std::uint64_t safe_first = h1 > kCapacity ? h1 - kCapacity : 0;
+    if (safe_first > first) {
+        const auto drop = std::min<std::uint64_t>(safe_first - first, h0 - first);
+        out.erase(out.begin() + static_cast<std::ptrdiff_t>(base),
+                  out.begin() + static_cast<std::ptrdiff_t>(base + drop));
+    }
+}
+
+namespace Profiler {
+
+std::uint64_t nowNs() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+ProfileRing& threadRing() {
+    thread_local ProfileRing* ring = [] {
+        AllowAllocScope once;  // first scope on a new thread, possibly mid-tick
+        auto& reg = rings();
+        std::lock_guard<std::mutex> lk(reg.m);
+        reg.rings.push_back(std::make_shared<ProfileRing>(static_cast<std::uint32_t>(reg.rings.size())));
+        return reg.rings.back().get();
+    }();
+    return *ring;
+}
+
+const char* intern(const std::string& name) {
+    auto& reg = rings();
+    std::lock_guard<std::mutex> lk(reg.m);
+    return reg.names.insert(name).first->c_str();
+}
+
+std::uint64_t threadAllocs() {
+    return tl_allocs;
+}
+
+std::uint64_t allocViolations() {
+    return g_violations.load(std::memory_order_relaxed);
+}
+
+unsigned& noAllocDepth() {
+    return tl_no_alloc;
+}
+
+std::vector<ProfileEvent> collect() {
+    std::vector<std::shared_ptr<ProfileRing>> copy;
+    {
+        auto& reg = rings();
+        std::lock_guard<std::mutex> lk(reg.m);
+        copy = reg.rings;
+    }
+    std::vector<ProfileEvent> out;
+    for (const auto& ring : copy)
+        ring->snapshot(out);
+    std::sort(out.begin(), out.end(),
+              [](const ProfileEvent& a, const ProfileEvent& b) { return a.start_ns < b.start_ns; });
+    return out;
+}
+
+std::vector<ProfileSummary> summarize(std::size_t window) {
+    const auto events = collect();
+
+    // Newest events last, so walk backwards to fill each window
+    std::unordered_map<const char*, std::vector<const ProfileEvent*>> by_name;
+    std::vector<const char*> order;
+    for (auto it = events.rbegin(); it != events.rend(); ++it) {
+        auto& v = by_name[it->name];
+        if (v.empty())
+            order.push_back(it->name);
+        if (v.size() < window)
+            v.push_back(&*it);
+    }
+
+    std::vector<ProfileSummary> out;
+    for (const char* name : order) {
+        const auto& v = by_name[name];
+        std::vector<double> us;
+        us.reserve(v.size());
+        double ents = 0.0, allocs = 0.0;
+        for (const ProfileEvent* ev : v) {
+            us.push_back(static_cast<double>(ev->dur_ns) / 1000.0);
+            ents += ev->entities;
+            allocs += ev->allocs;
+        }
+        std::sort(us.begin(), us.end());
+        auto pct = [&](double p) { return us[static_cast<std::size_t>(p * static_cast<double>(us.size() - 1))]; };
+
+        ProfileSummary s;
+        s.name = name ? name : "?";
+        s.samples = us.size();
+        s.p50_us = pct(0.50);
+        s.p99_us = pct(0.99);
+        s.max_us = us.back();
+        s.mean_entities = ents / static_cast<double>(us.size());
+        s.mean_allocs = allocs / static_cast<double>(us.size());
+        out.push_back(std::move(s));
+    }
+    std::sort(out.begin(), out.end(), [](const auto& a, const auto& b) { return a.name < b.name; });
+    return out;
+}
+
+bool writeChromeTrace(const std::string& path) {
+    std::ofstream f(path);
+    if (!f)
+        return false;
+
+    const auto events = collect();
+    const std::uint64_t t0 = events.empty() ? 0 : events.front().start_ns;
+
+    f << "{\"traceEvents\":[\n";
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        const auto& ev = events[i];
+        f << "{\"name\":\"" << (ev.name ? ev.name : "?") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ev.tid
+          << ",\"ts\":" << static_cast<double>(ev.start_ns - t0) / 1000.0
+          << ",\"dur\":" << static_cast<double>(ev.dur_ns) / 1000.0
+          << ",\"args\":{\"entities\":" << ev.entities << ",\"allocs\":" << ev.allocs << "}}"
+          << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    f << "],\"displayTimeUnit\":\"ns\"}\n";
+    return static_cast<bool>(f);
+}
+
+} // namespace Profiler
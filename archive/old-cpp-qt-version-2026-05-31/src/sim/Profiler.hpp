@@ -0,0 +1,142 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Hot-path instrumentation for the tick pipeline. Each thread appends
+// fixed-size events to its own ring (single writer, no locks); readers take
+// a consistent snapshot on demand. Built only with EXECSIM_PROFILING=1:
+// otherwise SIM_PROFILE_SCOPE expands to nothing and no allocation hook is
+// installed.
+//
+// EXECSIM_ALLOC_CHECK=1 installs the same hook as a zero-allocation check:
+// any operator new made on a thread inside SIM_NO_ALLOC_SCOPE counts as a
+// violation and the first few print a stack trace to stderr.
+
+struct ProfileEvent {
+  const char*   name{nullptr};  // interned, see Profiler::intern
+  std::uint64_t start_ns{0};
+  std::uint64_t dur_ns{0};
+  std::uint32_t entities{0};
+  std::uint32_t allocs{0};
+  std::uint32_t tid{0};
+};
+
+class ProfileRing {
+public:
+  static constexpr std::size_t kCapacity = 8192; // power of two
+
+  explicit ProfileRing(std::uint32_t tid) : tid_(tid) {}
+
+  void push(const ProfileEvent& ev) {
+    const std::uint64_t h = head_.load(std::memory_order_relaxed);
+    buf_[h & (kCapacity - 1)] = ev;
+    head_.store(h + 1, std::memory_order_release);
+  }
+
+  // Appends the events still resident in the ring; anything the writer may
+  // have overwritten while copying is dropped.
+  void snapshot(std::vector<ProfileEvent>& out) const;
+
+  std::uint32_t tid() const { return tid_; }
+
+private:
+  std::array<ProfileEvent, kCapacity> buf_{};
+  std::atomic<std::uint64_t> head_{0};
+  std::uint32_t tid_;
+};
+
+struct ProfileSummary {
+  std::string name;
+  std::size_t samples{0};
+  double p50_us{0}, p99_us{0}, max_us{0};
+  double mean_entities{0};
+  double mean_allocs{0};
+};
+
+namespace Profiler {
+
+std::uint64_t nowNs();
+ProfileRing& threadRing();
+const char* intern(const std::string& name);
+
+// operator new calls made by this thread (0 when profiling is compiled out)
+std::uint64_t threadAllocs();
+
+// Allocations made inside a no-alloc scope, all threads (EXECSIM_ALLOC_CHECK)
+std::uint64_t allocViolations();
+// Nesting of the calling thread's no-alloc scopes; 0 means allocating is fine
+unsigned& noAllocDepth();
+
+std::vector<ProfileEvent> collect();
+
+// Rolling p50/p99 over the most recent `window` events per name.
+std::vector<ProfileSummary> summarize(std::size_t window = 1000);
+
+// Chrome trace-event JSON (chrome://tracing, Perfetto)
+bool writeChromeTrace(const std::string& path);
+
+} // namespace Profiler
+
+class ProfileScope {
+public:
+  ProfileScope(const char* name, std::uint32_t entities)
+      : name_(name), entities_(entities),
+        allocs0_(Profiler::threadAllocs()), t0_(Profiler::nowNs()) {}
+
+  ~ProfileScope() {
+    const std::uint64_t t1 = Profiler::nowNs();
+    auto& ring = Profiler::threadRing();
+    ring.push({name_, t0_, t1 - t0_, entities_,
+               static_cast<std::uint32_t>(Profiler::threadAllocs() - allocs0_), ring.tid()});
+  }
+
+private:
+  const char*   name_;
+  std::uint32_t entities_;
+  std::uint64_t allocs0_;
+  std::uint64_t t0_;
+};
+
+// Marks a region that must not touch the heap, e.g. one tick.
+class NoAllocScope {
+public:
+  NoAllocScope() { ++Profiler::noAllocDepth(); }
+  ~NoAllocScope() { --Profiler::noAllocDepth(); }
+  NoAllocScope(const NoAllocScope&) = delete;
+  NoAllocScope& operator=(const NoAllocScope&) = delete;
+};
+
+// Lifts the check for work that grows storage by design (checkpoints, the
+// historian's sealed blocks) inside an otherwise allocation-free region.
+class AllowAllocScope {
+public:
+  AllowAllocScope() : saved_(Profiler::noAllocDepth()) { Profiler::noAllocDepth() = 0; }
+  ~AllowAllocScope() { Profiler::noAllocDepth() = saved_; }
+  AllowAllocScope(const AllowAllocScope&) = delete;
+  AllowAllocScope& operator=(const AllowAllocScope&) = delete;
+
+private:
+  unsigned saved_;
+};
+
+#define SIM_PROFILE_CONCAT2(a, b) a##b
+#define SIM_PROFILE_CONCAT(a, b) SIM_PROFILE_CONCAT2(a, b)
+
+#if defined(EXECSIM_ALLOC_CHECK) && EXECSIM_ALLOC_CHECK
+#define SIM_NO_ALLOC_SCOPE() NoAllocScope SIM_PROFILE_CONCAT(sim_no_alloc_, __LINE__)
+#define SIM_ALLOW_ALLOC_SCOPE() AllowAllocScope SIM_PROFILE_CONCAT(sim_allow_alloc_, __LINE__)
+#else
+#define SIM_NO_ALLOC_SCOPE() ((void)0)
+#define SIM_ALLOW_ALLOC_SCOPE() ((void)0)
+#endif
+
+#if defined(EXECSIM_PROFILING) && EXECSIM_PROFILING
+#define SIM_PROFILE_SCOPE(name, entities) \
+  ProfileScope SIM_PROFILE_CONCAT(sim_profile_scope_, __LINE__)((name), static_cast<std::uint32_t>(entities))
+#else
+#define SIM_PROFILE_SCOPE(name, entities) ((void)0)
+#endif
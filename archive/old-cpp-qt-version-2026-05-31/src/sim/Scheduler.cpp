@@ -0,0 +1,181 @@
+#include "Scheduler.hpp"
+#include "WorkPool.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+template<typename... T>
+void touchStorages(entt::registry& r, ComponentTypes<T...>) {
+    (r.storage<T>(), ...);
+}
+}
+
+void prepareStorages(entt::registry& r) {
+    touchStorages(r, AllComponents{});
+}
+
+void reserveStorages(entt::registry& r) {
+    prepareStorages(r);
+    auto& responses = r.storage<AlarmResponse>();
+    const auto& alarms = r.storage<Alarmable>();
+    responses.reserve(alarms.size());
+
+    // Sparse pages arrive with the first entity on them: add and drop a
+    // response wherever one is missing (always the last element, so the
+    // existing order is untouched)
+    for (auto e : alarms) {
+        if (!responses.contains(e)) {
+            r.emplace<AlarmResponse>(e);
+            r.remove<AlarmResponse>(e);
+        }
+    }
+}
+
+void Scheduler::add(SystemDesc sys) {
+    systems_.push_back(std::move(sys));
+    built_ = false;
+}
+
+void Scheduler::clear() {
+    systems_.clear();
+    built_ = false;
+}
+
+bool Scheduler::setRate(const std::string& name, SystemRate rate) {
+    rate.every    = std::max(1u, rate.every);
+    rate.substeps = std::max(1u, rate.substeps);
+    for (auto& sys : systems_) {
+        if (sys.name == name) {
+            sys.rate = rate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Scheduler::build() {
+    const std::size_t n = systems_.size();
+    timings_.assign(n, {});
+    succ_.assign(n, {});
+    indegree_.assign(n, 0);
+
+    // Edge i→j (i before j in documented order) on any read/write overlap
+    for (std::size_t j = 0; j < n; ++j) {
+        for (std::size_t i = 0; i < j; ++i) {
+            const auto& a = systems_[i];
+            const auto& b = systems_[j];
+            const bool conflict = (a.writes & (b.reads | b.writes)) || (a.reads & b.writes);
+            if (conflict) {
+                succ_[i].push_back(j);
+                ++indegree_[j];
+            }
+        }
+    }
+
+    remaining_ = std::make_unique<std::atomic<int>[]>(n);
+
+#if defined(EXECSIM_PROFILING) && EXECSIM_PROFILING
+    profile_names_.clear();
+    for (const auto& sys : systems_)
+        profile_names_.push_back(Profiler::intern(sys.name));
+#endif
+    built_ = true;
+}
+
+void Scheduler::exec(entt::registry& r, float dt, std::size_t i) {
+    const SystemRate rate = systems_[i].rate;
+    if (step_ % rate.every != 0)
+        return; // not due; successors still release as usual
+
+    SIM_PROFILE_SCOPE(profile_names_[i], systems_[i].count ? systems_[i].count(r) : 0);
+    const auto t0 = std::chrono::steady_clock::now();
+    if (rate.every == 1 && rate.substeps == 1) {
+        systems_[i].run(r, dt);
+    } else {
+        const float h = dt * static_cast<float>(rate.every) / static_cast<float>(rate.substeps);
+        for (unsigned k = 0; k < rate.substeps; ++k)
+            systems_[i].run(r, h);
+    }
+    const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+
+    auto& t = timings_[i];
+    t.last_us = us;
+    t.avg_us  = t.calls == 0 ? us : t.avg_us + 0.05 * (us - t.avg_us);
+    ++t.calls;
+}
+
+// Tasks capture only (this, index) so std::function keeps them inline and
+// a parallel tick doesn't allocate; the rest lives in run_*.
+void Scheduler::execParallel(std::size_t i) {
+    SIM_NO_ALLOC_SCOPE();
+    exec(*run_r_, run_dt_, i);
+    for (std::size_t s : succ_[i]) {
+        if (remaining_[s].fetch_sub(1, std::memory_order_acq_rel) == 1)
+            run_pool_->submit([this, s] { execParallel(s); });
+    }
+}
+
+void Scheduler::run(entt::registry& r, float dt, WorkPool* pool, std::uint64_t step) {
+    if (!built_)
+        build();
+    step_ = step;
+
+    if (!pool || pool->size() <= 1) {
+        for (std::size_t i = 0; i < systems_.size(); ++i)
+            exec(r, dt, i);
+        return;
+    }
+
+    for (std::size_t i = 0; i < systems_.size(); ++i)
+        remaining_[i].store(indegree_[i], std::memory_order_relaxed);
+
+    run_r_ = &r;
+    run_dt_ = dt;
+    run_pool_ = pool;
+    pool->reserve(systems_.size());  // no-op once sized
+    for (std::size_t i = 0; i < systems_.size(); ++i)
+        if (indegree_[i] == 0)
+            pool->submit([this, i] { execParallel(i); });
+    pool->wait();
+}
+
+void Scheduler::runOne(entt::registry& r, float dt, std::size_t i, std::uint64_t step) {
+    if (!built_)
+        build();
+    step_ = step;
+    exec(r, dt, i);
+}
+
+std::vector<std::size_t> Scheduler::criticalPath() const {
+    const std::size_t n = systems_.size();
+    if (n == 0 || timings_.size() != n)
+        return {};
+
+    // Index order is already topological (edges only go forward)
+    std::vector<double> finish(n, 0.0);
+    std::vector<std::size_t> prev(n, n);
+    for (std::size_t i = 0; i < n; ++i) {
+        finish[i] += timings_[i].avg_us;
+        for (std::size_t s : succ_[i]) {
+            if (finish[i] > finish[s]) {
+                finish[s] = finish[i];
+                prev[s] = i;
+            }
+        }
+    }
+
+    std::size_t end = static_cast<std::size_t>(std::max_element(finish.begin(), finish.end()) - finish.begin());
+    std::vector<std::size_t> path;
+    for (std::size_t i = end; i != n; i = prev[i])
+        path.push_back(i);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+double Scheduler::criticalPathUs() const {
+    double sum = 0.0;
+    for (std::size_t i : criticalPath())
+        sum += timings_[i].avg_us;
+    return sum;
+}
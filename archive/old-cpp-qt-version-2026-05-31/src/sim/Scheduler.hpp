@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <entt/entt.hpp>
+#include "ComponentReflect.hpp"
+
+class WorkPool;
+
+// One bit per component type, in AllComponents order (ComponentReflect.hpp).
+using ComponentSet = std::uint64_t;
+
+template<typename... T>
+constexpr ComponentSet Access = (ComponentSet{0} | ... | (ComponentSet{1} << componentIndex<T>()));
+
+// Multi-rate: a slow system runs on every `every`-th tick with the dt it
+// skipped (so utilities can step at 1 Hz while hydraulics step at 100 Hz), a
+// fast one runs `substeps` times per tick on dt/substeps. Ticks are counted
+// from the runner's step, so replay from a checkpoint hits the same ticks.
+struct SystemRate {
+  unsigned every{1};
+  unsigned substeps{1};
+};
+
+struct SystemDesc {
+  std::string name;
+  std::function<void(entt::registry&, float)> run;
+  ComponentSet reads{0};
+  ComponentSet writes{0};
+  std::size_t (*count)(entt::registry&){nullptr};  // entities processed, for the profiler
+  SystemRate rate{};
+};
+
+template<typename T>
+std::size_t entityCount(entt::registry& r) { return r.storage<T>().size(); }
+
+struct SystemTiming {
+  double last_us{0};
+  double avg_us{0};     // exponential moving average
+  std::uint64_t calls{0};
+};
+
+// Builds a DAG from each system's declared read/write sets and runs
+// independent systems concurrently on a WorkPool. Systems are added in the
+// documented pipeline order; whenever two systems conflict (one writes what
+// the other reads or writes) the earlier one runs first, so results match
+// the sequential pipeline.
+class Scheduler {
+public:
+  void add(SystemDesc sys);
+  void clear();
+  void build();
+  bool setRate(const std::string& name, SystemRate rate);  // false: no such system
+
+  // Sequential when pool is null; otherwise runs the DAG on the pool.
+  // `step` picks which multi-rate systems are due this tick.
+  void run(entt::registry& r, float dt, WorkPool* pool = nullptr, std::uint64_t step = 0);
+  // Just system i, sequentially, if it is due at `step`.
+  void runOne(entt::registry& r, float dt, std::size_t i, std::uint64_t step);
+
+  std::size_t size() const { return systems_.size(); }
+  const SystemDesc& system(std::size_t i) const { return systems_[i]; }
+  const SystemTiming& timing(std::size_t i) const { return timings_[i]; }
+  const std::vector<std::size_t>& successors(std::size_t i) const { return succ_[i]; }
+
+  // Longest chain of dependent systems by average duration.
+  std::vector<std::size_t> criticalPath() const;
+  double criticalPathUs() const;
+
+private:
+  void exec(entt::registry& r, float dt, std::size_t i);
+  void execParallel(std::size_t i);
+
+  std::vector<SystemDesc> systems_;
+  std::vector<SystemTiming> timings_;
+  std::vector<std::vector<std::size_t>> succ_;
+  std::vector<int> indegree_;
+  std::unique_ptr<std::atomic<int>[]> remaining_;
+  std::vector<const char*> profile_names_;
+  std::uint64_t step_{0};  // tick being run
+  entt::registry* run_r_{nullptr};  // parallel run in progress
+  float run_dt_{0.0f};
+  WorkPool* run_pool_{nullptr};
+  bool built_{false};
+};
+
+// Storage creation in EnTT is not thread-safe; create every pool up front
+// before the first parallel run.
+void prepareStorages(entt::registry& r);
+
+// prepareStorages plus room for the components a run may add: an
+// AlarmResponse slot (packed and sparse) for every Alarmable, so toggling
+// responses mid-run reuses memory instead of growing the pool.
+void reserveStorages(entt::registry& r);
@@ -0,0 +1,49 @@
+#include "SimClock.hpp"
+#include <algorithm>
+#include <climits>
+
+void SimClock::setTimeScale(double scale) {
+    scale_ = std::clamp(scale, 0.1, 1000.0);
+}
+
+int SimClock::beginFrame(double wall_dt_s) {
+    acc_ += std::max(0.0, wall_dt_s) * scale_;
+    // A stalled frame (debugger, sleep) can owe more steps than fit in an
+    // int; anything past max lag would be dropped at endFrame anyway
+    shed();
+    due_ = static_cast<int>(std::min(acc_ / dt_, static_cast<double>(INT_MAX)));
+    return std::min(due_, max_steps_);
+}
+
+void SimClock::endFrame(int steps_run, double frame_wall_s) {
+    steps_run = std::clamp(steps_run, 0, due_);
+    acc_ -= steps_run * dt_;
+
+    ++stats_.frames;
+    stats_.steps += static_cast<std::uint64_t>(steps_run);
+    if (steps_run < due_)
+        ++stats_.overruns;
+
+    shed();
+    stats_.lag_s = std::max(0.0, acc_ - dt_);  // less than one step isn't lag
+    stats_.max_lag_s = std::max(stats_.max_lag_s, stats_.lag_s);
+    stats_.last_frame_wall_s = frame_wall_s;
+    due_ = 0;
+}
+
+// Sheds what's owed beyond max lag rather than trying to catch up forever.
+// The lag is wall time, so at 1000x a frame may owe far more sim time than
+// max_lag_s_ before it's really behind.
+void SimClock::shed() {
+    const double owed_max = max_lag_s_ * scale_ + dt_;
+    if (acc_ > owed_max) {
+        stats_.dropped_s += acc_ - owed_max;
+        acc_ = owed_max;
+    }
+}
+
+void SimClock::reset() {
+    acc_ = 0.0;
+    due_ = 0;
+    stats_ = {};
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+
+struct ClockStats {
+  std::uint64_t frames{0};
+  std::uint64_t steps{0};
+  std::uint64_t overruns{0};   // frames that could not run every due step
+  double lag_s{0.0};           // sim time still owed after the last frame
+  double max_lag_s{0.0};
+  double dropped_s{0.0};       // sim time discarded once the lag passed the max
+  double last_frame_wall_s{0.0};
+};
+
+// Fixed-step simulation clock. Wall time (scaled by the time-scale
+// multiplier) accumulates; each frame runs as many whole dt steps as are
+// due, capped by max steps and a wall-clock budget. Steps that don't fit
+// stay owed (lag) and are caught up later; once the sim is more than
+// max lag of wall time behind, the excess is dropped so a slow machine
+// can't spiral. The sim itself only ever sees the fixed dt, so runs stay
+// deterministic at any speed.
+class SimClock {
+public:
+  explicit SimClock(double fixed_dt = 0.02) : dt_(fixed_dt) {}
+
+  void setFixedDt(double dt) { dt_ = dt > 0.0 ? dt : dt_; }
+  double fixedDt() const { return dt_; }
+
+  void setTimeScale(double scale);  // clamped to 0.1x .. 1000x
+  double timeScale() const { return scale_; }
+
+  void setMaxStepsPerFrame(int steps) { max_steps_ = steps > 0 ? steps : 1; }
+  int maxStepsPerFrame() const { return max_steps_; }
+
+  void setFrameBudget(double wall_s) { budget_s_ = wall_s; }
+  double frameBudget() const { return budget_s_; }
+
+  // Wall seconds behind real time before owed steps are dropped; the sim
+  // time this allows grows with the time scale.
+  void setMaxLag(double wall_s) { max_lag_s_ = wall_s; }
+
+  // Adds elapsed wall time, dropping any past max lag, and returns how many
+  // steps the caller should run.
+  int beginFrame(double wall_dt_s);
+  // Reports what actually ran; anything short of what was due becomes lag,
+  // and lag past the max is dropped here.
+  void endFrame(int steps_run, double frame_wall_s);
+
+  // Fraction of a step left in the accumulator (for display interpolation)
+  double alpha() const { return acc_ / dt_; }
+
+  void reset();
+  const ClockStats& stats() const { return stats_; }
+
+private:
+  void shed();  // drops acc_ past max lag into stats_.dropped_s
+
+  double dt_;
+  double scale_{1.0};
+  double acc_{0.0};
+  double budget_s_{0.012};
+  double max_lag_s_{2.0};
+  int max_steps_{1000};
+  int due_{0};
+  ClockStats stats_;
+};
@@ -1,90 +1,101 @@
-#include "sim/Loader.hpp"
 #include "sim/SimCore.hpp"
-#include "sim/Systems.hpp"
 #include "Components.hpp"
 #include <algorithm>
 #include <QDebug>
 
-int globalInt = 0;
-
 SimCore::SimCore(QObject* parent) : QObject(parent) {
-    connect(&timer_, &QTimer::timeout, this, &SimCore::onTick);
+    connect(&timer_, &QTimer::timeout, this, &SimCore::onFrame);
     timer_.setTimerType(Qt::PreciseTimer);
 }
 
 void SimCore::loadDefaultScenario() {
-    // Load ECS entities based on JSON components
-    if (!Loader::loadPlant("plant_default.json", registry_, entityFromId)) {
+    if (!runner_.loadDefaultScenario("plant_default.json")) {
         qDebug() << "Could not load JSON plant_default.json";
     }
-
-    // Site singletons
-    auto site = registry_.create();
-    registry_.emplace<HumanFactors>(site, 0.7f, 0.2f, 8.0f, 3, 1.0f);
-    registry_.emplace<SiteKPI>(site);
 }
 
 void SimCore::start(float hz) {
-    dt_ = 1.0f / std::max(1.0f, hz);
-    int interval_ms = static_cast<int>(dt_ * 1000.0f);
-    timer_.start(interval_ms);
+    runner_.setDt(1.0f / std::max(1.0f, hz));
+    clock_.setFixedDt(runner_.dt());
+
+    // The timer only paces frames; elapsed wall time decides how many steps run
+    wall_.start();
+    last_ns_ = 0;
+    timer_.start(std::clamp(static_cast<int>(runner_.dt() * 1000.0f), 1, 16));
 }
 
 void SimCore::stop() {
     timer_.stop();
 }
 
-// Control → Actuator → Hydraulics → HeatExchanger → Steam → Cooling → UtilitySystem → BoilerSystem → RefrigSystem → Alarm → HumanFactors → Response → Analytics
-void SimCore::onTick() {
-    // qDebug() << "Tick: " << globalInt;
-    // globalInt++;
-    ControlSystem(registry_, dt_);
-    ActuatorSystem(registry_, dt_);
-    HydraulicsSystem(registry_, dt_);
-    HeatExchangerSystem(registry_, dt_);
-    Steam(registry_, dt_);
-    Cooling(registry_, dt_);
-    UtilitySystem(registry_, dt_);
-    BoilerSystem(registry_, dt_);
-    RefrigSystem(registry_, dt_);
-    AlarmSystem(registry_);
-    HumanFactorsSystem(registry_, dt_);
-    ResponseSystem(registry_, dt_);
-    AnalyticsSystem(registry_, dt_);
-    ++step_;
-    emit frameReady();
+// Pipeline order lives in SimRunner::buildPipeline()
+void SimCore::onFrame() {
+    const qint64 now_ns = wall_.nsecsElapsed();
+    const double wall_dt = (now_ns - last_ns_) * 1e-9;
+    last_ns_ = now_ns;
+
+    QElapsedTimer frame;
+    frame.start();
+
+    const int due = clock_.beginFrame(wall_dt);
+    int ran = 0;
+    while (ran < due) {
+        runner_.tick();
+        ++ran;
+        if (frame.nsecsElapsed() * 1e-9 > clock_.frameBudget())
+            break; // leave the rest as lag; caught up next frame
+    }
+    clock_.endFrame(ran, frame.nsecsElapsed() * 1e-9);
+
+    if (ran > 0) {
+        publisher_.publish(runner_.step(), runner_.simTime());
+        emit frameReady();
+    }
 }
 
-void SimCore::updateModel(PlantModel& model)
+void SimCore::bindModel(PlantModel& model)
 {
-    for (auto it = model.nodes_.begin(); it != model.nodes_.end(); ++it) {
-        const QString& id = it.key();
-        PlantNode& node = it.value();
-
-        entt::entity e = entityFromId[id.toStdString()];
-
-        if (auto* t = registry_.try_get<Tank>(e))
-            node.dparams["level"] = t->level;
+    std::vector<entt::entity> entities;
+    slots_.clear();
+    last_dirty_.clear();
 
-        if (auto* t = registry_.try_get<Tank>(e)) {
-            qDebug() << "Tank level =" << t->level;
-        }
-
-        if (auto* p = registry_.try_get<Pump>(e))
-            node.dparams["flow"] = p->flow;
-
-        if (auto* hx = registry_.try_get<HeatExchanger>(e))
-            node.dparams["flow_rate"] = hx->flow_rate;
-
-        if (auto* p = registry_.try_get<Pump>(e))
-            node.bparams["running"] = p->running;
+    for (auto it = model.nodes_.begin(); it != model.nodes_.end(); ++it) {
+        auto found = runner_.entityFromId.find(it.key().toStdString());
+        entities.push_back(found != runner_.entityFromId.end() ? found->second : entt::entity{entt::null});
+        slots_.push_back(&it.value());
+    }
 
-        if (auto* hx = registry_.try_get<HeatExchanger>(e))
-            node.bparams["power_on"] = hx->power_on;
+    publisher_.bind(runner_.reg(), entities);
+    last_dirty_.reserve(slots_.size());
+    model.changed_.clear();
+    model.changed_.reserve(slots_.size());
+    publisher_.publish(runner_.step(), runner_.simTime());
+}
 
-        if (auto* t = registry_.try_get<HeatExchanger>(e))
-            qDebug() << "Power On" << t->power_on;
+bool SimCore::updateModel(PlantModel& model)
+{
+    if (!publisher_.acquire())
+        return false;
+
+    for (std::uint32_t slot : last_dirty_)
+        slots_[slot]->live.changed = 0;
+    last_dirty_.clear();
+    model.changed_.clear();
+
+    const SnapshotFrame& f = publisher_.front();
+    for (std::uint32_t slot : f.dirty) {
+        const EntitySnapshot& s = f.state[slot];
+        PlantNode::Live& live = slots_[slot]->live;
+        live.level     = s.level;
+        live.flow      = s.flow;
+        live.flow_rate = s.flow_rate;
+        live.running   = s.running;
+        live.power_on  = s.power_on;
+        live.present   = s.present;
+        live.changed   = f.changed[slot] & s.present;
+        last_dirty_.push_back(slot);
+        if (live.changed)
+            model.changed_.push_back(slots_[slot]);
     }
+    return true;
 }
-
-
@@ -1,9 +1,16 @@
 #pragma once
+#include <QElapsedTimer>
 #include <QObject>
 #include <QTimer>
 #include <entt/entt.hpp>
+#include "SimRunner.hpp"
+#include "SimClock.hpp"
+#include "SnapshotChannel.hpp"
+#include <vector>
 #include "../ui/PlantModel.hpp"
 
+// Qt front for SimRunner: a QTimer paces frames, SimClock decides how many
+// fixed dt steps each frame owes, and updateModel syncs the UI model.
 class SimCore : public QObject {
   Q_OBJECT
 public:
@@ -11,22 +18,35 @@ public:
   void loadDefaultScenario();
   void start(float hz=50.f);
   void stop();
-  void updateModel(PlantModel& model);
 
-  entt::registry& reg() { return registry_; }
-  quint64 step() const { return step_; }
+  // Binds UI nodes to entities once; call after both are loaded.
+  void bindModel(PlantModel& model);
+  // Applies the newest snapshot; only nodes that changed are touched, and
+  // those are listed in model.changed_ for the scene.
+  // Returns false if no new frame was published since the last call.
+  bool updateModel(PlantModel& model);
 
-  std::unordered_map<std::string, entt::entity> entityFromId;
+  void setTimeScale(double scale) { clock_.setTimeScale(scale); }
+  const SimClock& clock() const { return clock_; }
+
+  entt::registry& reg() { return runner_.reg(); }
+  SimRunner& runner() { return runner_; }
+  quint64 step() const { return runner_.step(); }
 
 signals:
   void frameReady();
 
 private slots:
-  void onTick();
+  void onFrame();
 
 private:
-  entt::registry registry_;
+  SimRunner runner_;
+  SimClock clock_;
   QTimer timer_;
-  float dt_{0.02f};
-  quint64 step_{0};
+  QElapsedTimer wall_;
+  qint64 last_ns_{0};
+
+  SnapshotPublisher publisher_;
+  std::vector<PlantNode*> slots_;          // slot index → UI node
+  std::vector<std::uint32_t> last_dirty_;  // slots whose changed bits we set
 };
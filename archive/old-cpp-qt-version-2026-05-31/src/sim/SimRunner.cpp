@@ -0,0 +1,392 @@
+#include "SimRunner.hpp"
+#include "Loader.hpp"
+#include "PlantImage.hpp"
+#include "Systems.hpp"
+#include "AlarmEngine.hpp"
+#include "AlarmMetrics.hpp"
+#include "Components.hpp"
+#include "CoolingNetwork.hpp"
+#include "FlowNetwork.hpp"
+#include "KpiEngine.hpp"
+#include "SiteContext.hpp"
+#include "SteamNetwork.hpp"
+#include "WorkPool.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+SimRunner::SimRunner(float dt) : dt_(std::max(1e-4f, dt)) {
+    buildPipeline();
+}
+
+SimRunner::~SimRunner() = default;
+
+void SimRunner::setBatched(bool on) {
+    batched_ = on;
+    buildPipeline();
+}
+
+void SimRunner::setIntegration(const IntegrationConfig& cfg) {
+    integration_ = cfg;
+    registry_.ctx().insert_or_assign(integration_);
+    branch_ = true;
+}
+
+bool SimRunner::setRate(const std::string& system, SystemRate rate) {
+    if (!scheduler_.setRate(system, rate))
+        return false;
+    rates_[system] = rate;
+    branch_ = true;
+    return true;
+}
+
+void SimRunner::setThreads(unsigned threads) {
+    if (threads > 1) {
+        pool_ = std::make_unique<WorkPool>(threads);
+        pool_->reserve(scheduler_.size());
+        prepareStorages(registry_);
+    } else {
+        pool_.reset();
+    }
+}
+
+unsigned SimRunner::threads() const {
+    return pool_ ? pool_->size() : 1u;
+}
+
+bool SimRunner::loadPlant(const std::string& path) {
+    if (PlantImage::isImage(path)) {
+        // Scratch registry, as in loadSnapshot: a bad image leaves the current plant
+        entt::registry loaded;
+        std::unordered_map<std::string, entt::entity> ids;
+        if (!PlantImage::load(path, loaded, ids))
+            return false;
+        registry_ = std::move(loaded);
+        entityFromId = std::move(ids);
+        plant_ = {};
+        finishLoad();
+        return true;
+    }
+    if (!Loader::parsePlant(path, plant_))
+        return false;
+    return loadPlant(plant_);
+}
+
+bool SimRunner::loadPlant(const PlantDescription& plant) {
+    if (!Loader::buildPlant(plant, registry_, entityFromId))
+        return false;
+    finishLoad();
+    return true;
+}
+
+void SimRunner::finishLoad() {
+    registry_.ctx().insert_or_assign(KpiEngine{});
+    registry_.ctx().insert_or_assign(AlarmMetrics{});
+    registry_.ctx().insert_or_assign(integration_);
+    registry_.ctx().erase<AlarmEngine>();  // a new plant starts with no responses in flight
+    rebindCaches();
+    preallocate();
+}
+
+// Per-scenario sizing: whatever a tick appends to or adds gets its capacity
+// from the loaded plant here (networks and AlarmEngine size themselves in
+// compile), so steady ticks don't touch the heap. EXECSIM_ALLOC_CHECK
+// builds report any tick that still does.
+void SimRunner::preallocate() {
+    reserveStorages(registry_);
+    reserveLanes(registry_, batch_);
+    if (pool_)
+        pool_->reserve(scheduler_.size());
+}
+
+// Everything that holds component pointers
+void SimRunner::rebindCaches() {
+    compileNetwork();
+    compileAlarms();
+    if (historian_)
+        historian_->rebind(registry_);
+}
+
+Historian& SimRunner::enableHistorian(const HistorianConfig& cfg) {
+    historian_ = std::make_unique<Historian>(cfg);
+    historian_->addDefaultTags(registry_, entityFromId);
+    return *historian_;
+}
+
+bool SimRunner::saveSnapshot(const std::string& path) {
+    return PlantImage::save(path, registry_, entityFromId, {step_, sim_time_, dt_});
+}
+
+bool SimRunner::loadSnapshot(const std::string& path) {
+    if (!PlantImage::isImage(path)) {
+        std::cerr << path << " is not a snapshot\n";
+        return false;
+    }
+
+    // Into a scratch registry first, so a bad image leaves the current plant
+    entt::registry loaded;
+    std::unordered_map<std::string, entt::entity> ids;
+    ImageClock clock;
+    if (!PlantImage::load(path, loaded, ids, &clock))
+        return false;
+
+    registry_ = std::move(loaded);
+    entityFromId = std::move(ids);
+    plant_ = {};
+    step_ = clock.step;
+    sim_time_ = clock.sim_time;
+    if (clock.dt > 0.0f)
+        dt_ = clock.dt;
+    finishLoad();
+    return true;
+}
+
+void SimRunner::compileNetwork() {
+    if (auto* topo = registry_.ctx().find<PlantTopology>())
+        registry_.ctx().insert_or_assign(FlowNetwork::compile(registry_, *topo));
+    registry_.ctx().insert_or_assign(SteamNetwork::compile(registry_));
+    registry_.ctx().insert_or_assign(CoolingNetwork::compile(registry_));
+    registry_.ctx().insert_or_assign(SiteContext::compile(registry_, registry_.ctx().find<SiteContext>()));
+}
+
+void SimRunner::compileAlarms() {
+    AlarmTimerState keep;
+    if (auto* old = registry_.ctx().find<AlarmEngine>())
+        keep = old->state();
+    auto& alarms = registry_.ctx().insert_or_assign(AlarmEngine::compile(registry_, keep));
+    if (auto* metrics = registry_.ctx().find<AlarmMetrics>()) {
+        std::size_t entities = 0;
+        for (auto e : alarms.entity)
+            entities = std::max<std::size_t>(entities, entt::to_entity(e) + 1u);
+        metrics->reserve(entities, alarms.size());
+    }
+
+    // AlarmSystem must run after whatever writes the fields it watches
+    const ComponentSet reads = Access<Tank, Alarmable> | alarms.sources;
+    if (reads != alarm_reads_) {
+        alarm_reads_ = reads;
+        buildPipeline();
+    }
+}
+
+bool SimRunner::loadDefaultScenario(const std::string& path) {
+    // Load ECS entities based on JSON components (or a plant image)
+    const bool ok = loadPlant(path);
+    if (!ok) {
+        std::cerr << "Could not load plant " << path << "\n";
+        plant_ = {};
+    }
+    addSiteSingletons();
+    return ok;
+}
+
+bool SimRunner::loadDefaultScenario(const PlantDescription& plant) {
+    const bool ok = loadPlant(plant);
+    addSiteSingletons();
+    return ok;
+}
+
+// Default crew and KPIs for site 0, unless the plant brought its own
+void SimRunner::addSiteSingletons() {
+    auto* sites = registry_.ctx().find<SiteContext>();
+    if (sites && sites->primary().id == 0 && (sites->primary().human || sites->primary().kpi))
+        return;
+    auto site = registry_.create();
+    registry_.emplace<HumanFactors>(site, 0.7f, 0.2f, 8.0f, 3, 1.0f);
+    registry_.emplace<SiteKPI>(site);
+    registry_.ctx().insert_or_assign(SiteContext::compile(registry_, sites));
+}
+
+// Control → Actuator → Hydraulics → HeatExchanger → Steam → Cooling → UtilitySystem → BoilerSystem → RefrigSystem → Alarm → HumanFactors → Response → Analytics
+// Each system declares what it reads and writes; the scheduler keeps this
+// order wherever the sets overlap and runs the rest concurrently.
+void SimRunner::buildPipeline() {
+    scheduler_.clear();
+
+    if (batched_) {
+        scheduler_.add({"Control", [this](entt::registry& r, float dt) { ControlSystemBatched(r, batch_, dt); },
+                        Access<PID>, Access<PID>, entityCount<PID>});
+        scheduler_.add({"Actuator", [this](entt::registry& r, float dt) { ActuatorSystemBatched(r, batch_, dt); },
+                        Access<PID, ValveActuator>, Access<ValveActuator>, entityCount<ValveActuator>});
+    } else {
+        scheduler_.add({"Control", ControlSystem, Access<PID>, Access<PID>, entityCount<PID>});
+        scheduler_.add({"Actuator", ActuatorSystem, Access<PID, ValveActuator>, Access<ValveActuator>, entityCount<ValveActuator>});
+    }
+    scheduler_.add({"Hydraulics", HydraulicsSystem,
+                    Access<Pump, ValveActuator, Pipe, Tank, PID>, Access<Pump, Tank, PID>, entityCount<Pump>});
+    if (batched_)
+        scheduler_.add({"HeatExchanger", [this](entt::registry& r, float dt) { HeatExchangerSystemBatched(r, batch_, dt); },
+                        Access<HeatExchanger, ValveActuator>, Access<HeatExchanger>, entityCount<HeatExchanger>});
+    else
+        scheduler_.add({"HeatExchanger", HeatExchangerSystem,
+                        Access<HeatExchanger, ValveActuator>, Access<HeatExchanger>, entityCount<HeatExchanger>});
+    scheduler_.add({"Steam", Steam, Access<SteamHeader, SteamLoad, Boiler, PressureReducingValve>,
+                    Access<SteamHeader, SteamLoad, PressureReducingValve>, entityCount<SteamLoad>});
+    scheduler_.add({"Cooling", Cooling, Access<ChilledWaterLoop, CoolingLoad, RefrigerationCompressor>,
+                    Access<ChilledWaterLoop, CoolingLoad>, entityCount<CoolingLoad>});
+    scheduler_.add({"Utility", UtilitySystem, Access<SteamHeader, ChilledWaterLoop, Boiler, RefrigerationCompressor, SiteKPI>,
+                    Access<SiteKPI>});
+    scheduler_.add({"Boiler", BoilerSystem, Access<Boiler, SteamHeader>, Access<Boiler>, entityCount<Boiler>});
+    scheduler_.add({"Refrig", RefrigSystem, Access<RefrigerationCompressor, CoolingTower, ChilledWaterLoop>,
+                    Access<RefrigerationCompressor, CoolingTower>, entityCount<RefrigerationCompressor>});
+    if (batched_)
+        scheduler_.add({"Alarm", [this](entt::registry& r, float) { AlarmSystemBatched(r, batch_); },
+                        alarm_reads_, Access<Alarmable>, entityCount<Alarmable>});
+    else
+        scheduler_.add({"Alarm", [](entt::registry& r, float) { AlarmSystem(r); },
+                        alarm_reads_, Access<Alarmable>, entityCount<Alarmable>});
+    scheduler_.add({"HumanFactors", HumanFactorsSystem, Access<HumanFactors>, Access<HumanFactors>, entityCount<HumanFactors>});
+    scheduler_.add({"Response", ResponseSystem, Access<HumanFactors, Alarmable, AlarmResponse, SiteKPI, Area>,
+                    Access<Alarmable, AlarmResponse, SiteKPI>, entityCount<AlarmResponse>});
+    scheduler_.add({"Analytics", AnalyticsSystem, Access<SiteKPI, Pump>, Access<SiteKPI>, entityCount<Pump>});
+
+    for (const auto& [name, rate] : rates_)
+        scheduler_.setRate(name, rate);
+    scheduler_.build();
+}
+
+void SimRunner::setDt(float dt) {
+    if (dt == dt_)
+        return;
+    dt_ = dt;
+    // Checkpoints carry dt, so a segment between two of them has a fixed dt
+    branch_ = true;
+}
+
+void SimRunner::submit(const Command& c) {
+    pending_.push_back(c);
+}
+
+void SimRunner::enableRecording(const RecordingConfig& cfg) {
+    recording_ = std::make_unique<Recording>(cfg);
+}
+
+// Checkpoint (state before this tick's inputs), then apply this tick's
+// commands: freshly submitted ones when live, journaled ones when replaying.
+void SimRunner::applyInputs() {
+    if (!recording_) {
+        for (auto& c : pending_) {
+            c.step = step_;
+            applyCommand(registry_, c);
+        }
+        pending_.clear();
+        return;
+    }
+
+    // Checkpoints and the journal are recorded history and may allocate
+    auto& rec = *recording_;
+    if (!replaying_ && (branch_ || !pending_.empty())) {
+        SIM_ALLOW_ALLOC_SCOPE();
+        rec.journal.dropFrom(step_);
+        rec.checkpoints.dropAfter(step_);
+        branch_ = false;
+    }
+
+    const std::uint64_t interval = std::max<std::uint64_t>(1, rec.checkpoints.config().interval_steps);
+    const Checkpoint* last = rec.checkpoints.latestAtOrBefore(step_);
+    if (step_ % interval == 0 || !last || last->dt != dt_) {
+        SIM_ALLOW_ALLOC_SCOPE();
+        rec.checkpoints.capture(registry_, step_, sim_time_, dt_, historian_.get());
+        rec.journal.dropBefore(rec.checkpoints.oldestStep());
+    }
+
+    if (!replaying_) {
+        SIM_ALLOW_ALLOC_SCOPE();
+        for (auto& c : pending_) {
+            c.step = step_;
+            rec.journal.append(c);
+        }
+        pending_.clear();
+    }
+
+    auto [first, last_cmd] = rec.journal.at(step_);
+    for (const Command* c = first; c != last_cmd; ++c)
+        applyCommand(registry_, *c);
+}
+
+bool SimRunner::seek(std::uint64_t target) {
+    if (!recording_)
+        return false;
+
+    auto& rec = *recording_;
+    const Checkpoint* cp = rec.checkpoints.latestAtOrBefore(target);
+    if (!cp)
+        return false;
+
+    // Only rewind when running forward from here wouldn't get there
+    if (step_ < cp->step || step_ > target) {
+        if (!rec.checkpoints.restore(*cp, registry_))
+            rebindCaches();
+        rec.checkpoints.restoreContext(*cp, registry_);
+        if (historian_ && cp->historian)
+            historian_->rewindTo(*cp->historian);
+        step_     = cp->step;
+        sim_time_ = cp->sim_time;
+        dt_       = cp->dt;
+    }
+
+    replaying_ = true;
+    while (step_ < target)
+        tick();
+    replaying_ = false;
+    return true;
+}
+
+std::shared_ptr<const CheckpointStore> SimRunner::fork() {
+    RecordingConfig cfg;
+    cfg.budget_bytes = std::numeric_limits<std::size_t>::max();
+    auto store = std::make_shared<CheckpointStore>(cfg);
+    store->capture(registry_, step_, sim_time_, dt_);
+    return store;
+}
+
+bool SimRunner::resume(const CheckpointStore& forked) {
+    const Checkpoint* cp = forked.latestAtOrBefore(std::numeric_limits<std::uint64_t>::max());
+    if (!cp)
+        return false;
+    if (!forked.restore(*cp, registry_))
+        rebindCaches();
+    forked.restoreContext(*cp, registry_);
+    step_     = cp->step;
+    sim_time_ = cp->sim_time;
+    dt_       = cp->dt;
+    branch_   = true;  // whatever was recorded doesn't lead here
+    return true;
+}
+
+void SimRunner::tick() {
+    SIM_PROFILE_SCOPE("Tick", 0);
+    SIM_NO_ALLOC_SCOPE();
+    beginTick();
+    scheduler_.run(registry_, dt_, pool_.get(), step_);
+    endTick();
+}
+
+void SimRunner::beginTick() {
+    applyInputs();
+}
+
+void SimRunner::runSystem(std::size_t i) {
+    scheduler_.runOne(registry_, dt_, i, step_);
+}
+
+void SimRunner::endTick() {
+    ++step_;
+    sim_time_ += dt_;
+    if (historian_) {
+        SIM_ALLOW_ALLOC_SCOPE();  // sealing a block stores history
+        historian_->sample(step_, sim_time_, dt_);
+    }
+}
+
+void SimRunner::run(std::uint64_t steps) {
+    for (std::uint64_t i = 0; i < steps; ++i)
+        tick();
+}
+
+void SimRunner::run_until(double sim_time_s) {
+    // Half-step tolerance so float dt doesn't add or lose a tick at the boundary
+    while (sim_time_ + 0.5 * dt_ < sim_time_s)
+        tick();
+}
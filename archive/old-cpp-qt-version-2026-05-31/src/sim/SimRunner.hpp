@@ -0,0 +1,151 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <entt/entt.hpp>
+#include "BatchSystems.hpp"
+#include "Checkpoint.hpp"
+#include "Commands.hpp"
+#include "Historian.hpp"
+#include "Integrator.hpp"
+#include "Loader.hpp"
+#include "Scheduler.hpp"
+
+class WorkPool;
+
+// Qt-free owner of the registry and the system pipeline.
+// SimCore drives tick() from a QTimer; headless tools call run()/run_until()
+// directly and go as fast as the CPU allows.
+class SimRunner {
+public:
+  explicit SimRunner(float dt = 0.02f);
+  ~SimRunner();
+
+  // Pipeline lambdas capture this
+  SimRunner(const SimRunner&) = delete;
+  SimRunner& operator=(const SimRunner&) = delete;
+
+  bool loadPlant(const std::string& path);
+  bool loadPlant(const PlantDescription& plant);
+  bool loadDefaultScenario(const std::string& path = "plant_default.json");
+  bool loadDefaultScenario(const PlantDescription& plant);
+
+  // Whole-registry binary image (PlantImage) including step and sim time.
+  // loadSnapshot replaces the current registry once the whole image has
+  // loaded, so a failed load keeps the running plant. loadPlant also accepts an
+  // image written by plantconv in place of JSON.
+  bool saveSnapshot(const std::string& path);
+  bool loadSnapshot(const std::string& path);
+
+  // What the last loadPlant(path) parsed; the UI model is built from this
+  // instead of reading the file a second time.
+  const PlantDescription& plant() const { return plant_; }
+
+  // Rebuilds the FlowNetwork from PlantTopology, the Steam/CoolingNetwork
+  // from the utility bus numbers and the SiteContext from Area; call after
+  // structural edits.
+  void compileNetwork();
+  // Rebinds alarm points (AlarmEngine) to their source fields, keeping
+  // responses in progress; call after adding or removing Alarmables.
+  void compileAlarms();
+  // Sizes what ticks append to (pools, batch lanes, pool queues) from the
+  // current plant; loadPlant does this, call it after building or editing
+  // the registry by hand.
+  void preallocate();
+
+  // Allocation-free once the plant is loaded (see preallocate), apart from
+  // recording and the historian; EXECSIM_ALLOC_CHECK enforces it.
+  void tick();
+  void run(std::uint64_t steps);
+
+  // tick() in pieces, for drivers that step several runners one system at a
+  // time (PlantFleet): beginTick() applies this tick's inputs, runSystem(i)
+  // runs pipeline entry i (scheduler().system(i)) at its rate, endTick()
+  // advances the clock and samples the historian.
+  void beginTick();
+  void runSystem(std::size_t i);
+  void endTick();
+  void run_until(double sim_time_s);
+
+  // Batched mode runs Control/Actuator/HeatExchanger/Alarm as SoA SIMD
+  // kernels; results are bit-identical to the scalar systems.
+  void setBatched(bool on);
+  bool batched() const { return batched_; }
+
+  // Integration method per domain (Integrator.hpp); default Euler.
+  void setIntegration(const IntegrationConfig& cfg);
+  const IntegrationConfig& integration() const { return integration_; }
+
+  // Multi-rate stepping by pipeline name (SystemRate), e.g. dt = 0.01 with
+  // Steam/Cooling/Utility/Boiler/Refrig every 100 ticks. Kept across
+  // pipeline rebuilds; returns false for an unknown system.
+  bool setRate(const std::string& system, SystemRate rate);
+
+  // threads > 1 runs independent systems concurrently (see Scheduler).
+  void setThreads(unsigned threads);
+  unsigned threads() const;
+  const Scheduler& scheduler() const { return scheduler_; }
+
+  // Operator input, applied at the start of the next tick and journaled when
+  // recording. Replayed history after the current step is discarded.
+  void submit(const Command& c);
+
+  // Periodic incremental checkpoints plus the command journal; seek() then
+  // rewinds (or fast-forwards) to any recorded step and replays bit-exactly.
+  void enableRecording(const RecordingConfig& cfg = {});
+  void disableRecording() { recording_.reset(); }
+  const Recording* recording() const { return recording_.get(); }
+  bool seek(std::uint64_t step);
+
+  // Copy-on-fork warm start: fork() freezes the current state as a single
+  // checkpoint (components plus the ctx a checkpoint carries) and resume()
+  // puts a runner loaded from the same plant into it. The checkpoint's
+  // chunks are immutable and shared, so any number of runners, on any
+  // threads, can resume from one fork instead of each re-running the
+  // startup transient.
+  std::shared_ptr<const CheckpointStore> fork();
+  bool resume(const CheckpointStore& forked);
+
+  // Samples the default tags (see Historian::addDefaultTags) after every tick.
+  Historian& enableHistorian(const HistorianConfig& cfg = {});
+  void disableHistorian() { historian_.reset(); }
+  Historian* historian() { return historian_.get(); }
+
+  void setDt(float dt);
+  float dt() const { return dt_; }
+  std::uint64_t step() const { return step_; }
+  double simTime() const { return sim_time_; }
+
+  entt::registry& reg() { return registry_; }
+
+  std::unordered_map<std::string, entt::entity> entityFromId;
+
+private:
+  void buildPipeline();
+  void finishLoad();
+  void rebindCaches();
+  void applyInputs();
+  void addSiteSingletons();
+
+  entt::registry registry_;
+  PlantDescription plant_;
+  float dt_{0.02f};
+  std::uint64_t step_{0};
+  double sim_time_{0.0}; // accumulated in double so long runs don't drift
+
+  bool batched_{false};
+  BatchState batch_;
+  IntegrationConfig integration_;
+  std::unordered_map<std::string, SystemRate> rates_;
+  ComponentSet alarm_reads_{Access<Tank, Alarmable>};  // AlarmSystem's sources
+
+  std::vector<Command> pending_;
+  std::unique_ptr<Recording> recording_;
+  std::unique_ptr<Historian> historian_;
+  bool replaying_{false};
+  bool branch_{false}; // an input changed the future: drop recorded history past step_
+
+  Scheduler scheduler_;
+  std::unique_ptr<WorkPool> pool_;
+};
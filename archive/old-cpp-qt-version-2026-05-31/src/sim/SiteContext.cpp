@@ -0,0 +1,76 @@
+#include "SiteContext.hpp"
+#include <algorithm>
+#include <iostream>
+
+int SiteContext::siteOf(entt::registry& r, entt::entity e) {
+    const auto* area = r.try_get<Area>(e);
+    return area ? std::max(0, area->site) : 0;
+}
+
+SiteContext SiteContext::compile(entt::registry& r, SiteContext* keep) {
+    SiteContext ctx;
+
+    // A site exists wherever its singletons do; a plant without any still
+    // gets an empty primary so systems always have one to report into
+    std::vector<int> ids;
+    auto hv = r.view<HumanFactors>();
+    for (auto e : hv)
+        ids.push_back(siteOf(r, e));
+    auto kv = r.view<SiteKPI>();
+    for (auto e : kv)
+        ids.push_back(siteOf(r, e));
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    if (ids.empty())
+        ids.push_back(0);
+
+    ctx.sites.resize(ids.size());
+    ctx.index.assign(static_cast<std::size_t>(ids.back()) + 1, 0);
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        ctx.sites[i].id = ids[i];
+        ctx.index[ids[i]] = static_cast<std::uint32_t>(i);
+    }
+
+    for (auto e : kv) {
+        Site& s = ctx.site(siteOf(r, e));
+        if (s.kpi) {
+            std::cerr << "Two SiteKPI for site " << s.id << "; the second is ignored\n";
+            continue;
+        }
+        s.kpi = &kv.get<SiteKPI>(e);
+        s.entity = e;
+    }
+    for (auto e : hv) {
+        Site& s = ctx.site(siteOf(r, e));
+        if (s.human) {
+            std::cerr << "Two HumanFactors for site " << s.id << "; the second is ignored\n";
+            continue;
+        }
+        s.human = &hv.get<HumanFactors>(e);
+        if (s.entity == entt::entity{entt::null})
+            s.entity = e;
+    }
+
+    auto sv = r.view<SteamHeader>();
+    for (auto e : sv)
+        ctx.site(siteOf(r, e)).steam.push_back(&sv.get<SteamHeader>(e));
+    auto lv = r.view<ChilledWaterLoop>();
+    for (auto e : lv)
+        ctx.site(siteOf(r, e)).chilled.push_back(&lv.get<ChilledWaterLoop>(e));
+    auto bv = r.view<Boiler>();
+    for (auto e : bv)
+        ctx.site(siteOf(r, e)).boilers.push_back(&bv.get<Boiler>(e));
+    auto cv = r.view<RefrigerationCompressor>();
+    for (auto e : cv)
+        ctx.site(siteOf(r, e)).compressors.push_back(&cv.get<RefrigerationCompressor>(e));
+    auto pv = r.view<Pump>();
+    for (auto e : pv)
+        ctx.site(siteOf(r, e)).pumps.push_back(&pv.get<Pump>(e));
+
+    if (keep)
+        for (auto& old : keep->sites)
+            if (Site& s = ctx.site(old.id); s.id == old.id)
+                s.kpis = std::move(old.kpis);
+
+    return ctx;
+}
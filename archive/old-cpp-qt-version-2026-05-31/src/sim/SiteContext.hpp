@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <entt/entt.hpp>
+#include "Components.hpp"
+#include "KpiEngine.hpp"
+
+// Blackboard for the per-site singletons and utility buses, compiled from
+// the HumanFactors/SiteKPI entities and Area::site (absent means site 0).
+// A registry can hold several sites or units, say a steeping and a
+// refinery area, each with its own crew, KPIs, headers and loops; systems
+// reach them through the pointers cached here instead of scanning views
+// every tick. Pointers are cached like FlowNetwork's, so re-run compile()
+// (SimRunner::compileNetwork does) after adding or removing site, utility
+// or pump components.
+//
+// sites[0] is the primary site, the lowest id. Members whose site has no
+// singletons fall back to it, and the registry-wide KpiEngine and
+// AlarmMetrics report into its SiteKPI; every other site keeps its rolling
+// KPIs in Site::kpis.
+struct SiteContext {
+  struct Site {
+    int id{0};
+    entt::entity entity{entt::null};     // carrier of kpi, else of human
+    HumanFactors* human{nullptr};
+    SiteKPI* kpi{nullptr};
+
+    // Members, in view order
+    std::vector<SteamHeader*> steam;
+    std::vector<ChilledWaterLoop*> chilled;
+    std::vector<Boiler*> boilers;
+    std::vector<RefrigerationCompressor*> compressors;
+    std::vector<const Pump*> pumps;
+
+    KpiEngine kpis;                      // unused for the primary (see KpiEngine in ctx)
+    std::uint32_t active{0};             // scratch: responses in progress
+
+    float reactionMult() const { return human ? human->reaction_time_mult : 1.0f; }
+  };
+
+  std::vector<Site> sites;               // never empty once compiled
+  std::vector<std::uint32_t> index;      // Area::site → position in sites
+
+  std::size_t size() const { return sites.size(); }
+  Site& primary() { return sites.front(); }
+
+  std::uint32_t indexOf(int site) const {
+    return site >= 0 && static_cast<std::size_t>(site) < index.size() ? index[site] : 0u;
+  }
+  Site& site(int id) { return sites[indexOf(id)]; }
+
+  // Area::site of e, 0 without an Area
+  static int siteOf(entt::registry& r, entt::entity e);
+
+  // Sites in `keep` hand their rolling KPIs to the site of the same id
+  static SiteContext compile(entt::registry& r, SiteContext* keep = nullptr);
+};
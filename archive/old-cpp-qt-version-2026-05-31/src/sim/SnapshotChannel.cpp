@@ -0,0 +1,103 @@
+#include "SnapshotChannel.hpp"
+#include "Profiler.hpp"
+
+void SnapshotPublisher::bind(entt::registry& r, const std::vector<entt::entity>& slots) {
+    const std::size_t n = slots.size();
+    tank_.assign(n, nullptr);
+    pump_.assign(n, nullptr);
+    hx_.assign(n, nullptr);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const entt::entity e = slots[i];
+        if (e == entt::null || !r.valid(e))
+            continue;
+        tank_[i] = r.try_get<Tank>(e);
+        pump_[i] = r.try_get<Pump>(e);
+        hx_[i]   = r.try_get<HeatExchanger>(e);
+    }
+
+    // Everything counts as changed until the UI has seen one frame
+    last_.assign(n, EntitySnapshot{});
+    pending_.assign(n, ~0u);
+    pending_slots_.clear();
+    pending_slots_.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        pending_slots_.push_back(static_cast<std::uint32_t>(i));
+
+    channel_.forEach([n](SnapshotFrame& f) {
+        f.state.assign(n, EntitySnapshot{});
+        f.changed.assign(n, 0);
+        f.dirty.clear();
+        f.dirty.reserve(n);
+    });
+    seq_ = 0;
+    consumed_seq_.store(0, std::memory_order_relaxed);
+}
+
+bool SnapshotPublisher::acquire() {
+    if (!channel_.acquire())
+        return false;
+    consumed_seq_.store(channel_.front().seq, std::memory_order_release);
+    return true;
+}
+
+void SnapshotPublisher::publish(std::uint64_t step, double sim_time) {
+    SIM_NO_ALLOC_SCOPE();
+    // If the UI took our last frame, start a fresh change set; otherwise
+    // keep accumulating so the next frame carries the skipped changes too.
+    // A racing acquire only causes redundant bits, never missing ones.
+    if (seq_ != 0 && consumed_seq_.load(std::memory_order_acquire) == seq_) {
+        for (std::uint32_t slot : pending_slots_)
+            pending_[slot] = 0;
+        pending_slots_.clear();
+    }
+
+    SnapshotFrame& f = channel_.back();
+    const std::size_t n = tank_.size();
+
+    for (std::size_t i = 0; i < n; ++i) {
+        EntitySnapshot s;
+        if (const Tank* t = tank_[i]) {
+            s.level = t->level;
+            s.present |= SnapLevel;
+        }
+        if (const Pump* p = pump_[i]) {
+            s.flow = p->flow;
+            s.running = p->running;
+            s.present |= SnapFlow | SnapRunning;
+        }
+        if (const HeatExchanger* hx = hx_[i]) {
+            s.flow_rate = hx->flow_rate;
+            s.power_on = hx->power_on;
+            s.present |= SnapFlowRate | SnapPowerOn;
+        }
+
+        const EntitySnapshot& prev = last_[i];
+        std::uint32_t mask = 0;
+        if (s.present != prev.present)     mask |= s.present;
+        if (s.level != prev.level)         mask |= SnapLevel;
+        if (s.flow != prev.flow)           mask |= SnapFlow;
+        if (s.flow_rate != prev.flow_rate) mask |= SnapFlowRate;
+        if (s.running != prev.running)     mask |= SnapRunning;
+        if (s.power_on != prev.power_on)   mask |= SnapPowerOn;
+
+        if (mask) {
+            if (!pending_[i])
+                pending_slots_.push_back(static_cast<std::uint32_t>(i));
+            pending_[i] |= mask;
+        }
+        f.state[i] = s;
+        last_[i] = s;
+    }
+
+    f.dirty.clear();
+    for (std::uint32_t slot : pending_slots_) {
+        f.changed[slot] = pending_[slot];
+        f.dirty.push_back(slot);
+    }
+
+    f.seq = ++seq_;
+    f.step = step;
+    f.sim_time = sim_time;
+    channel_.publish();
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <entt/entt.hpp>
+#include "Components.hpp"
+
+// Lock-free triple buffer: one producer (sim), one consumer (UI).
+// The producer always has a private back buffer, the consumer a private
+// front buffer, and the middle one is handed over with an atomic exchange.
+template<typename T>
+class TripleBuffer {
+public:
+  T& back() { return buffers_[back_]; }
+
+  // Returns true if the previously published frame was never consumed;
+  // back() is then that stale frame.
+  bool publish() {
+    const std::uint8_t prev = middle_.exchange(static_cast<std::uint8_t>(back_ | kFresh), std::memory_order_acq_rel);
+    back_ = prev & kIndex;
+    return (prev & kFresh) != 0;
+  }
+
+  // Swaps in the newest frame if there is one; front() is valid afterwards.
+  bool acquire() {
+    if (!(middle_.load(std::memory_order_acquire) & kFresh))
+      return false;
+    const std::uint8_t prev = middle_.exchange(front_, std::memory_order_acq_rel);
+    front_ = prev & kIndex;
+    return true;
+  }
+  const T& front() const { return buffers_[front_]; }
+
+  // Not thread-safe; for setup before the producer starts.
+  template<typename F> void forEach(F&& f) { for (auto& b : buffers_) f(b); }
+
+private:
+  static constexpr std::uint8_t kIndex = 0x3;
+  static constexpr std::uint8_t kFresh = 0x4;
+
+  std::array<T, 3> buffers_{};
+  std::uint8_t back_{0};
+  std::uint8_t front_{1};
+  std::atomic<std::uint8_t> middle_{2};
+};
+
+enum SnapshotField : std::uint32_t {
+  SnapLevel    = 1u << 0,
+  SnapFlow     = 1u << 1,
+  SnapFlowRate = 1u << 2,
+  SnapRunning  = 1u << 3,
+  SnapPowerOn  = 1u << 4,
+};
+
+// Compact, typed per-entity view state for the UI.
+struct EntitySnapshot {
+  float level{0.f};
+  float flow{0.f};
+  float flow_rate{0.f};
+  bool  running{false};
+  bool  power_on{false};
+  std::uint32_t present{0};  // SnapshotField bits this entity has at all
+};
+
+struct SnapshotFrame {
+  std::uint64_t seq{0};
+  std::uint64_t step{0};
+  double sim_time{0.0};
+  std::vector<EntitySnapshot> state;   // one per bound slot, full values
+  std::vector<std::uint32_t> changed;  // SnapshotField bits; valid for dirty slots only
+  std::vector<std::uint32_t> dirty;    // slots changed since the last frame the UI took
+};
+
+// bind() maps UI slots to entities once and caches component pointers.
+// publish() (sim thread) diffs against the last published values and
+// lists only slots that moved since the last frame the UI acquired, so
+// frames the UI skips lose nothing. acquire() runs on the UI thread.
+// No allocation or hashing after bind().
+class SnapshotPublisher {
+public:
+  void bind(entt::registry& r, const std::vector<entt::entity>& slots);
+  void publish(std::uint64_t step, double sim_time);
+
+  bool acquire();
+  const SnapshotFrame& front() const { return channel_.front(); }
+
+  std::size_t slotCount() const { return tank_.size(); }
+
+private:
+  std::vector<const Tank*> tank_;
+  std::vector<const Pump*> pump_;
+  std::vector<const HeatExchanger*> hx_;
+  std::vector<EntitySnapshot> last_;
+  std::vector<std::uint32_t> pending_;        // change bits not yet seen by the UI
+  std::vector<std::uint32_t> pending_slots_;  // slots with pending_ != 0
+
+  std::uint64_t seq_{0};                      // last published frame
+  std::atomic<std::uint64_t> consumed_seq_{0};
+
+  TripleBuffer<SnapshotFrame> channel_;
+};
@@ -0,0 +1,213 @@
+#include "SparseLDL.hpp"
+#include <algorithm>
+#include <set>
+#include <tuple>
+
+namespace {
+constexpr std::uint32_t kNone = 0xffffffffu;
+
+// Greedy minimum degree on the elimination graph: eliminating a node joins
+// its neighbours into a clique. Plant networks are close to trees and
+// ladders, so the cliques stay small and this keeps fill near zero.
+std::vector<std::uint32_t> minimumDegree(std::vector<std::vector<std::uint32_t>> adj) {
+    const std::size_t n = adj.size();
+    std::set<std::pair<std::size_t, std::uint32_t>> queue;
+    for (std::uint32_t i = 0; i < n; ++i)
+        queue.emplace(adj[i].size(), i);
+
+    std::vector<std::uint32_t> order;
+    order.reserve(n);
+    std::vector<std::uint32_t> merged;
+    while (!queue.empty()) {
+        const std::uint32_t v = queue.begin()->second;
+        queue.erase(queue.begin());
+        order.push_back(v);
+
+        const std::vector<std::uint32_t> nb = std::move(adj[v]);
+        adj[v].clear();
+        for (std::uint32_t u : nb) {
+            auto& au = adj[u];
+            queue.erase({au.size(), u});
+            au.erase(std::lower_bound(au.begin(), au.end(), v));
+            merged.clear();
+            std::set_union(au.begin(), au.end(), nb.begin(), nb.end(), std::back_inserter(merged));
+            merged.erase(std::lower_bound(merged.begin(), merged.end(), u));
+            au.swap(merged);
+            queue.emplace(au.size(), u);
+        }
+    }
+    return order;
+}
+}
+
+void SparseLDL::permute(const std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs) {
+    const std::size_t n = n_;
+    std::vector<std::uint32_t> iperm(n);
+    for (std::uint32_t k = 0; k < n; ++k)
+        iperm[perm_[k]] = k;
+
+    // Upper triangle of the permuted matrix: (column, row, source), where
+    // source is the pair index, or pairs.size() + i for diagonal i
+    std::vector<std::tuple<std::uint32_t, std::uint32_t, std::size_t>> entries;
+    entries.reserve(n + pairs.size());
+    for (std::uint32_t i = 0; i < n; ++i)
+        entries.emplace_back(iperm[i], iperm[i], pairs.size() + i);
+    for (std::size_t k = 0; k < pairs.size(); ++k) {
+        const std::uint32_t a = iperm[pairs[k].first], b = iperm[pairs[k].second];
+        entries.emplace_back(std::max(a, b), std::min(a, b), k);
+    }
+    std::sort(entries.begin(), entries.end());
+
+    Ap_.assign(n + 1, 0);
+    Ai_.clear();
+    diag_slot_.assign(n, 0);
+    pair_slot_.assign(pairs.size(), 0);
+    for (std::size_t p = 0; p < entries.size(); ++p) {
+        const auto [col, row, src] = entries[p];
+        const bool repeat = p > 0 && std::get<0>(entries[p - 1]) == col && std::get<1>(entries[p - 1]) == row;
+        if (!repeat) {
+            Ai_.push_back(row);
+            ++Ap_[col + 1];
+        }
+        const auto slot = static_cast<std::uint32_t>(Ai_.size() - 1);
+        if (src >= pairs.size()) diag_slot_[src - pairs.size()] = slot;
+        else                     pair_slot_[src] = slot;
+    }
+    for (std::size_t k = 0; k < n; ++k)
+        Ap_[k + 1] += Ap_[k];
+    Ax_.assign(Ai_.size(), 0.0);
+
+    // Elimination tree and column counts
+    parent_.assign(n, -1);
+    flag_.assign(n, -1);
+    lnz_.assign(n, 0);
+    for (std::uint32_t k = 0; k < n; ++k) {
+        flag_[k] = static_cast<std::int32_t>(k);
+        for (std::uint32_t p = Ap_[k]; p < Ap_[k + 1]; ++p) {
+            for (std::uint32_t i = Ai_[p]; i < k && flag_[i] != static_cast<std::int32_t>(k); i = static_cast<std::uint32_t>(parent_[i])) {
+                if (parent_[i] == -1)
+                    parent_[i] = static_cast<std::int32_t>(k);
+                ++lnz_[i];
+                flag_[i] = static_cast<std::int32_t>(k);
+            }
+        }
+    }
+}
+
+void SparseLDL::analyze(std::size_t n, const std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs) {
+    n_ = n;
+
+    std::vector<std::vector<std::uint32_t>> adj(n);
+    for (auto [i, j] : pairs) {
+        adj[i].push_back(j);
+        adj[j].push_back(i);
+    }
+    for (auto& a : adj) {
+        std::sort(a.begin(), a.end());
+        a.erase(std::unique(a.begin(), a.end()), a.end());
+    }
+    perm_ = minimumDegree(std::move(adj));
+    permute(pairs);
+
+    // Renumber in etree postorder: same fill, but each subtree's columns are
+    // contiguous, so factor() and solve() walk memory mostly forward
+    std::vector<std::uint32_t> head(n, kNone), next(n, kNone), post;
+    post.reserve(n);
+    for (std::uint32_t k = static_cast<std::uint32_t>(n); k-- > 0;) {
+        if (parent_[k] >= 0) {
+            next[k] = head[parent_[k]];
+            head[parent_[k]] = k;
+        }
+    }
+    std::vector<std::uint32_t> stack;
+    for (std::uint32_t root = 0; root < n; ++root) {
+        if (parent_[root] >= 0)
+            continue;
+        stack.push_back(root);
+        while (!stack.empty()) {
+            const std::uint32_t k = stack.back();
+            if (head[k] != kNone) {
+                const std::uint32_t child = head[k];
+                head[k] = next[child];
+                stack.push_back(child);
+            } else {
+                stack.pop_back();
+                post.push_back(k);
+            }
+        }
+    }
+    std::vector<std::uint32_t> order(n);
+    for (std::size_t k = 0; k < n; ++k)
+        order[k] = perm_[post[k]];
+    perm_.swap(order);
+    permute(pairs);
+
+    Lp_.assign(n + 1, 0);
+    for (std::size_t k = 0; k < n; ++k)
+        Lp_[k + 1] = Lp_[k] + lnz_[k];
+
+    Li_.assign(Lp_[n], 0);
+    Lx_.assign(Lp_[n], 0.0);
+    D_.assign(n, 0.0);
+    y_.assign(n, 0.0);
+    x_.assign(n, 0.0);
+    pattern_.assign(n, 0);
+}
+
+bool SparseLDL::factor() {
+    const std::uint32_t n = static_cast<std::uint32_t>(n_);
+    for (std::uint32_t k = 0; k < n; ++k) {
+        // Row k of L: the nonzero pattern is the union of the etree paths
+        // from each entry of column k of the upper triangle
+        y_[k] = 0.0;
+        std::uint32_t top = n;
+        flag_[k] = static_cast<std::int32_t>(k);
+        lnz_[k] = 0;
+        for (std::uint32_t p = Ap_[k]; p < Ap_[k + 1]; ++p) {
+            std::uint32_t i = Ai_[p];
+            y_[i] += Ax_[p];
+            std::uint32_t len = 0;
+            for (; flag_[i] != static_cast<std::int32_t>(k); i = static_cast<std::uint32_t>(parent_[i])) {
+                pattern_[len++] = i;
+                flag_[i] = static_cast<std::int32_t>(k);
+            }
+            while (len > 0)
+                pattern_[--top] = pattern_[--len];
+        }
+
+        D_[k] = y_[k];
+        y_[k] = 0.0;
+        for (; top < n; ++top) {
+            const std::uint32_t i = pattern_[top];
+            const double yi = y_[i];
+            y_[i] = 0.0;
+            const std::uint32_t end = Lp_[i] + lnz_[i];
+            for (std::uint32_t p = Lp_[i]; p < end; ++p)
+                y_[Li_[p]] -= Lx_[p] * yi;
+            const double l_ki = yi / D_[i];
+            D_[k] -= l_ki * yi;
+            Li_[end] = k;
+            Lx_[end] = l_ki;
+            ++lnz_[i];
+        }
+        if (D_[k] == 0.0)
+            return false;
+    }
+    return true;
+}
+
+void SparseLDL::solve(double* b) const {
+    const std::size_t n = n_;
+    for (std::size_t k = 0; k < n; ++k)
+        x_[k] = b[perm_[k]];
+    for (std::size_t j = 0; j < n; ++j)
+        for (std::uint32_t p = Lp_[j]; p < Lp_[j + 1]; ++p)
+            x_[Li_[p]] -= Lx_[p] * x_[j];
+    for (std::size_t j = 0; j < n; ++j)
+        x_[j] /= D_[j];
+    for (std::size_t j = n; j-- > 0;)
+        for (std::uint32_t p = Lp_[j]; p < Lp_[j + 1]; ++p)
+            x_[j] -= Lx_[p] * x_[Li_[p]];
+    for (std::size_t k = 0; k < n; ++k)
+        b[perm_[k]] = x_[k];
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Sparse LDLᵀ for symmetric positive definite systems, split the way a
+// network solver uses it: analyze() runs once per structure (minimum-degree
+// ordering, elimination tree, column counts of L), factor() runs whenever the
+// values change and only does arithmetic, solve() reuses the last factor.
+//
+// Values live in one array addressed by slots handed out by analyze(): one
+// per diagonal entry and one per distinct off-diagonal pair, so the caller
+// can assemble straight into place. Up-looking numeric factorization after
+// Davis' LDL package.
+class SparseLDL {
+public:
+  // n unknowns; pairs (i, j), i != j, that may be nonzero. Duplicate pairs
+  // share a slot.
+  void analyze(std::size_t n, const std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs);
+
+  std::size_t size() const { return n_; }
+  std::size_t factorNonzeros() const { return Lp_.empty() ? 0 : Lp_[n_]; }
+
+  std::uint32_t diagSlot(std::uint32_t i) const { return diag_slot_[i]; }
+  std::uint32_t pairSlot(std::size_t k) const { return pair_slot_[k]; }
+  std::vector<double>& values() { return Ax_; }
+
+  // Numeric factorization of values(); false on a zero pivot.
+  bool factor();
+  // Solves A x = b in place, b and x in the caller's ordering.
+  void solve(double* b) const;
+
+private:
+  void permute(const std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs);  // pattern + etree for perm_
+
+  std::size_t n_{0};
+  std::vector<std::uint32_t> perm_;     // new → old
+  std::vector<std::uint32_t> diag_slot_, pair_slot_;
+
+  // Upper triangle of P A Pᵀ by column (diagonal included)
+  std::vector<std::uint32_t> Ap_, Ai_;
+  std::vector<double> Ax_;
+
+  // Symbolic: elimination tree and column pointers of L
+  std::vector<std::int32_t> parent_;
+  std::vector<std::uint32_t> Lp_;
+
+  // Numeric
+  std::vector<std::uint32_t> Li_;
+  std::vector<double> Lx_, D_;
+
+  // Scratch, sized by analyze() so factor() and solve() don't allocate
+  std::vector<std::uint32_t> lnz_, pattern_;
+  std::vector<std::int32_t> flag_;
+  std::vector<double> y_;
+  mutable std::vector<double> x_;
+};
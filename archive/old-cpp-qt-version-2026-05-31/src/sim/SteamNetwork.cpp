@@ -0,0 +1,230 @@
+#include "SteamNetwork.hpp"
+#include "BatchKernels.hpp"
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+constexpr float kSteamEnthalpy  = 2780.f;  // kJ/kg, saturated steam near 10 bar
+constexpr float kWaterCp        = 4.19f;   // kJ/kg/K
+constexpr float kRatedFeedwater = 120.f;   // °C that Boiler::capacity is quoted at
+}
+
+SteamNetwork SteamNetwork::compile(entt::registry& r) {
+    SteamNetwork net;
+
+    std::vector<SteamHeader*> headers;
+    std::unordered_map<int, std::uint32_t> by_bus;
+    auto hv = r.view<SteamHeader>();
+    for (auto e : hv) {
+        auto& h = hv.get<SteamHeader>(e);
+        if (!by_bus.emplace(h.bus, static_cast<std::uint32_t>(headers.size())).second) {
+            std::cerr << "Two steam headers on bus " << h.bus << "; the second is ignored\n";
+            continue;
+        }
+        headers.push_back(&h);
+    }
+    if (headers.empty())
+        return net;
+    const std::size_t n = headers.size();
+
+    // PRVs between known headers
+    std::vector<PressureReducingValve*> prvs;
+    std::vector<std::uint32_t> prv_from, prv_to;
+    auto pv = r.view<PressureReducingValve>();
+    for (auto e : pv) {
+        auto& v = pv.get<PressureReducingValve>(e);
+        auto a = by_bus.find(v.from_bus), b = by_bus.find(v.to_bus);
+        if (a == by_bus.end() || b == by_bus.end() || a->second == b->second) {
+            std::cerr << "PRV from bus " << v.from_bus << " to bus " << v.to_bus
+                      << " does not join two steam headers; ignored\n";
+            continue;
+        }
+        prvs.push_back(&v);
+        prv_from.push_back(a->second);
+        prv_to.push_back(b->second);
+    }
+
+    // Upstream first (Kahn); headers on a PRV loop keep their view order
+    std::vector<std::uint32_t> indeg(n, 0), order, rank(n, 0);
+    for (auto b : prv_to)
+        ++indeg[b];
+    std::vector<std::uint8_t> placed(n, 0);
+    for (std::size_t i = 0; i < n; ++i)
+        if (indeg[i] == 0)
+            order.push_back(static_cast<std::uint32_t>(i));
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        placed[order[k]] = 1;
+        for (std::size_t p = 0; p < prvs.size(); ++p)
+            if (prv_from[p] == order[k] && --indeg[prv_to[p]] == 0)
+                order.push_back(prv_to[p]);
+    }
+    for (std::size_t i = 0; i < n; ++i)
+        if (!placed[i])
+            order.push_back(static_cast<std::uint32_t>(i));
+    for (std::size_t k = 0; k < n; ++k)
+        rank[order[k]] = static_cast<std::uint32_t>(k);
+
+    net.header.resize(n);
+    for (std::size_t i = 0; i < n; ++i)
+        net.header[rank[i]] = headers[i];
+
+    // A PRV feeding a header that is stepped before it would close a loop
+    std::vector<std::uint32_t> keep;
+    for (std::size_t p = 0; p < prvs.size(); ++p)
+        if (rank[prv_from[p]] < rank[prv_to[p]])
+            keep.push_back(static_cast<std::uint32_t>(p));
+    if (keep.size() != prvs.size())
+        std::cerr << prvs.size() - keep.size() << " PRV(s) close a loop between steam headers; ignored\n";
+    std::stable_sort(keep.begin(), keep.end(),
+                     [&](std::uint32_t a, std::uint32_t b) { return rank[prv_from[a]] < rank[prv_from[b]]; });
+    std::vector<std::uint32_t> from;
+    for (auto p : keep) {
+        net.prv.push_back(prvs[p]);
+        net.prv_to.push_back(rank[prv_to[p]]);
+        from.push_back(rank[prv_from[p]]);
+    }
+    net.prv_ptr = BatchKernels::csrOffsets(from, n);
+
+    auto bv = r.view<Boiler>();
+    for (auto e : bv) {
+        auto& b = bv.get<Boiler>(e);
+        auto it = by_bus.find(b.bus);
+        if (it == by_bus.end()) {
+            std::cerr << "Boiler on bus " << b.bus << " has no steam header; ignored\n";
+            continue;
+        }
+        net.boiler.push_back(&b);
+        net.boiler_header.push_back(rank[it->second]);
+    }
+
+    std::vector<std::pair<std::uint32_t, SteamLoad*>> loads;
+    std::size_t orphans = 0;
+    auto lv = r.view<SteamLoad>();
+    for (auto e : lv) {
+        auto& l = lv.get<SteamLoad>(e);
+        auto it = by_bus.find(l.bus);
+        if (it == by_bus.end()) {
+            ++orphans;
+            continue;
+        }
+        loads.emplace_back(rank[it->second], &l);
+    }
+    if (orphans)
+        std::cerr << orphans << " steam load(s) on a bus with no steam header get no steam\n";
+    std::stable_sort(loads.begin(), loads.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    std::vector<std::uint32_t> load_header;
+    for (auto [h, l] : loads) {
+        net.load.push_back(l);
+        load_header.push_back(h);
+    }
+    net.load_ptr = BatchKernels::csrOffsets(load_header, n);
+
+    net.expected.assign(n, 0.f);
+    net.supply.assign(n, 0.f);
+    net.capacity.assign(n, 0.f);
+    net.prv_ask.assign(net.prv.size(), 0.f);
+    net.demand.assign(net.load.size(), 0.f);
+    net.granted.assign(net.load.size(), 0.f);
+    return net;
+}
+
+namespace {
+// Steam per unit of firing: colder feedwater takes more heat per kg
+float steamPerFiring(const Boiler& bo) {
+    const float h_fw  = std::max(1.f, kSteamEnthalpy - kWaterCp * bo.feedwater_temp);
+    const float rated = kSteamEnthalpy - kWaterCp * kRatedFeedwater;
+    return bo.capacity * rated / h_fw;
+}
+}
+
+void SteamNetwork::boilers(float dt, Integrator method) {
+    // Boilers sharing a header split its demand in proportion to their capacity
+    std::fill(capacity.begin(), capacity.end(), 0.f);
+    for (std::size_t b = 0; b < boiler.size(); ++b)
+        capacity[boiler_header[b]] += std::max(0.f, steamPerFiring(*boiler[b]));
+
+    for (std::size_t b = 0; b < boiler.size(); ++b) {
+        Boiler& bo = *boiler[b];
+        const SteamHeader& hd = *header[boiler_header[b]];
+
+        // Firing demand: last tick's header demand fed forward, pressure error
+        // trimmed by PI; actual firing slews toward it
+        const float cap = capacity[boiler_header[b]];
+        const float ff  = cap > 0.f ? hd.steam_demand_flow / cap : 0.f;
+        const float err = bo.pressure_sp - hd.pressure;
+        bo.integ = std::clamp(bo.integ + bo.ki * err * dt, -1.f, 1.f);
+        const float cmd = std::clamp(ff + bo.kp * err + bo.integ, 0.f, 1.f);
+        bo.firing += std::clamp(cmd - bo.firing, -bo.firing_rate * dt, bo.firing_rate * dt);
+
+        const float target = bo.firing * steamPerFiring(bo);
+        const float alpha  = lagAlpha(method, dt / std::max(0.1f, bo.tau_s));
+        bo.steam_flow += alpha * (target - bo.steam_flow);
+
+        const float h_fw = std::max(1.f, kSteamEnthalpy - kWaterCp * bo.feedwater_temp);
+        bo.fuel_kw  = bo.steam_flow * h_fw / std::max(0.05f, bo.efficiency);
+        bo.pressure = hd.pressure;
+    }
+}
+
+void SteamNetwork::step(float dt) {
+    const std::size_t n = header.size();
+    if (n == 0)
+        return;
+
+    std::fill(supply.begin(), supply.end(), 0.f);
+    for (std::size_t b = 0; b < boiler.size(); ++b)
+        supply[boiler_header[b]] += boiler[b]->steam_flow;
+    for (std::size_t i = 0; i < load.size(); ++i)
+        demand[i] = load[i]->demand_flow;
+
+    for (std::size_t h = 0; h < n; ++h) {
+        SteamHeader& hd = *header[h];
+
+        // Downstream PRVs open on their header's pressure from last tick
+        float prv_demand = 0.f;
+        for (std::uint32_t k = prv_ptr[h]; k < prv_ptr[h + 1]; ++k) {
+            const PressureReducingValve& v = *prv[k];
+            const float below = v.setpoint - header[prv_to[k]]->pressure;
+            prv_ask[k] = std::clamp(v.kp * below, 0.f, std::max(0.f, v.capacity));
+            prv_demand += prv_ask[k];
+        }
+
+        // What this tick can hand out: supply plus steam stored above pressure_min
+        const float cap   = std::max(1e-3f, hd.capacitance);
+        const float avail = supply[h] + std::max(0.f, hd.pressure - hd.pressure_min) * cap / dt;
+        auto fraction = [avail](float want) { return want > avail ? avail / want : 1.f; };
+
+        const std::uint32_t b = load_ptr[h];
+        const std::size_t count = load_ptr[h + 1] - b;
+        const float guess = fraction(expected[h] + prv_demand);
+        const float loads = BatchKernels::prorata(count, demand.data() + b, granted.data() + b, guess);
+        const float total = loads + prv_demand;
+        const float frac  = fraction(total);
+        if (frac != guess)
+            BatchKernels::prorata(count, demand.data() + b, granted.data() + b, frac);
+        expected[h] = loads;
+
+        for (std::uint32_t k = prv_ptr[h]; k < prv_ptr[h + 1]; ++k) {
+            prv[k]->flow = prv_ask[k] * frac;
+            supply[prv_to[k]] += prv[k]->flow;
+        }
+
+        const float out = total * frac;
+        hd.steam_supply_flow = supply[h];
+        hd.steam_demand_flow = total;
+        hd.unmet_demand_flow = total - out;
+
+        float p = hd.pressure + (supply[h] - out) * dt / cap;
+        hd.vented_flow = 0.f;
+        if (p > hd.pressure_relief) {
+            hd.vented_flow = (p - hd.pressure_relief) * cap / dt;
+            p = hd.pressure_relief;
+        }
+        hd.pressure = std::max(0.f, p);
+    }
+
+    for (std::size_t i = 0; i < load.size(); ++i)
+        load[i]->granted_flow = granted[i];
+}
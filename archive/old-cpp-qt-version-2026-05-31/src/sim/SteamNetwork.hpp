@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <entt/entt.hpp>
+#include "Components.hpp"
+#include "Integrator.hpp"
+
+// Steam utility compiled from the bus numbers on SteamHeader, Boiler,
+// SteamLoad and PressureReducingValve (not PlantTopology: those edges are
+// hydraulic). Every header is a lumped volume: boilers and upstream PRVs
+// feed it, loads and downstream PRVs draw on it, and the balance moves its
+// pressure through SteamHeader::capacitance.
+//
+// When supply plus the steam stored above pressure_min can't cover demand,
+// every consumer on that header (loads and PRVs alike) gets the same
+// fraction of what it asked for. Loads are grouped by header into SoA lanes
+// and one BatchKernels::prorata pass both sums and grants them, using the
+// fraction implied by last tick's demand; only a header whose fraction then
+// turns out different is granted again, so the result is always exact.
+//
+// Headers are stepped upstream first so PRV flow reaches lower-pressure
+// headers in the same tick. Pointers are cached like FlowNetwork's; re-run
+// compile() after adding or removing steam components or changing a bus.
+struct SteamNetwork {
+  // Per header, upstream first
+  std::vector<SteamHeader*> header;
+  std::vector<std::uint32_t> load_ptr;  // loads of header h: [load_ptr[h], load_ptr[h + 1])
+  std::vector<std::uint32_t> prv_ptr;   // PRVs leaving header h, likewise
+  std::vector<float> expected;          // last tick's load demand
+  std::vector<float> supply, capacity;  // scratch
+
+  // Per boiler
+  std::vector<Boiler*> boiler;
+  std::vector<std::uint32_t> boiler_header;
+
+  // Per PRV, grouped by upstream header
+  std::vector<PressureReducingValve*> prv;
+  std::vector<std::uint32_t> prv_to;
+  std::vector<float> prv_ask;           // scratch
+
+  // Per load, grouped by header
+  std::vector<SteamLoad*> load;
+  std::vector<float> demand, granted;
+
+  std::size_t headerCount() const { return header.size(); }
+  std::size_t loadCount() const { return load.size(); }
+
+  static SteamNetwork compile(entt::registry& r);
+  void boilers(float dt, Integrator method = Integrator::Euler);  // BoilerSystem: firing-rate dynamics
+  void step(float dt);  // Steam: header balance and load allocation
+};
@@ -1,8 +1,32 @@
 #include "Systems.hpp"
 #include "Components.hpp"
+#include "AlarmEngine.hpp"
+#include "AlarmMetrics.hpp"
+#include "CoolingNetwork.hpp"
+#include "FlowNetwork.hpp"
+#include "Integrator.hpp"
+#include "KpiEngine.hpp"
+#include "SiteContext.hpp"
+#include "SteamNetwork.hpp"
 #include <algorithm>
 #include <cmath>
 
+namespace {
+// Absent config: Euler everywhere, as before integrators were selectable
+IntegrationConfig integration(entt::registry& r) {
+    const auto* cfg = r.ctx().find<IntegrationConfig>();
+    return cfg ? *cfg : IntegrationConfig{};
+}
+
+// Compiled site context, else one bound afresh into `fresh`
+SiteContext& sites(entt::registry& r, SiteContext& fresh) {
+    if (auto* ctx = r.ctx().find<SiteContext>())
+        return *ctx;
+    fresh = SiteContext::compile(r);
+    return fresh;
+}
+}
+
 void ControlSystem(entt::registry& r, float dt) {
     auto view = r.view<PID>();
     for(auto e : view) {
@@ -25,6 +49,13 @@ void ActuatorSystem(entt::registry& r, float dt) {
 }
 
 void HydraulicsSystem(entt::registry& r, float dt) {
+    // Compiled plants solve the whole graph without per-pump lookups
+    if (auto* net = r.ctx().find<FlowNetwork>()) {
+        net->step(dt, integration(r).hydraulics);
+        return;
+    }
+
+    // Fallback: pump, valve, pipe and tank on one entity
     auto pumps = r.view<Pump>();
     for(auto e : pumps) {
         auto& p = pumps.get<Pump>(e);
@@ -46,7 +77,18 @@ void HydraulicsSystem(entt::registry& r, float dt) {
 }
 
 void AlarmSystem(entt::registry& r) {
-    // View of all entities that have BOTH Tanks and Alarmable
+    // Compiled points: compare each bound value, emit events on crossings only
+    if (auto* alarms = r.ctx().find<AlarmEngine>()) {
+        alarms->events.clear();
+        for (std::uint32_t p = 0; p < alarms->size(); ++p) {
+            const float v = *alarms->source[p];
+            const Alarmable& a = *alarms->alarm[p];
+            alarms->update(p, v, v > AlarmEngine::hiLimit(a), v < AlarmEngine::loLimit(a));
+        }
+        return;
+    }
+
+    // Fallback: poll every Tank + Alarmable
     auto v = r.view<Tank, Alarmable>();
 
     // Iterate entities
@@ -57,12 +99,12 @@ void AlarmSystem(entt::registry& r) {
         auto& alarm = v.get<Alarmable>(e);
 
         // Compute instantaneous alarm states from current level vs setpoints
-        const bool hi_now = (tank.level > alarm.hiSP);
-        const bool lo_now = (tank.level < alarm.loSP);
+        const bool hi_now = tank.level > AlarmEngine::hiLimit(alarm);
+        const bool lo_now = tank.level < AlarmEngine::loLimit(alarm);
 
         // Update non-latched "present" alarms
-        alarm.hi = tank.level > alarm.hiSP;
-        alarm.lo = tank.level < alarm.loSP;
+        alarm.hi = hi_now;
+        alarm.lo = lo_now;
 
         // Latch: once true, stays true until someone clears alm.latched elsewhere
         alarm.latched = alarm.latched || alarm.hi || alarm.lo;
@@ -84,20 +126,122 @@ void HumanFactorsSystem(entt::registry& r, float /*dt*/) {
     }
 }
 
-// Drive acknowlege + repair timers for each alarmable thing, scaled by human factors.
+namespace {
+
+// Event-driven response: new responses come from this tick's crossings, ack
+// and repair deadlines from the timer heap. Nothing here visits idle points.
+void respondToEvents(entt::registry& r, AlarmEngine& alarms, SiteContext& sites, float dt) {
+    const double t0 = alarms.now;
+    const double t1 = t0 + dt;
+
+    auto kpiOf = [&](std::uint32_t p) { return sites.site(alarms.site[p]).kpi; };
+
+    auto raise = [&](std::uint32_t p) {
+        auto* ar = r.try_get<AlarmResponse>(alarms.entity[p]);
+        if (!ar || ar->active) return;
+        SiteContext::Site& site = sites.site(alarms.site[p]);
+        const float rt_mult = site.reactionMult();
+        ar->active        = true;
+        ar->acknowledged  = false;
+        ar->ack_timer_s   = std::max(0.0f, ar->ack_delay_target_s   * rt_mult);
+        ar->repair_time_s = std::max(0.0f, ar->repair_time_target_s * rt_mult);
+        ar->elapsed_s     = 0.0f;
+        alarms.activate(p, t0, t0 + ar->ack_timer_s);
+        alarms.emit(p, t0, AlarmEventKind::Raised, 0.0f);
+        if (site.kpi) { site.kpi->alarms_raised++; site.kpi->alarms_active++; }
+    };
+
+    // Repaired last tick but still out of limits → straight back in
+    for (auto p : alarms.retrigger)
+        if (alarms.alarm[p]->hi || alarms.alarm[p]->lo)
+            raise(p);
+    alarms.retrigger.clear();
+
+    const std::size_t crossings = alarms.events.size();
+    for (std::size_t i = 0; i < crossings; ++i)
+        if (alarms.events[i].kind == AlarmEventKind::Activated)
+            raise(alarms.events[i].point);
+
+    // Every response in progress is downtime for its site
+    if (sites.size() == 1) {
+        if (auto* kpi = sites.primary().kpi)
+            kpi->downtime_s += dt * static_cast<float>(alarms.active.size());
+    } else {
+        for (auto& s : sites.sites)
+            s.active = 0;
+        for (const auto& a : alarms.active)
+            ++sites.site(alarms.site[a.point]).active;
+        for (auto& s : sites.sites)
+            if (s.kpi) s.kpi->downtime_s += dt * static_cast<float>(s.active);
+    }
+
+    // Deadlines within this tick; the slack absorbs rounding in t0 + n*dt
+    AlarmEngine::Timer due;
+    while (alarms.popDue(t1 + 1e-9, due)) {
+        const std::uint32_t p = due.point;
+        auto* ar = r.try_get<AlarmResponse>(alarms.entity[p]);
+        if (!ar) { alarms.deactivate(p); continue; }
+
+        const double raised_at = alarms.active[alarms.slot[p]].raised_at;
+        ar->elapsed_s = static_cast<float>(t1 - raised_at);
+        if (!ar->acknowledged) {
+            ar->acknowledged = true;           // now begin repair phase
+            alarms.reschedule(p, t1 + ar->repair_time_s);
+            alarms.emit(p, t0, AlarmEventKind::Acknowledged, ar->elapsed_s);
+        } else {
+            // repair done → clear
+            Alarmable& a = *alarms.alarm[p];
+            a.latched = false;
+            ar->active = false;
+            ar->acknowledged = false;
+            alarms.deactivate(p);
+            alarms.emit(p, t0, AlarmEventKind::Repaired, ar->elapsed_s);
+            if (auto* kpi = kpiOf(p); kpi && kpi->alarms_active > 0) kpi->alarms_active--;
+            if (a.hi || a.lo)
+                alarms.retrigger.push_back(p);
+        }
+    }
+
+    // Transient clear before ack → allow auto-cancel
+    for (std::size_t i = 0; i < crossings; ++i) {
+        if (alarms.events[i].kind != AlarmEventKind::Returned) continue;
+        const std::uint32_t p = alarms.events[i].point;
+        auto* ar = r.try_get<AlarmResponse>(alarms.entity[p]);
+        if (ar && ar->active && !ar->acknowledged && !alarms.alarm[p]->latched) {
+            ar->active = false;
+            alarms.deactivate(p);
+            alarms.emit(p, t0, AlarmEventKind::Cancelled, 0.0f);
+            if (auto* kpi = kpiOf(p); kpi && kpi->alarms_active > 0) kpi->alarms_active--;
+        }
+    }
+
+    alarms.now = t1;
+}
+
+} // namespace
+
+// Drive acknowlege + repair timers for each alarmable thing, scaled by the
+// human factors of its site.
 void ResponseSystem(entt::registry& r, float dt) {
-    float rt_mult = 1.0f;
-    if (auto site = r.view<HumanFactors>(); !site.empty())
-        rt_mult = site.get<HumanFactors>(*site.begin()).reaction_time_mult;
+    SiteContext fresh;
+    SiteContext& sc = sites(r, fresh);
 
-    SiteKPI* kpi_ptr = nullptr;
-    if (auto vk = r.view<SiteKPI>(); !vk.empty())
-        kpi_ptr = &vk.get<SiteKPI>(*vk.begin());
+    if (auto* alarms = r.ctx().find<AlarmEngine>()) {
+        respondToEvents(r, *alarms, sc, dt);
+        return;
+    }
 
+    // Fallback: count every response down each tick
+    auto* engine = r.ctx().find<KpiEngine>();
     auto v = r.view<Alarmable, AlarmResponse>();
     for (auto e : v) {
         auto& a  = v.get<Alarmable>(e);
         auto& ar = v.get<AlarmResponse>(e);
+        SiteContext::Site& site = sc.site(SiteContext::siteOf(r, e));
+        SiteKPI* kpi_ptr = site.kpi;
+        const float rt_mult = site.reactionMult();
+        // Rolling ack/repair times: the ctx engine serves the primary site
+        KpiEngine* kpis = &site == &sc.primary() ? engine : &site.kpis;
 
         const bool alarm_now = (a.hi || a.lo);
 
@@ -107,16 +251,19 @@ void ResponseSystem(entt::registry& r, float dt) {
             ar.acknowledged  = false;
             ar.ack_timer_s   = std::max(0.0f, ar.ack_delay_target_s   * rt_mult);
             ar.repair_time_s = std::max(0.0f, ar.repair_time_target_s * rt_mult);
+            ar.elapsed_s     = 0.0f;
             if (kpi_ptr) { kpi_ptr->alarms_raised++; kpi_ptr->alarms_active++; }
         }
 
         if (ar.active) {
             if (kpi_ptr) kpi_ptr->downtime_s += dt;
+            ar.elapsed_s += dt;
 
             if (!ar.acknowledged) {
                 ar.ack_timer_s = std::max(0.0f, ar.ack_timer_s - dt);
                 if (ar.ack_timer_s <= 0.0f) {
                     ar.acknowledged = true;           // now begin repair phase
+                    if (kpis) kpis->acknowledged(ar.elapsed_s);
                 }
             } else {
                 ar.repair_time_s = std::max(0.0f, ar.repair_time_s - dt);
@@ -125,6 +272,7 @@ void ResponseSystem(entt::registry& r, float dt) {
                     a.latched = false;
                     ar.active = false;
                     ar.acknowledged = false;
+                    if (kpis) kpis->repaired(ar.elapsed_s);
                     if (kpi_ptr && kpi_ptr->alarms_active > 0) kpi_ptr->alarms_active--;
                 }
             }
@@ -138,12 +286,48 @@ void ResponseSystem(entt::registry& r, float dt) {
     }
 }
 
-// (Optional) place for rolling aggregates: MVP just exists for future use.
-void AnalyticsSystem(entt::registry& /*r*/, float /*dt*/) {
-    // Intentionally minimal for now.
+// Rolling KPIs: feed this tick's counters and throughput into the streaming
+// estimators and publish the current values back into each site's SiteKPI.
+// The ctx KpiEngine and AlarmMetrics serve the primary site; the others keep
+// their estimators in SiteContext.
+void AnalyticsSystem(entt::registry& r, float dt) {
+    auto* engine = r.ctx().find<KpiEngine>();
+    SiteContext fresh;
+    SiteContext& sc = sites(r, fresh);
+    SiteKPI* primary = sc.primary().kpi;
+    if (!engine || !primary) return;
+
+    // Ack/repair durations and alarm-management metrics come from the
+    // event stream when alarms are compiled
+    if (auto* alarms = r.ctx().find<AlarmEngine>()) {
+        auto* metrics = r.ctx().find<AlarmMetrics>();
+        for (const auto& ev : alarms->events) {
+            if (ev.kind == AlarmEventKind::Acknowledged || ev.kind == AlarmEventKind::Repaired) {
+                const std::uint32_t i = sc.indexOf(alarms->site[ev.point]);
+                KpiEngine& kpis = i == 0 ? *engine : sc.sites[i].kpis;
+                if (ev.kind == AlarmEventKind::Acknowledged) kpis.acknowledged(ev.value);
+                else kpis.repaired(ev.value);
+            }
+            if (metrics) metrics->onEvent(ev);
+        }
+        if (metrics) {
+            metrics->advance(alarms->now);
+            metrics->publish(*primary);
+        }
+    }
+
+    for (std::size_t i = 0; i < sc.size(); ++i) {
+        auto& s = sc.sites[i];
+        if (!s.kpi) continue;
+        float throughput = 0.0f;
+        for (const Pump* p : s.pumps)
+            throughput += p->flow;
+        (i == 0 ? *engine : s.kpis).update(*s.kpi, throughput, dt);
+    }
 }
 
 void HeatExchangerSystem(entt::registry& r, float dt) {
+    const Integrator method = integration(r).thermal;
     auto v = r.view<HeatExchanger, ValveActuator>();
     for (auto e : v) {
         auto& hx = v.get<HeatExchanger>(e);
@@ -154,9 +338,9 @@ void HeatExchangerSystem(entt::registry& r, float dt) {
         // Target = inlet modulated by valve opening (0..1)
         const float target = hx.comp_inlet_stream * std::clamp(va.pos, 0.0f, 1.0f);
 
-        // First-order approach: dY = (dt / tau_eff) * (target - current)
+        // First-order approach: dY = alpha(dt / tau_eff) * (target - current)
         const float tau_eff = std::max(0.1f, hx.tau_s / std::max(0.1f, hx.flow_rate));
-        const float alpha   = std::clamp(dt / tau_eff, 0.0f, 1.0f);
+        const float alpha   = lagAlpha(method, dt / tau_eff);
 
         hx.comp_outlet_stream += alpha * (target - hx.comp_outlet_stream);
     }
@@ -182,76 +366,63 @@ void HeatExchangerSystem(entt::registry& r, float dt) {
 //     }
 // }
 
-void Steam(entt::registry& r, float /*dt*/) {
-    // Get the site bus; if missing, nothing to do.
-    auto v = r.view<SteamHeader>();
-    if (v.empty()) return;
-    auto e_site = *v.begin();
-    auto &bus = v.get<SteamHeader>(e_site);
-
-    // 1) Collect demand
-    float total_demand = 0.0f;
-    auto vload = r.view<SteamLoad>();
-    for (auto e : vload) {
-        const auto &ld = vload.get<SteamLoad>(e);
-        total_demand += std::max(0.0f, ld.demand_flow);
-    }
-    bus.steam_demand_flow = total_demand;
-
-    // 2) For now: supply meets demand (no curtailment yet)
-    bus.steam_supply_flow = total_demand;
-    bus.unmet_demand_flow = std::max(0.0f, bus.steam_demand_flow - bus.steam_supply_flow);
-
-    // Crude pressure surrogate: base + small gain*(supply - demand)
-    bus.pressure = std::max(0.0f, 10.0f + 0.1f * (bus.steam_supply_flow - bus.steam_demand_flow));
-
-    // 3) Allocate back to loads (fully met for MVP)
-    for (auto e : vload) {
-        auto &ld = vload.get<SteamLoad>(e);
-        ld.granted_flow = std::min(ld.demand_flow, bus.steam_supply_flow); // MVP: no pro-rata yet
+void Steam(entt::registry& r, float dt) {
+    // Compiled plants keep the header order and load lanes between ticks
+    if (auto* net = r.ctx().find<SteamNetwork>()) {
+        net->step(dt);
+        return;
     }
+    // Fallback: same model, bound afresh each tick
+    SteamNetwork::compile(r).step(dt);
 }
 
-void Cooling(entt::registry& r, float /*dt*/) {
-    auto v = r.view<ChilledWaterLoop>();
-    if (v.empty()) return;
-    auto e_site = *v.begin();
-    auto &loop = v.get<ChilledWaterLoop>(e_site);
-
-    // 1) Collect demand
-    float total_demand = 0.0f;
-    auto vload = r.view<CoolingLoad>();
-    for (auto e : vload) {
-        const auto &ld = vload.get<CoolingLoad>(e);
-        total_demand += std::max(0.0f, ld.demand_kw);
-    }
-    loop.cooling_demand_kw = total_demand;
-
-    // 2) For now: supply meets demand (later tie to CoolingTower/ambient)
-    loop.cooling_supply_kw = total_demand;
-    loop.unmet_cooling_kw  = std::max(0.0f, loop.cooling_demand_kw - loop.cooling_supply_kw);
-
-    // Crude temps: with supply == demand, hold nominal supply/return
-    loop.supply_temp = 7.0f;   // °C
-    loop.return_temp = 12.0f;  // °C
-
-    // 3) Allocate
-    for (auto e : vload) {
-        auto &ld = vload.get<CoolingLoad>(e);
-        ld.granted_kw = std::min(ld.demand_kw, loop.cooling_supply_kw);
+void Cooling(entt::registry& r, float dt) {
+    const Integrator method = integration(r).thermal;
+    if (auto* net = r.ctx().find<CoolingNetwork>()) {
+        net->step(dt, method);
+        return;
     }
+    CoolingNetwork::compile(r).step(dt, method);
 }
 
-
 void UtilitySystem(entt::registry& r, float dt) {
-    // update process balance (e.g., cooling vs. demand, steam vs. pressure).
-
+    // Site roll-up: what the utilities failed to deliver and what they cost to run
+    SiteContext fresh;
+    for (auto& s : sites(r, fresh).sites) {
+        if (!s.kpi)
+            continue;
+        float steam = 0.f, cooling = 0.f, power = 0.f;
+        for (const SteamHeader* h : s.steam)
+            steam += h->unmet_demand_flow;
+        for (const ChilledWaterLoop* l : s.chilled)
+            cooling += l->unmet_cooling_kw;
+        for (const Boiler* b : s.boilers)
+            power += b->fuel_kw;
+        for (const RefrigerationCompressor* c : s.compressors)
+            power += c->motor_kW;
+
+        SiteKPI& kpi = *s.kpi;
+        kpi.unmet_steam = steam;
+        kpi.unmet_cooling_kw = cooling;
+        kpi.unmet_cooling_kwh += cooling * dt / 3600.f;
+        kpi.utility_kw = power;
+    }
 }
 
 void BoilerSystem(entt::registry& r, float dt) {
-    // added later for detail.
+    const Integrator method = integration(r).thermal;
+    if (auto* net = r.ctx().find<SteamNetwork>()) {
+        net->boilers(dt, method);
+        return;
+    }
+    SteamNetwork::compile(r).boilers(dt, method);
 }
 
 void RefrigSystem(entt::registry& r, float dt) {
-    // added later for detail.
+    const Integrator method = integration(r).thermal;
+    if (auto* net = r.ctx().find<CoolingNetwork>()) {
+        net->refrigerate(dt, method);
+        return;
+    }
+    CoolingNetwork::compile(r).refrigerate(dt, method);
 }
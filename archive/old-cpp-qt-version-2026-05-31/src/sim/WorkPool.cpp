@@ -0,0 +1,223 @@
+#include "WorkPool.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+thread_local const WorkPool* tl_pool = nullptr;
+thread_local unsigned tl_index = 0;
+thread_local const WorkPool* tl_task_pool = nullptr;  // pool of the task running on this thread
+}
+
+WorkPool::WorkPool(unsigned threads) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned i = 0; i <= threads; ++i)
+        queues_.push_back(std::make_unique<Queue>());
+
+    for (unsigned i = 0; i < threads; ++i)
+        threads_.emplace_back([this, i] { workerLoop(i); });
+}
+
+WorkPool::~WorkPool() {
+    {
+        std::lock_guard<std::mutex> lk(sleep_m_);
+        stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto& t : threads_)
+        t.join();
+}
+
+void WorkPool::TaskRing::reserve(std::size_t n) {
+    if (n <= slots_.size())
+        return;
+    std::vector<Task> grown(std::max(n, 2 * slots_.size()));
+    for (std::size_t k = 0; k < size_; ++k)
+        grown[k] = std::move(slots_[(head_ + k) % slots_.size()]);
+    slots_.swap(grown);
+    head_ = 0;
+}
+
+void WorkPool::TaskRing::push_back(Task task) {
+    if (size_ == slots_.size())
+        reserve(std::max<std::size_t>(16, 2 * size_));
+    slots_[(head_ + size_) % slots_.size()] = std::move(task);
+    ++size_;
+}
+
+WorkPool::Task WorkPool::TaskRing::pop_back() {
+    --size_;
+    Task& slot = slots_[(head_ + size_) % slots_.size()];
+    Task task = std::move(slot);
+    slot = nullptr;
+    return task;
+}
+
+WorkPool::Task WorkPool::TaskRing::pop_front() {
+    Task& slot = slots_[head_];
+    Task task = std::move(slot);
+    slot = nullptr;
+    head_ = (head_ + 1) % slots_.size();
+    --size_;
+    return task;
+}
+
+void WorkPool::reserve(std::size_t tasks) {
+    for (auto& q : queues_) {
+        std::lock_guard<std::mutex> lk(q->m);
+        q->tasks.reserve(tasks);
+    }
+}
+
+void WorkPool::submit(Task task) {
+    // Workers push onto their own deque (good locality for nested work);
+    // outside callers spread round-robin so every worker gets something.
+    unsigned q;
+    if (tl_pool == this)
+        q = tl_index;
+    else
+        q = next_queue_.fetch_add(1, std::memory_order_relaxed) % static_cast<unsigned>(queues_.size());
+
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lk(queues_[q]->m);
+        queues_[q]->tasks.push_back(std::move(task));
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lk(sleep_m_);
+    }
+    sleep_cv_.notify_one();
+}
+
+bool WorkPool::popLocal(unsigned index, Task& out) {
+    auto& q = *queues_[index];
+    std::lock_guard<std::mutex> lk(q.m);
+    if (q.tasks.empty())
+        return false;
+    out = q.tasks.pop_back();
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool WorkPool::steal(unsigned thief, Task& out) {
+    const unsigned n = static_cast<unsigned>(queues_.size());
+    for (unsigned k = 1; k < n; ++k) {
+        auto& q = *queues_[(thief + k) % n];
+        std::lock_guard<std::mutex> lk(q.m);
+        if (q.tasks.empty())
+            continue;
+        out = q.tasks.pop_front();
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void WorkPool::runTask(Task& task) {
+    const WorkPool* outer = tl_task_pool;
+    tl_task_pool = this;
+    try {
+        task();
+    } catch (...) {
+        std::lock_guard<std::mutex> lk(error_m_);
+        if (!error_)
+            error_ = std::current_exception();
+    }
+    tl_task_pool = outer;
+    task = nullptr;
+    const std::size_t left = pending_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    if (left <= nested_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lk(sleep_m_);
+        done_cv_.notify_all();
+    }
+}
+
+void WorkPool::workerLoop(unsigned index) {
+    tl_pool = this;
+    tl_index = index;
+
+    Task task;
+    for (;;) {
+        if (popLocal(index, task) || steal(index, task)) {
+            runTask(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(sleep_m_);
+        sleep_cv_.wait(lk, [this] { return stop_ || queued_.load(std::memory_order_acquire) > 0; });
+        if (stop_ && queued_.load() == 0)
+            return;
+    }
+}
+
+template<typename Done>
+void WorkPool::helpUntil(Done done) {
+    // Help out rather than idle; the external queue is the last slot.
+    const unsigned self = (tl_pool == this) ? tl_index : static_cast<unsigned>(queues_.size() - 1);
+
+    Task task;
+    while (!done()) {
+        if (popLocal(self, task) || steal(self, task)) {
+            runTask(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(sleep_m_);
+        done_cv_.wait_for(lk, std::chrono::milliseconds(1),
+                          [&] { return done() || queued_.load() > 0; });
+    }
+}
+
+void WorkPool::wait() {
+    // The calling task, and any other task blocked here, can only finish
+    // once this returns, so a nested wait stops at them
+    if (tl_task_pool == this) {
+        nested_.fetch_add(1, std::memory_order_acq_rel);
+        helpUntil([this] { return pending_.load(std::memory_order_acquire) <= nested_.load(std::memory_order_acquire); });
+        nested_.fetch_sub(1, std::memory_order_acq_rel);
+    } else {
+        helpUntil([this] { return pending_.load(std::memory_order_acquire) == 0; });
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lk(error_m_);
+        error.swap(error_);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void WorkPool::parallel_for(std::size_t n, const std::function<void(std::size_t)>& fn, std::size_t grain) {
+    grain = std::max<std::size_t>(1, grain);
+
+    // This call's chunks only, so waiting never counts the task we're in
+    struct Batch {
+        std::atomic<std::size_t> left{0};
+        std::mutex m;
+        std::exception_ptr error;
+    } batch;
+    batch.left.store((n + grain - 1) / grain, std::memory_order_relaxed);
+
+    for (std::size_t begin = 0; begin < n; begin += grain) {
+        const std::size_t end = std::min(n, begin + grain);
+        submit([this, &batch, &fn, begin, end] {
+            try {
+                for (std::size_t i = begin; i < end; ++i)
+                    fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lk(batch.m);
+                if (!batch.error)
+                    batch.error = std::current_exception();
+            }
+            // Nothing touches batch after this; parallel_for may have returned
+            if (batch.left.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lk(sleep_m_);
+                done_cv_.notify_all();
+            }
+        });
+    }
+    helpUntil([&batch] { return batch.left.load(std::memory_order_acquire) == 0; });
+    if (batch.error)
+        std::rethrow_exception(batch.error);
+}
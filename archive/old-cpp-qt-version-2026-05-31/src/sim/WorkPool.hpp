@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Each worker owns a deque: it pops its own work
+// from the back and steals from the front of the others when it runs dry.
+// The thread calling wait() helps drain the queues instead of blocking.
+//
+// A task that throws doesn't take the worker down: the first exception is
+// kept and rethrown from the next wait() (or from the parallel_for it ran
+// under).
+class WorkPool {
+public:
+  using Task = std::function<void()>;
+
+  explicit WorkPool(unsigned threads = 0); // 0 = hardware_concurrency
+  ~WorkPool();
+
+  WorkPool(const WorkPool&) = delete;
+  WorkPool& operator=(const WorkPool&) = delete;
+
+  void submit(Task task);
+  // Until every submitted task has finished. Called from inside a task of
+  // this pool, it doesn't wait for that task or for others blocked in wait().
+  void wait();
+
+  // Room for `tasks` queued tasks on every queue, so submit() doesn't
+  // allocate while a tick is running. Call with nothing in flight.
+  void reserve(std::size_t tasks);
+
+  // Runs fn(i) for i in [0, n) in chunks of `grain`, blocking until done.
+  // Counts its own chunks only, so a task may call it on the same pool.
+  void parallel_for(std::size_t n, const std::function<void(std::size_t)>& fn, std::size_t grain = 1);
+
+  unsigned size() const { return static_cast<unsigned>(threads_.size()); }
+
+private:
+  // Ring over a vector: doubles when full and keeps its capacity, so a
+  // steady submit/pop cycle never allocates (std::deque recycles blocks).
+  class TaskRing {
+  public:
+    bool empty() const { return size_ == 0; }
+    void reserve(std::size_t n);
+    void push_back(Task task);
+    Task pop_back();
+    Task pop_front();
+
+  private:
+    std::vector<Task> slots_;
+    std::size_t head_{0};
+    std::size_t size_{0};
+  };
+
+  struct Queue {
+    std::mutex m;
+    TaskRing tasks;
+  };
+
+  void workerLoop(unsigned index);
+  bool popLocal(unsigned index, Task& out);
+  bool steal(unsigned thief, Task& out);
+  void runTask(Task& task);
+  template<typename Done>
+  void helpUntil(Done done);
+
+  std::vector<std::unique_ptr<Queue>> queues_;  // one per worker + one for external callers
+  std::vector<std::thread> threads_;
+
+  std::mutex sleep_m_;
+  std::condition_variable sleep_cv_;
+  std::condition_variable done_cv_;
+  std::atomic<std::size_t> queued_{0};   // tasks sitting in queues
+  std::atomic<std::size_t> pending_{0};  // submitted but not finished
+  std::atomic<std::size_t> nested_{0};   // tasks blocked in wait()
+  std::mutex error_m_;
+  std::exception_ptr error_;             // first exception out of a task
+  std::atomic<unsigned> next_queue_{0};
+  bool stop_{false};
+};
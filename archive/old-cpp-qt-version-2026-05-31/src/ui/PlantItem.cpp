@@ -2,7 +2,48 @@
 #include <QPen>
 #include <QBrush>
 #include <QColor>
-#include <QStringBuilder>
+#include <QPainter>
+#include <cmath>
+#include "../sim/SnapshotChannel.hpp"
+
+namespace {
+
+constexpr double kLineHeight = 16.0;
+constexpr double kPad = 10.0;
+
+struct LiveField {
+    std::uint32_t bit;
+    const char* label;
+    bool isBool;
+};
+
+// Order matches PlantItem::live_
+constexpr LiveField kLiveFields[] = {
+    {SnapLevel,    "level",     false},
+    {SnapFlow,     "flow",      false},
+    {SnapFlowRate, "flow_rate", false},
+    {SnapRunning,  "running",   true},
+    {SnapPowerOn,  "power_on",  true},
+};
+
+double liveValue(const PlantNode::Live& lv, std::size_t i) {
+    switch (i) {
+    case 0: return lv.level;
+    case 1: return lv.flow;
+    case 2: return lv.flow_rate;
+    case 3: return lv.running ? 1.0 : 0.0;
+    default: return lv.power_on ? 1.0 : 0.0;
+    }
+}
+
+bool isLiveKey(std::uint32_t present, const QString& key) {
+    for (const auto& f : kLiveFields)
+        if ((present & f.bit) && key == QLatin1String(f.label))
+            return true;
+    return false;
+}
+
+} // namespace
 
 PlantItem::PlantItem(const PlantNode& node)
     : QGraphicsRectItem(0, 0, 160, 120),
@@ -11,28 +52,82 @@ PlantItem::PlantItem(const PlantNode& node)
 {
     setPen(QPen(Qt::black, 2));
     setBrush(QColor(50,50,60));
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);  // repaint only on update()
 
-    text_ = new QGraphicsTextItem(this);
+    header_.setText(QString("[%1]").arg(node.type));
+    header_.setTextFormat(Qt::PlainText);
     updateFromNode(node);
 }
 
-void PlantItem::updateFromNode(const PlantNode& n)
+void PlantItem::rebuildStatic(const PlantNode& n)
 {
-    QString txt = QString("[%1]\n").arg(n.type);
-
+    static_.clear();
     for (auto it = n.dparams.cbegin(); it != n.dparams.cend(); ++it) {
-        txt += QString("%1: %2\n").arg(it.key()).arg(it.value(), 0, 'f', 2);
+        if (!isLiveKey(present_, it.key()))
+            static_.emplace_back(QString("%1: %2").arg(it.key()).arg(it.value(), 0, 'f', 2));
     }
     for (auto it = n.bparams.cbegin(); it != n.bparams.cend(); ++it) {
-        txt += QString("%1: %2\n").arg(it.key()).arg(it.value() ? "true" : "false");
+        if (!isLiveKey(present_, it.key()))
+            static_.emplace_back(QString("%1: %2").arg(it.key()).arg(it.value() ? "true" : "false"));
+    }
+    for (auto& t : static_)
+        t.setTextFormat(Qt::PlainText);
+}
+
+bool PlantItem::updateFromNode(const PlantNode& n)
+{
+    const auto& lv = n.live;
+    bool dirty = false;
+
+    if (lv.present != present_) {
+        present_ = lv.present;
+        rebuildStatic(n);
+        for (auto& l : live_)
+            l.shown = INT64_MIN;
+        dirty = true;
     }
 
-    if (!text_) {
-        text_ = new QGraphicsTextItem(this);
-        text_->setDefaultTextColor(Qt::white);
-        text_->setPos(10, 10);
+    for (std::size_t i = 0; i < live_.size(); ++i) {
+        const auto& f = kLiveFields[i];
+        if (!(present_ & f.bit))
+            continue;
+
+        // Quantize to what's displayed (2 decimals) so sub-pixel noise
+        // never triggers a text re-layout
+        const double v = liveValue(lv, i);
+        const std::int64_t q = f.isBool ? static_cast<std::int64_t>(v) : std::llround(v * 100.0);
+        if (q == live_[i].shown)
+            continue;
+
+        live_[i].shown = q;
+        live_[i].text.setText(f.isBool ? QString("%1: %2").arg(f.label).arg(q ? "true" : "false")
+                                       : QString("%1: %2").arg(f.label).arg(v, 0, 'f', 2));
+        live_[i].text.setTextFormat(Qt::PlainText);
+        dirty = true;
     }
 
-    text_->setPlainText(txt);
+    if (dirty)
+        update();
+    return dirty;
 }
 
+void PlantItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    QGraphicsRectItem::paint(painter, option, widget);
+
+    painter->setPen(Qt::white);
+    double y = kPad;
+    painter->drawStaticText(QPointF(kPad, y), header_);
+    y += kLineHeight;
+
+    for (std::size_t i = 0; i < live_.size(); ++i) {
+        if (!(present_ & kLiveFields[i].bit))
+            continue;
+        painter->drawStaticText(QPointF(kPad, y), live_[i].text);
+        y += kLineHeight;
+    }
+    for (const auto& t : static_) {
+        painter->drawStaticText(QPointF(kPad, y), t);
+        y += kLineHeight;
+    }
+}
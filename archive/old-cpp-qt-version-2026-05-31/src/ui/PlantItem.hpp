@@ -1,18 +1,37 @@
 #pragma once
 #include <QGraphicsRectItem>
-#include <QGraphicsTextItem>
+#include <QStaticText>
+#include <array>
+#include <cstdint>
+#include <vector>
 #include "../sim/Components.hpp"
 #include "PlantNode.hpp"
 
+// Equipment box. Text is painted from cached QStaticText lines instead of a
+// QGraphicsTextItem: static params are laid out once, and each live value
+// line is only re-laid-out when its displayed (quantized) value changes.
 class PlantItem : public QGraphicsRectItem {
 public:
     PlantItem(const PlantNode& node);
 
-    void updateFromNode(const PlantNode& node);
+    // Returns true if anything visible changed (a repaint was scheduled).
+    bool updateFromNode(const PlantNode& node);
+
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
 
     QString id;
     QString type;
 
 private:
-    QGraphicsTextItem* text_;
+    struct LiveLine {
+        QStaticText text;
+        std::int64_t shown{INT64_MIN};  // quantized value currently laid out
+    };
+
+    void rebuildStatic(const PlantNode& node);
+
+    QStaticText header_;
+    std::vector<QStaticText> static_;   // params the sim doesn't drive
+    std::array<LiveLine, 5> live_;      // level, flow, flow_rate, running, power_on
+    std::uint32_t present_{~0u};        // live fields shown; forces first rebuild
 };
@@ -1,50 +1,48 @@
 #include "PlantModel.hpp"
-#include <QFile>
-#include <QJsonDocument>
-#include <QJsonArray>
+#include <QDebug>
 
 bool PlantModel::loadFromFile(const QString& path)
 {
-    QFile f(path);
-    if (!f.open(QIODevice::ReadOnly))
+    qDebug() << "Loading plant JSON...";
+    PlantDescription plant;
+    if (!Loader::parsePlant(path.toStdString(), plant))
         return false;
 
-    qDebug() << "Loading plant JSON...";
-    QByteArray data = f.readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (!doc.isObject()) return false;
+    loadFromDescription(plant);
+    return true;
+}
 
-    auto root = doc.object();
-    auto arr = root["components"].toArray();
-    qDebug() << "Components:" << root["components"].toArray().size();
-    qDebug() << "Connections:" << root["connections"].toArray().size();
+void PlantModel::loadFromDescription(const PlantDescription& plant)
+{
+    qDebug() << "Components:" << plant.components.size();
 
-    for (auto compVal : arr) {
-        auto comp = compVal.toObject();
+    nodes_.clear();
+    edges_.clear();
+    nodes_.reserve(static_cast<qsizetype>(plant.components.size()));
 
+    for (const auto& comp : plant.components) {
         PlantNode n;
-        n.id = comp["id"].toString();
-        n.type = comp["type"].toString();
+        n.id = QString::fromStdString(comp.id);
+        n.type = QString::fromStdString(comp.type);
 
         // load params
-        auto params = comp["params"].toObject();
-        for (auto it = params.begin(); it != params.end(); ++it) {
-            if (it.value().isBool()) {
-                n.bparams[it.key()] = it.value().toBool();
-            } else if (it.value().isDouble()) {
-                n.dparams[it.key()] = it.value().toDouble();
+        for (const auto& p : comp.params) {
+            if (!p.text.empty())
+                continue;  // field references; the model only shows numbers
+            if (p.is_bool) {
+                n.bparams[QString::fromStdString(p.key)] = p.value != 0.0;
+            } else {
+                n.dparams[QString::fromStdString(p.key)] = p.value;
             }
         }
 
         // outputs
-        for (auto out : comp["outputs"].toArray()) {
-            QString s = out.toString();
+        for (const auto& out : comp.outputs) {
+            QString s = QString::fromStdString(out);
             n.outputs.push_back(s);
             edges_[n.id].push_back(s);   // works with QVector<QString>
         }
 
         nodes_[n.id] = n;
     }
-
-    return true;
 }
@@ -1,13 +1,15 @@
 #pragma once
 #include "PlantNode.hpp"
+#include "../sim/Loader.hpp"
 #include <QHash>
-#include <QJsonObject>
 #include <QString>
 #include <unordered_map>
+#include <vector>
 
 class PlantModel {
 public:
     bool loadFromFile(const QString& path);
+    void loadFromDescription(const PlantDescription& plant);
 
     const PlantNode& node(const QString& id) const { return nodes_.value(id); }
 
@@ -15,6 +17,9 @@ public:
 
     QHash<QString, PlantNode> nodes_;
 
+    // Nodes whose live values the last sim sync changed
+    std::vector<const PlantNode*> changed_;
+
     // adjacency
     QHash<QString, QVector<QString>> edges_;
 
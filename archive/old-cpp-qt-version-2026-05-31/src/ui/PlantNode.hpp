@@ -1,6 +1,7 @@
 #pragma once
 #include <QHash>
 #include <QString>
+#include <cstdint>
 #include <vector>
 #include <unordered_map>
 
@@ -13,4 +14,16 @@ struct PlantNode {
     QHash<QString, bool> bparams;                   // bool params
 
     std::vector<QString> outputs;                   // connections (IDs)
+
+    // Live values pushed by the sim through the snapshot channel.
+    // `present`/`changed` use the SnapshotField bits from SnapshotChannel.hpp.
+    struct Live {
+        float level{0.f};
+        float flow{0.f};
+        float flow_rate{0.f};
+        bool  running{false};
+        bool  power_on{false};
+        std::uint32_t present{0};
+        std::uint32_t changed{0};   // bits updated by the last sync
+    } live;
 };
@@ -9,6 +9,7 @@ void PlantScene::build(const PlantModel& m)
 {
     clear();
     items_.clear();
+    itemOf_.clear();
 
     const int X_SPACING = 220;
     const int Y_SPACING = 160;
@@ -27,6 +28,7 @@ void PlantScene::build(const PlantModel& m)
         addItem(item);
 
         items_[id] = item;
+        itemOf_.insert(&node, item);
     }
 
     // Draw arrows
@@ -48,11 +50,13 @@ void PlantScene::build(const PlantModel& m)
     }
 }
 
-void PlantScene::updateValues(const PlantModel& m)
+int PlantScene::updateValues(const PlantModel& m)
 {
-    for (auto it = m.nodes_.cbegin(); it != m.nodes_.cend(); ++it) {
-        const QString& id = it.key();
-        const PlantNode& node = it.value();
-        items_[id]->updateFromNode(node);
+    int repainted = 0;
+    for (const PlantNode* node : m.changed_) {
+        PlantItem* item = itemOf_.value(node, nullptr);
+        if (item && item->updateFromNode(*node))
+            ++repainted;
     }
+    return repainted;
 }
@@ -9,8 +9,11 @@ public:
     PlantScene(QObject* parent=nullptr);
 
     void build(const PlantModel& model);
-    void updateValues(const PlantModel& model);
+    // Refreshes only the items of model.changed_, the nodes the last sync
+    // touched. Returns how many items actually repainted.
+    int updateValues(const PlantModel& model);
 
 private:
     QHash<QString, PlantItem*> items_;
+    QHash<const PlantNode*, PlantItem*> itemOf_;  // no id lookups per frame
 };
@@ -0,0 +1,89 @@
+#include "TestSupport.hpp"
+#include "sim/AlarmEngine.hpp"
+#include <algorithm>
+#include <map>
+
+// The response timer heap: cancelled and re-armed timers are deleted lazily,
+// live ones pop in (deadline, point) order, and a point that chatters through
+// cancel/re-arm cycles never grows the heap past what compile() reserved.
+namespace {
+
+constexpr std::uint32_t kPoints = 8;
+
+AlarmEngine engine(entt::registry& r) {
+    for (std::uint32_t i = 0; i < kPoints; ++i) {
+        const auto e = r.create();
+        r.emplace<Tank>(e);
+        r.emplace<Alarmable>(e);
+    }
+    return AlarmEngine::compile(r);
+}
+
+// Pops everything due by t, as (deadline, point) pairs
+std::vector<std::pair<double, std::uint32_t>> drain(AlarmEngine& eng, double t) {
+    std::vector<std::pair<double, std::uint32_t>> out;
+    AlarmEngine::Timer timer;
+    while (eng.popDue(t, timer))
+        out.emplace_back(timer.deadline, timer.point);
+    return out;
+}
+
+void lazyDeletes() {
+    entt::registry r;
+    AlarmEngine eng = engine(r);
+    CHECK(eng.size() == kPoints);
+
+    const double deadline[kPoints] = {5, 3, 3, 9, 1, 7, 2, 8};
+    for (std::uint32_t p = 0; p < kPoints; ++p)
+        eng.activate(p, 0.0, deadline[p]);
+    eng.deactivate(2);       // its 3 goes stale
+    eng.reschedule(3, 4.0);  // its 9 goes stale
+
+    using Due = std::vector<std::pair<double, std::uint32_t>>;
+    CHECK(drain(eng, 5.0) == (Due{{1, 4}, {2, 6}, {3, 1}, {4, 3}, {5, 0}}));
+    CHECK(drain(eng, 5.0).empty());
+    CHECK(drain(eng, 100.0) == (Due{{7, 5}, {8, 7}}));
+    CHECK(eng.timers.empty());
+}
+
+void chatter() {
+    entt::registry r;
+    AlarmEngine eng = engine(r);
+    const std::size_t capacity = eng.timers.capacity();
+    CHECK(capacity >= 2 * kPoints);
+
+    // What should be live: point → deadline
+    std::map<std::uint32_t, double> live;
+    std::size_t peak = 0;
+    for (std::uint32_t round = 0; round < 400; ++round) {
+        const std::uint32_t p = (round * 3) % kPoints;
+        const double t = round;
+        if (eng.slot[p] < 0) {
+            eng.activate(p, t, t + 20.0 + p);
+            live[p] = t + 20.0 + p;
+        } else if (round % 2) {
+            eng.reschedule(p, t + 30.0);
+            live[p] = t + 30.0;
+        } else {
+            eng.deactivate(p);
+            live.erase(p);
+        }
+        peak = std::max(peak, eng.timers.size());
+    }
+    CHECK(peak <= 2 * kPoints);
+    CHECK(eng.timers.capacity() == capacity);
+
+    std::vector<std::pair<double, std::uint32_t>> expect;
+    for (const auto& [p, d] : live)
+        expect.emplace_back(d, p);
+    std::sort(expect.begin(), expect.end());
+    CHECK(drain(eng, 1e9) == expect);
+}
+
+} // namespace
+
+int main() {
+    lazyDeletes();
+    chatter();
+    return checkFailures();
+}
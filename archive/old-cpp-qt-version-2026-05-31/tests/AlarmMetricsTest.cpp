@@ -0,0 +1,99 @@
+#include "TestSupport.hpp"
+#include "sim/AlarmMetrics.hpp"
+
+// ISA-18.2 counts on a hand-built event stream: fixed periods classified as
+// acceptable/manageable/flood, one flood episode on the trailing rate, a
+// chattering point entering and leaving the window, a standing alarm going
+// stale, and the bad-actor ranking.
+namespace {
+
+entt::entity id(std::uint32_t i) { return static_cast<entt::entity>(i); }
+
+// Activation at t, returned at once unless it stands, then the tick's advance
+void alarm(AlarmMetrics& m, double t, entt::entity e, bool stands = false) {
+    m.onEvent({t, e, 0, AlarmEventKind::Activated, 0.0f});
+    if (!stands)
+        m.onEvent({t, e, 0, AlarmEventKind::Returned, 0.0f});
+    m.advance(t);
+}
+
+void periods() {
+    AlarmMetricsConfig cfg;  // 600 s periods, one operator, flood 10/5, chatter 3 in 60 s
+    cfg.stale_s = 500.0;
+    AlarmMetrics m(cfg);
+
+    alarm(m, 10.0, id(1));                  // period 0: 1, acceptable
+    alarm(m, 700.0, id(2));                 // period 1: 2, manageable
+    alarm(m, 1000.0, id(2));
+    for (std::uint32_t i = 0; i < 12; ++i)  // period 2: 12 distinct points, a flood
+        alarm(m, 1300.0 + 5.0 * i, id(10 + i));
+    CHECK(m.report().in_flood);
+    CHECK(m.report().peak_rate >= 12.0);
+    CHECK(m.report().chattering == 0);
+
+    // Periods 3 and 4 quiet; the flood is long over
+    m.advance(3000.0);
+    AlarmMetricsReport r = m.report();
+    CHECK(!r.in_flood);
+    CHECK(r.floods == 1);
+    CHECK(r.flood_s > 0.0);
+
+    // Period 5: point 3 chatters (3 inside 60 s, then a 4th), point 4 stands
+    alarm(m, 3010.0, id(3));
+    alarm(m, 3020.0, id(3));
+    CHECK(m.report().chattering == 0);
+    alarm(m, 3030.0, id(3));
+    r = m.report();
+    CHECK(r.chattering == 1);
+    CHECK(r.chatter_episodes == 1);
+    CHECK(r.chatter_activations == 1);
+    alarm(m, 3040.0, id(3));
+    alarm(m, 3050.0, id(4), true);
+    r = m.report();
+    CHECK(r.chattering == 1);
+    CHECK(r.chatter_episodes == 1);
+    CHECK(r.chatter_activations == 2);
+
+    // The first three leave the window
+    m.advance(3100.0);
+    CHECK(m.report().chattering == 0);
+
+    // Point 4 has stood past stale_s
+    m.advance(3600.0);
+    CHECK(m.report().stale == 1);
+    m.onEvent({3700.0, id(4), 0, AlarmEventKind::Returned, 0.0f});
+    m.advance(3700.0);
+    CHECK(m.report().stale == 0);
+    CHECK(m.report().stale_total == 1);
+
+    // Closes periods 5 (5 activations) and 6 (quiet)
+    m.advance(4200.0);
+    r = m.report();
+    CHECK(r.activations == 20);
+    CHECK(r.periods == 7);
+    CHECK(r.periods_acceptable == 4);
+    CHECK(r.periods_manageable == 5);
+    CHECK(r.periods_flood == 1);
+
+    const std::vector<BadActor> top = m.badActors(1);
+    CHECK(top.size() == 1 && top[0].entity == id(3) && top[0].count == 4);
+}
+
+// No room for a chatter queue: activations still count, nothing chatters
+void noPending() {
+    AlarmMetricsConfig cfg;
+    cfg.max_pending = 0;
+    AlarmMetrics m(cfg);
+    for (int i = 0; i < 5; ++i)
+        alarm(m, 10.0 * i, id(1));
+    CHECK(m.report().activations == 5);
+    CHECK(m.report().chattering == 0);
+}
+
+} // namespace
+
+int main() {
+    periods();
+    noPending();
+    return checkFailures();
+}
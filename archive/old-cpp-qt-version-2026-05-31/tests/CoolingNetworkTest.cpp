@@ -0,0 +1,135 @@
+#include "TestSupport.hpp"
+#include "sim/CoolingNetwork.hpp"
+#include <algorithm>
+#include <cmath>
+
+// One chilled-water loop, ten coils and an air-cooled compressor, worked by
+// hand: the coils' share falls linearly from full duty 1 K above supply_sp
+// to nothing at return_design, and the compressor's freeze cutout trips
+// below 3 °C and holds until the supply is back above 5 °C.
+namespace {
+
+constexpr float kDt = 1.0f;
+
+bool near(double x, double expect, double tol = 1e-4) {
+    if (std::abs(x - expect) <= tol * std::max(1.0, std::abs(expect)))
+        return true;
+    std::fprintf(stderr, "got %.9g, expected %.9g\n", x, expect);
+    return false;
+}
+
+struct Plant {
+    entt::registry r;
+    entt::entity loop, compressor;
+    std::vector<entt::entity> loads;
+    CoolingNetwork net;
+
+    Plant() {
+        loop = r.create();
+        ChilledWaterLoop& lp = r.emplace<ChilledWaterLoop>(loop);
+        lp.supply_sp = 7.0f;
+        lp.return_design = 12.0f;
+        lp.flow_kg_s = 100.0f;
+        lp.thermal_mass = 50000.0f;
+
+        // Half of four stages, held there for the whole test
+        compressor = r.create();
+        RefrigerationCompressor& k = r.emplace<RefrigerationCompressor>(compressor);
+        k.stage = 2;
+        k.stage_delay_s = 1e6f;
+        k.cooling_kw = 1000.0f;
+
+        // 100..900 fill one whole block of the prorata lanes and one tail
+        // lane; a negative demand asks for nothing
+        for (int d = 1; d <= 9; ++d) {
+            const auto e = r.create();
+            r.emplace<CoolingLoad>(e, CoolingLoad{100.f * static_cast<float>(d), 0.f, 0});
+            loads.push_back(e);
+        }
+        const auto idle = r.create();
+        r.emplace<CoolingLoad>(idle, CoolingLoad{-50.f, 0.f, 0});
+        loads.push_back(idle);
+
+        net = CoolingNetwork::compile(r);
+    }
+
+    ChilledWaterLoop& chw() { return r.get<ChilledWaterLoop>(loop); }
+    RefrigerationCompressor& comp() { return r.get<RefrigerationCompressor>(compressor); }
+
+    // Coils granted d * frac at this supply temperature
+    void grants(float supply, double frac) {
+        chw().supply_temp = supply;
+        net.step(kDt);
+        for (auto e : loads) {
+            const CoolingLoad& l = r.get<CoolingLoad>(e);
+            CHECK(near(l.granted_kw, std::max(0.f, l.demand_kw) * frac));
+        }
+    }
+
+    // Tripped or not after one refrigeration pass at this supply temperature
+    bool tripped(float supply) {
+        chw().supply_temp = supply;
+        net.refrigerate(kDt);
+        return comp().tripped;
+    }
+};
+
+// Air-cooled: condensing at 35 °C, evaporating 5 K below supply, capacity
+// derated 1.5 % per K of lift over 33 K
+double duty(double supply) {
+    const double lift = 35.0 - (supply - 5.0);
+    return 500.0 * 0.5 * (1.0 - 0.015 * (lift - 33.0));
+}
+
+void proration() {
+    Plant p;
+    CHECK(p.net.loopCount() == 1 && p.net.loadCount() == 10);
+
+    // span = 12 - 7 - 1 = 4 K, so 10 °C leaves (12 - 10) / 4 = 1/2 of the
+    // 4500 asked for; the loop warms by (2250 - 1000) / 50000 per second
+    p.grants(10.0f, 0.5);
+    const ChilledWaterLoop& lp = p.chw();
+    CHECK(near(lp.cooling_demand_kw, 4500.0));
+    CHECK(near(lp.cooling_supply_kw, 1000.0));
+    CHECK(near(lp.unmet_cooling_kw, 2250.0));
+    CHECK(near(lp.unmet_kwh, 2250.0 / 3600.0));
+    CHECK(near(lp.return_temp, 10.0 + 2250.0 / (100.0 * 4.19)));
+    CHECK(near(lp.supply_temp, 10.0 + 1250.0 / 50000.0));
+
+    // Full duty up to 8 °C, nothing from 12 °C on
+    p.grants(7.5f, 1.0);
+    CHECK(near(p.chw().unmet_cooling_kw, 0.0));
+    p.grants(8.0f, 1.0);
+    p.grants(11.0f, 0.25);
+    p.grants(12.0f, 0.0);
+    p.grants(14.0f, 0.0);
+    CHECK(near(p.chw().unmet_cooling_kw, 4500.0));
+}
+
+void cutout() {
+    Plant p;
+    CHECK(!p.tripped(6.0f));
+    CHECK(near(p.comp().cooling_kw, duty(6.0)));
+    CHECK(!p.tripped(3.0f));
+
+    // Below kCutout it trips, and stays tripped through the 2 K reset band
+    CHECK(p.tripped(2.9f));
+    CHECK(p.comp().cooling_kw == 0.f);
+    CHECK(p.tripped(4.0f));
+    CHECK(p.comp().cooling_kw == 0.f);
+    CHECK(p.tripped(5.0f));
+    CHECK(p.comp().cooling_kw == 0.f);
+
+    // Only above kCutout + kCutoutReset does it run again
+    CHECK(!p.tripped(5.5f));
+    CHECK(near(p.comp().cooling_kw, duty(5.5)));
+    CHECK(p.comp().stage == 2);
+}
+
+} // namespace
+
+int main() {
+    proration();
+    cutout();
+    return checkFailures();
+}
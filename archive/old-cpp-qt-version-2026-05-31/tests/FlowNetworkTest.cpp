@@ -0,0 +1,94 @@
+#include "TestSupport.hpp"
+#include "sim/FlowNetwork.hpp"
+#include "sim/Loader.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Tank A → junction J → tank B, small enough to solve by hand: the junction
+// head balances the two edge flows, and the tanks move by that flow.
+namespace {
+
+constexpr float kEps = 1e-3f;  // FlowNetwork's conductance regularisation
+
+struct Line {
+    entt::registry r;
+    entt::entity a, j, b;
+    FlowNetwork net;
+
+    Line(float hA, float hB, float kA, float kJ, float dp, bool turbulent) {
+        a = r.create();
+        j = r.create();
+        b = r.create();
+        r.emplace<Tank>(a, Tank{hA, 2.0f});
+        r.emplace<Pipe>(a, Pipe{kA, turbulent});
+        r.emplace<Pipe>(j, Pipe{kJ, turbulent});
+        if (dp > 0.f)
+            r.emplace<Pump>(j, Pump{true, dp});
+        r.emplace<Tank>(b, Tank{hB, 4.0f});
+        PlantTopology topo;
+        topo.edges = {{a, j}, {j, b}};
+        net = FlowNetwork::compile(r, topo);
+    }
+
+    float head(entt::entity e) const {
+        for (std::size_t i = 0; i < net.nodeCount(); ++i)
+            if (net.entity[i] == e)
+                return net.head[i];
+        return NAN;
+    }
+};
+
+bool near(double x, double expect, double tol) {
+    if (std::abs(x - expect) <= tol * std::max(1.0, std::abs(expect)))
+        return true;
+    std::fprintf(stderr, "got %.9g, expected %.9g\n", x, expect);
+    return false;
+}
+
+// g1 (hA - hJ) = g2 (hJ + dp - hB)  →  hJ = (g1 hA + g2 (hB - dp)) / (g1 + g2)
+void linear() {
+    const float hA = 0.8f, hB = 0.2f, kA = 0.5f, kJ = 1.5f, dp = 0.3f, dt = 0.1f;
+    Line l(hA, hB, kA, kJ, dp, false);
+    CHECK(l.net.junctions.size() == 1);
+
+    const double g1 = 1.0f / (kA + kEps), g2 = 1.0f / (kJ + kEps);
+    const double hJ = (g1 * hA + g2 * (hB - dp)) / (g1 + g2);
+    const double q  = g1 * (hA - hJ);
+
+    l.net.step(dt);
+    CHECK(near(l.head(l.j), hJ, 1e-5));
+    const Tank& A = l.r.get<Tank>(l.a);
+    const Tank& B = l.r.get<Tank>(l.b);
+    CHECK(near(A.outflow, q, 1e-5));
+    CHECK(near(B.inflow, q, 1e-5));
+    CHECK(near(A.level, hA - q / 2.0 * dt, 1e-5));
+    CHECK(near(B.level, hB + q / 4.0 * dt, 1e-5));
+
+    // Same conductances next tick: the factor is reused
+    const std::uint64_t f = l.net.factorizations;
+    l.net.step(dt);
+    CHECK(l.net.factorizations == f);
+}
+
+// Equal turbulent edges: by symmetry the junction sits halfway, and each
+// edge carries g d / sqrt(|d| + h0) on half the drop
+void turbulent() {
+    const float hA = 0.9f, hB = 0.1f, k = 0.8f;
+    Line l(hA, hB, k, k, 0.f, true);
+
+    const double g = 1.0f / (k + kEps), d = (hA - hB) / 2.0;
+    const double q = g * d / std::sqrt(d + 1e-2);
+
+    l.net.step(0.01f);
+    CHECK(near(l.head(l.j), (hA + hB) / 2.0, 1e-5));
+    CHECK(near(l.r.get<Tank>(l.a).outflow, q, 1e-4));
+    CHECK(near(l.r.get<Tank>(l.b).inflow, q, 1e-4));
+}
+
+} // namespace
+
+int main() {
+    linear();
+    turbulent();
+    return checkFailures();
+}
@@ -0,0 +1,46 @@
+#include "TestSupport.hpp"
+#include "sim/BatchKernels.hpp"
+#include "sim/Integrator.hpp"
+#include <bit>
+#include <cmath>
+
+// RK4 lags past the single-step stability limit (h ~ 2.78*tau) must still
+// decay, stay close to the exact 1 - exp(-r), and the batched hxLag must
+// match the scalar formula when only some lanes need substeps.
+int main() {
+    for (float r = 0.0f; r <= 100.0f; r += 0.05f) {
+        const float a = lagAlpha(Integrator::RK4, r);
+        CHECK(a >= 0.0f && a <= 1.0f);
+        CHECK(std::abs(a - (1.0f - std::exp(-r))) < 0.01f);
+    }
+
+    // advance() on the same lag, dx/dt = -x/tau, with its slope as dfdx
+    for (float h : {0.5f, 2.0f, 3.0f, 10.0f, 50.0f}) {
+        const float x = advance(Integrator::RK4, 1.0f, h, [](float v) { return -v; }, -1.0f);
+        CHECK(x >= 0.0f && x < 1.0f);
+        CHECK(std::abs(x - std::exp(-h)) < 0.01f);
+    }
+
+    // Lanes either side of kRk4MaxR in every vector block, plus a masked-off one
+    constexpr std::size_t n = 37;
+    float inlet[n], pos[n], tau[n], flow[n], outlet[n], expect[n];
+    std::uint32_t on[n];
+    const float dt = 0.5f;
+    for (std::size_t i = 0; i < n; ++i) {
+        inlet[i]  = 80.0f + static_cast<float>(i);
+        pos[i]    = 0.1f * static_cast<float>(i % 11);
+        tau[i]    = i % 3 == 0 ? 0.05f : 4.0f + static_cast<float>(i);
+        flow[i]   = 0.5f + 0.25f * static_cast<float>(i % 5);
+        outlet[i] = 20.0f;
+        on[i]     = i % 7 == 6 ? 0u : ~0u;
+
+        const float target  = inlet[i] * std::clamp(pos[i], 0.0f, 1.0f);
+        const float tau_eff = std::max(0.1f, tau[i] / std::max(0.1f, flow[i]));
+        expect[i] = on[i] ? outlet[i] + lagAlpha(Integrator::RK4, dt / tau_eff) * (target - outlet[i]) : outlet[i];
+    }
+    BatchKernels::hxLag(n, inlet, pos, tau, flow, on, outlet, dt, Integrator::RK4);
+    for (std::size_t i = 0; i < n; ++i)
+        CHECK(std::bit_cast<std::uint32_t>(outlet[i]) == std::bit_cast<std::uint32_t>(expect[i]));
+
+    return checkFailures();
+}
@@ -0,0 +1,109 @@
+#include "TestSupport.hpp"
+#include "sim/ParameterSweep.hpp"
+#include <cmath>
+#include <numbers>
+
+// Design layouts the sweep's index estimators rely on, and the Sobol
+// estimators against the Ishigami function's analytic indices.
+namespace {
+
+SweepConfig design(SweepDesign d, std::size_t k, std::size_t samples) {
+    SweepConfig cfg;
+    cfg.design = d;
+    cfg.samples = samples;
+    cfg.params.assign(k, SweepParameter{"PID.kp", 0.f, 1.f, 2});
+    return cfg;
+}
+
+void latinHypercube() {
+    const std::size_t n = 50, k = 4;
+    const auto pts = ParameterSweep::unitDesign(design(SweepDesign::LatinHypercube, k, n));
+    CHECK(pts.size() == n);
+    // Every column puts exactly one point in each of the n strata
+    for (std::size_t j = 0; j < k; ++j) {
+        std::vector<int> hits(n, 0);
+        for (const auto& p : pts) {
+            CHECK(p[j] >= 0.0 && p[j] < 1.0);
+            ++hits[static_cast<std::size_t>(p[j] * static_cast<double>(n))];
+        }
+        for (int h : hits)
+            CHECK(h == 1);
+    }
+}
+
+void grid() {
+    SweepConfig cfg = design(SweepDesign::Grid, 3, 0);
+    cfg.params[0].levels = 2;
+    cfg.params[1].levels = 1;
+    cfg.params[2].levels = 3;
+    const auto pts = ParameterSweep::unitDesign(cfg);
+    CHECK(pts.size() == 6);
+    // Mixed radix, last parameter fastest; a single level sits mid-range
+    const double expect[6][3] = {{0, 0.5, 0}, {0, 0.5, 0.5}, {0, 0.5, 1},
+                                 {1, 0.5, 0}, {1, 0.5, 0.5}, {1, 0.5, 1}};
+    for (std::size_t c = 0; c < pts.size() && c < 6; ++c)
+        for (std::size_t j = 0; j < 3; ++j)
+            CHECK(pts[c][j] == expect[c][j]);
+}
+
+void sobolLayout() {
+    const std::size_t n = 32, k = 3;
+    const auto pts = ParameterSweep::unitDesign(design(SweepDesign::Sobol, k, n));
+    CHECK(pts.size() == n * (k + 2));
+    if (pts.size() != n * (k + 2))
+        return;
+    // A, B, then AB_j: A with column j taken from B
+    for (std::size_t j = 0; j < k; ++j)
+        for (std::size_t i = 0; i < n; ++i)
+            for (std::size_t c = 0; c < k; ++c)
+                CHECK(pts[(2 + j) * n + i][c] == (c == j ? pts[n + i][c] : pts[i][c]));
+    // A and B are different quasi-random columns, not copies; only the
+    // sequence's first point (0.5 in every dimension) is shared
+    std::size_t same = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        same += pts[i] == pts[n + i];
+    CHECK(same <= 1);
+}
+
+// Y = sin x1 + 7 sin^2 x2 + 0.1 x3^4 sin x1 on [-pi, pi]^3
+void ishigami() {
+    const std::size_t n = 4096, k = 3;
+    const auto pts = ParameterSweep::unitDesign(design(SweepDesign::Sobol, k, n));
+    auto f = [](const std::vector<double>& u) {
+        const double pi = std::numbers::pi;
+        const double x1 = -pi + 2 * pi * u[0], x2 = -pi + 2 * pi * u[1], x3 = -pi + 2 * pi * u[2];
+        return std::sin(x1) + 7.0 * std::sin(x2) * std::sin(x2) + 0.1 * std::pow(x3, 4) * std::sin(x1);
+    };
+    std::vector<double> y;
+    for (const auto& p : pts)
+        y.push_back(f(p));
+
+    const double first[3] = {0.3139, 0.4424, 0.0};
+    const double total[3] = {0.5576, 0.4424, 0.2437};
+    const std::vector<double> fA(y.begin(), y.begin() + n), fB(y.begin() + n, y.begin() + 2 * n);
+    for (std::size_t j = 0; j < k; ++j) {
+        const std::vector<double> fAB(y.begin() + (2 + j) * n, y.begin() + (3 + j) * n);
+        double s1 = 0.0, st = 0.0;
+        ParameterSweep::sobolIndices(fA, fB, fAB, s1, st);
+        if (std::abs(s1 - first[j]) > 0.05 || std::abs(st - total[j]) > 0.05)
+            std::fprintf(stderr, "x%zu: first %.4f (%.4f) total %.4f (%.4f)\n", j + 1, s1, first[j], st, total[j]);
+        CHECK(std::abs(s1 - first[j]) <= 0.05);
+        CHECK(std::abs(st - total[j]) <= 0.05);
+    }
+
+    // A constant output has no variance to apportion
+    const std::vector<double> flat(n, 3600.0);
+    double s1 = -1.0, st = -1.0;
+    ParameterSweep::sobolIndices(flat, flat, flat, s1, st);
+    CHECK(s1 == 0.0 && st == 0.0);
+}
+
+} // namespace
+
+int main() {
+    latinHypercube();
+    grid();
+    sobolLayout();
+    ishigami();
+    return checkFailures();
+}
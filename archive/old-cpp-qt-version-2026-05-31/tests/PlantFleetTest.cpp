@@ -0,0 +1,85 @@
+#include "TestSupport.hpp"
+#include "sim/PlantFleet.hpp"
+#include "sim/SimRunner.hpp"
+#include <memory>
+#include <string>
+
+// A fleet of N instances against N SimRunners ticking on their own: same
+// plant, same commands, every reflected field bit for bit. Also checks that
+// a failed load leaves the fleet running on its old instances.
+namespace {
+
+constexpr float kDt = 0.05f;
+constexpr std::size_t kInstances = 5;
+
+// Pump → tank (PID, valve, alarm) → heat exchanger (valve), per loop, with
+// setpoints and alarm limits spread so the batched lanes see varied data
+PlantDescription plant(std::size_t loops) {
+    PlantDescription d;
+    for (std::size_t i = 0; i < loops; ++i) {
+        const std::string n = std::to_string(i);
+        const double f = static_cast<double>(i) / static_cast<double>(loops);
+        d.components.push_back({"pump" + n, "Pump", {{"dp_nominal", 1.2 + f}}, {"tank" + n}, {}});
+        d.components.push_back({"tank" + n, "Tank", {{"level", 0.2 + 0.5 * f}, {"area", 1.5 + f}}, {"hx" + n},
+                                {{"PID", {{"sp", 0.4 + 0.3 * f}, {"kp", 1.0 + f}}},
+                                 {"ValveActuator", {{"speed", 0.3 + 0.5 * f}}},
+                                 {"Alarmable", {{"hiSP", 0.5 + 0.2 * f}, {"loSP", 0.25}}},
+                                 {"AlarmResponse", {}}}});
+        d.components.push_back({"hx" + n, "HeatExchanger", {{"power_on", 1.0, true}, {"flow_rate", 0.5 + f}}, {},
+                                {{"ValveActuator", {{"pos", f}}}}});
+    }
+    return d;
+}
+
+} // namespace
+
+int main() {
+    const PlantDescription desc = plant(6);
+
+    PlantFleet fleet(kDt);
+    CHECK(fleet.load(desc, kInstances));
+    fleet.setThreads(2);
+    std::vector<std::unique_ptr<SimRunner>> alone;
+    for (std::size_t i = 0; i < kInstances; ++i) {
+        alone.push_back(std::make_unique<SimRunner>(kDt));
+        CHECK(alone.back()->loadDefaultScenario(desc));
+    }
+
+    for (int block = 0; block < 8; ++block) {
+        // A different operator input per instance and block
+        const std::size_t i = static_cast<std::size_t>(block) % kInstances;
+        Command c;
+        c.kind = CommandKind::SetSetpoint;
+        c.target = alone[i]->entityFromId.at("tank" + std::to_string(block % 6));
+        c.value = 0.3f + 0.05f * static_cast<float>(block);
+        fleet.submit(i, c);
+        alone[i]->submit(c);
+
+        fleet.run(250);
+        for (auto& r : alone)
+            r->run(250);
+        for (std::size_t k = 0; k < kInstances; ++k) {
+            if (!sameState(fleet.instance(k).reg(), alone[k]->reg())) {
+                std::fprintf(stderr, "instance %zu diverged by step %llu\n", k,
+                             static_cast<unsigned long long>(fleet.step()));
+                CHECK(false);
+                return checkFailures();
+            }
+        }
+    }
+
+    // A truncated image (magic only) fails in every instance's load: the
+    // fleet keeps its instances and still ticks
+    const char* bad = "fleet_test_truncated.img";
+    if (std::FILE* f = std::fopen(bad, "wb")) {
+        std::fwrite("EXSIMIMG", 1, 8, f);
+        std::fclose(f);
+    }
+    const std::uint64_t before = fleet.step();
+    CHECK(!fleet.load(std::string(bad), 3));
+    std::remove(bad);
+    CHECK(fleet.size() == kInstances);
+    fleet.run(10);
+    CHECK(fleet.step() == before + 10);
+    return checkFailures();
+}
@@ -0,0 +1,83 @@
+#include "TestSupport.hpp"
+#include "sim/SimClock.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+// Drives the clock with synthetic frames: `wall_dt` between frames and at
+// most `can_run` steps per frame, standing in for the frame budget.
+namespace {
+
+ClockStats drive(SimClock& clock, double wall_s, double wall_dt, int can_run) {
+    for (double t = 0.0; t < wall_s; t += wall_dt) {
+        const int due = clock.beginFrame(wall_dt);
+        clock.endFrame(std::min(due, can_run), 0.0);
+    }
+    return clock.stats();
+}
+
+} // namespace
+
+int main() {
+    // 1000x at 60 fps owes ~833 steps of 0.02 s a frame: within the step
+    // budget, so the sim keeps up and nothing is dropped
+    {
+        SimClock clock(0.02);
+        clock.setTimeScale(1000.0);
+        const ClockStats s = drive(clock, 10.0, 1.0 / 60.0, 1000);
+        CHECK(s.dropped_s == 0.0);
+        CHECK(s.overruns == 0);
+        const double sim_s = static_cast<double>(s.steps) * clock.fixedDt();
+        CHECK(sim_s > 0.99 * 10.0 * 1000.0);
+    }
+
+    // Same speed on a machine that manages 100 steps a frame: lag builds up
+    // to max lag (wall) and the rest is dropped, not owed forever
+    {
+        SimClock clock(0.02);
+        clock.setTimeScale(1000.0);
+        clock.setMaxLag(2.0);
+        const ClockStats s = drive(clock, 10.0, 1.0 / 60.0, 100);
+        CHECK(s.overruns > 0);
+        CHECK(s.dropped_s > 0.0);
+        CHECK(s.lag_s <= 2.0 * 1000.0);
+        const double sim_s = static_cast<double>(s.steps) * clock.fixedDt();
+        CHECK(std::abs(sim_s + s.dropped_s + s.lag_s - 10.0 * 1000.0) < 25.0);
+    }
+
+    // A frame that falls behind briefly catches up without dropping
+    {
+        SimClock clock(0.02);
+        const int first = clock.beginFrame(1.0);
+        clock.endFrame(10, 0.0);
+        CHECK(first == 50);
+        CHECK(clock.stats().overruns == 1);
+        CHECK(clock.stats().dropped_s == 0.0);
+        const ClockStats s = drive(clock, 1.0, 1.0 / 60.0, 1000);
+        CHECK(s.lag_s == 0.0);
+        CHECK(s.dropped_s == 0.0);
+    }
+
+    // A week-long stall at 1000x with a tiny step would owe ~6e16 steps; the
+    // frame is clamped to max lag before counting them
+    {
+        SimClock clock(1e-6);
+        clock.setTimeScale(1000.0);
+        clock.setMaxLag(2.0);
+        const int due = clock.beginFrame(7.0 * 24.0 * 3600.0);
+        CHECK(due == clock.maxStepsPerFrame());
+        clock.endFrame(due, 0.0);
+        const ClockStats& s = clock.stats();
+        CHECK(s.overruns == 1);
+        CHECK(s.dropped_s > 6.0e8);
+        CHECK(s.lag_s <= 2.0 * 1000.0);
+
+        // Uncapped, the steps it hands out still stop at max lag
+        SimClock big(0.02);
+        big.setTimeScale(1000.0);
+        big.setMaxStepsPerFrame(INT_MAX);
+        const int owed = big.beginFrame(1.0e12);
+        CHECK(owed > 0 && owed <= static_cast<int>((2.0 * 1000.0 + 0.02) / 0.02) + 1);
+    }
+    return checkFailures();
+}
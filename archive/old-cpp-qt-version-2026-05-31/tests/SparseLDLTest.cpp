@@ -0,0 +1,115 @@
+#include "TestSupport.hpp"
+#include "sim/SparseLDL.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// SparseLDL against a dense elimination on random weighted Laplacians plus a
+// positive diagonal (the shape FlowNetwork assembles), then refactored with
+// new values on the same pattern, as each tick does.
+namespace {
+
+using Pairs = std::vector<std::pair<std::uint32_t, std::uint32_t>>;
+
+// Assembles into both the factor's slots and a dense row-major copy
+void assemble(SparseLDL& ldl, std::vector<double>& dense, std::size_t n, const Pairs& pairs, std::mt19937& rng) {
+    std::uniform_real_distribution<double> w(0.05, 3.0);
+    auto& v = ldl.values();
+    std::fill(v.begin(), v.end(), 0.0);
+    dense.assign(n * n, 0.0);
+    for (std::uint32_t i = 0; i < n; ++i) {
+        const double d = 0.1 * w(rng);
+        v[ldl.diagSlot(i)] += d;
+        dense[i * n + i] += d;
+    }
+    for (std::size_t k = 0; k < pairs.size(); ++k) {
+        const auto [a, b] = pairs[k];
+        const double c = w(rng);
+        v[ldl.diagSlot(a)] += c;
+        v[ldl.diagSlot(b)] += c;
+        v[ldl.pairSlot(k)] -= c;
+        dense[a * n + a] += c;
+        dense[b * n + b] += c;
+        dense[a * n + b] -= c;
+        dense[b * n + a] -= c;
+    }
+}
+
+// Gaussian elimination with partial pivoting
+std::vector<double> denseSolve(std::vector<double> A, std::vector<double> b, std::size_t n) {
+    for (std::size_t c = 0; c < n; ++c) {
+        std::size_t p = c;
+        for (std::size_t r = c + 1; r < n; ++r)
+            if (std::abs(A[r * n + c]) > std::abs(A[p * n + c]))
+                p = r;
+        for (std::size_t k = 0; k < n; ++k)
+            std::swap(A[c * n + k], A[p * n + k]);
+        std::swap(b[c], b[p]);
+        for (std::size_t r = c + 1; r < n; ++r) {
+            const double f = A[r * n + c] / A[c * n + c];
+            for (std::size_t k = c; k < n; ++k)
+                A[r * n + k] -= f * A[c * n + k];
+            b[r] -= f * b[c];
+        }
+    }
+    std::vector<double> x(n);
+    for (std::size_t r = n; r-- > 0;) {
+        double s = b[r];
+        for (std::size_t k = r + 1; k < n; ++k)
+            s -= A[r * n + k] * x[k];
+        x[r] = s / A[r * n + r];
+    }
+    return x;
+}
+
+bool matches(const SparseLDL& ldl, const std::vector<double>& dense, std::size_t n, std::mt19937& rng) {
+    std::uniform_real_distribution<double> u(-5.0, 5.0);
+    std::vector<double> b(n);
+    for (auto& x : b)
+        x = u(rng);
+    const std::vector<double> expect = denseSolve(dense, b, n);
+    ldl.solve(b.data());
+    double err = 0.0, scale = 1.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        err = std::max(err, std::abs(b[i] - expect[i]));
+        scale = std::max(scale, std::abs(expect[i]));
+    }
+    if (err <= 1e-9 * scale)
+        return true;
+    std::fprintf(stderr, "n %zu: error %g\n", n, err);
+    return false;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(7);
+    std::vector<double> dense;
+    for (int trial = 0; trial < 100; ++trial) {
+        // Random sparse pattern with repeats (shared slots) and isolated rows
+        const std::size_t n = 1 + rng() % 40;
+        Pairs pairs;
+        const std::size_t m = rng() % (3 * n + 1);
+        for (std::size_t k = 0; k < m; ++k) {
+            const std::uint32_t a = static_cast<std::uint32_t>(rng() % n), b = static_cast<std::uint32_t>(rng() % n);
+            if (a != b)
+                pairs.emplace_back(a, b);
+        }
+
+        SparseLDL ldl;
+        ldl.analyze(n, pairs);
+        CHECK(ldl.size() == n);
+        for (int refactor = 0; refactor < 3; ++refactor) {
+            assemble(ldl, dense, n, pairs, rng);
+            CHECK(ldl.factor());
+            CHECK(matches(ldl, dense, n, rng));
+        }
+    }
+
+    // A singular matrix reports its zero pivot instead of dividing by it
+    SparseLDL ldl;
+    ldl.analyze(3, {{0, 1}, {1, 2}});
+    std::fill(ldl.values().begin(), ldl.values().end(), 0.0);
+    CHECK(!ldl.factor());
+    return checkFailures();
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <entt/entt.hpp>
+#include "sim/ComponentReflect.hpp"
+
+// Minimal checks for the ctest executables: a failed CHECK prints where and
+// why, and main returns the failure count.
+inline int& checkFailures() {
+  static int failures = 0;
+  return failures;
+}
+
+#define CHECK(cond)                                                                  \
+  do {                                                                               \
+    if (!(cond)) {                                                                   \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      ++checkFailures();                                                             \
+    }                                                                                \
+  } while (0)
+
+// Every reflected field of every component, entity by entity in packed
+// order, compared bit for bit. Prints the first difference per component.
+inline bool sameState(entt::registry& a, entt::registry& b) {
+  bool same = true;
+  std::vector<entt::entity> ea, eb;
+  std::vector<char> bytes;
+  for (const auto& info : componentTable()) {
+    ea.clear(); eb.clear();
+    info.dump(a, ea, bytes);
+    info.dump(b, eb, bytes);
+    if (ea != eb) {
+      std::fprintf(stderr, "%s: entities differ\n", info.name);
+      same = false;
+      continue;
+    }
+    for (auto e : ea) {
+      const void* ca = info.get(a, e);
+      const void* cb = info.get(b, e);
+      bool differs = false;
+      for (const auto& f : info.fields) {
+        const double x = readField(ca, f), y = readField(cb, f);
+        if (std::memcmp(&x, &y, sizeof x) != 0) {
+          std::fprintf(stderr, "%s.%s of entity %u: %.9g vs %.9g\n", info.name, f.name,
+                       static_cast<unsigned>(entt::to_integral(e)), x, y);
+          differs = true;
+          break;
+        }
+      }
+      if (differs) {
+        same = false;
+        break;
+      }
+    }
+  }
+  return same;
+}